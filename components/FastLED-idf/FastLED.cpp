@@ -28,6 +28,8 @@ CFastLED::CFastLED() {
 	m_nFPS = 0;
 	m_pPowerFunc = NULL;
 	m_nPowerData = 0xFFFFFFFF;
+	m_nFadeLevel = 255;
+	m_nActiveRamps = 0;
 }
 
 CLEDController &CFastLED::addLeds(CLEDController *pLed,
@@ -47,6 +49,9 @@ void CFastLED::show(uint8_t scale) {
 	while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
 	lastshow = micros();
 
+	if(m_nActiveRamps) { stepRamps(); }
+	if(m_nFadeLevel != 255) { scale = scale8(scale, m_nFadeLevel); }
+
 	// If we have a function for computing power, use it!
 	if(m_pPowerFunc) {
 		scale = (*m_pPowerFunc)(scale, m_nPowerData);
@@ -60,7 +65,13 @@ void CFastLED::show(uint8_t scale) {
 		pCur->setDither(d);
 		pCur = pCur->next();
 	}
+#if FASTLED_PREVIEW
+	preview_frame(scale);
+#endif
 	countFPS();
+#if FASTLED_ALLOC_CHECK
+	alloc_check_frame();
+#endif
 }
 
 int CFastLED::count() {
@@ -89,6 +100,9 @@ void CFastLED::showColor(const struct CRGB & color, uint8_t scale) {
 	while(m_nMinMicros && ((micros()-lastshow) < m_nMinMicros));
 	lastshow = micros();
 
+	if(m_nActiveRamps) { stepRamps(); }
+	if(m_nFadeLevel != 255) { scale = scale8(scale, m_nFadeLevel); }
+
 	// If we have a function for computing power, use it!
 	if(m_pPowerFunc) {
 		scale = (*m_pPowerFunc)(scale, m_nPowerData);
@@ -135,6 +149,7 @@ void CFastLED::delay(unsigned long ms) {
 }
 
 void CFastLED::setTemperature(const struct CRGB & temp) {
+	m_nActiveRamps &= ~(1 << RAMP_TEMPERATURE);
 	CLEDController *pCur = CLEDController::head();
 	while(pCur) {
 		pCur->setTemperature(temp);
@@ -143,6 +158,7 @@ void CFastLED::setTemperature(const struct CRGB & temp) {
 }
 
 void CFastLED::setCorrection(const struct CRGB & correction) {
+	m_nActiveRamps &= ~(1 << RAMP_CORRECTION);
 	CLEDController *pCur = CLEDController::head();
 	while(pCur) {
 		pCur->setCorrection(correction);
@@ -150,6 +166,88 @@ void CFastLED::setCorrection(const struct CRGB & correction) {
 	}
 }
 
+void CFastLED::setColorMatrix(const CRGBMatrix & matrix) {
+	CLEDController *pCur = CLEDController::head();
+	while(pCur) {
+		pCur->setColorMatrix(matrix);
+		pCur = pCur->next();
+	}
+}
+
+void CFastLED::startRamp(int which, const CRGB & from, const CRGB & to, uint32_t ms, EFadeCurve curve) {
+	OutputRamp & r = m_Ramps[which];
+	r.start = millis();
+	r.duration = ms;	// a zero length ramp ends at the next show
+	r.curve = curve;
+	r.from = from;
+	r.to = to;
+	m_nActiveRamps |= (1 << which);
+}
+
+void CFastLED::fadeTo(uint8_t level, uint32_t ms, EFadeCurve curve) {
+	startRamp(RAMP_FADE, CRGB(m_nFadeLevel, 0, 0), CRGB(level, 0, 0), ms, curve);
+}
+
+void CFastLED::fadeTemperature(const struct CRGB & temp, uint32_t ms, EFadeCurve curve) {
+	CLEDController *pHead = CLEDController::head();
+	startRamp(RAMP_TEMPERATURE, pHead ? pHead->getTemperature() : CRGB(UncorrectedTemperature), temp, ms, curve);
+}
+
+void CFastLED::fadeCorrection(const struct CRGB & correction, uint32_t ms, EFadeCurve curve) {
+	CLEDController *pHead = CLEDController::head();
+	startRamp(RAMP_CORRECTION, pHead ? pHead->getCorrection() : CRGB(UncorrectedColor), correction, ms, curve);
+}
+
+static fract16 ease_ramp(uint8_t curve, fract16 x) {
+	switch(curve) {
+		case FADE_EASE_IN_OUT_QUAD:
+			return ease16InOutQuad(x);
+		case FADE_EASE_IN_OUT_CUBIC: {
+			// x^2 (3 - 2x) in one 64 bit product, so it rises steadily; it rounds to
+			// 65536 for the last few values of x, which must not wrap to 0
+			uint64_t xx = (uint64_t)x * x;
+			uint32_t y = (xx * (3 * 65536 - 2 * (uint32_t)x) + 0x80000000u) >> 32;
+			return y > 65535 ? 65535 : y;
+		}
+		default:
+			return x;
+	}
+}
+
+static uint8_t lerp_ramp(uint8_t a, uint8_t b, fract16 f) {
+	return a + (((int32_t)b - a) * f + 0x8000) / 65536;
+}
+
+// Evaluate the running ramps at the current time, and hand the results to the controllers.
+// The ramps depend on the clock only, so it is harmless to step them more than once a frame.
+void CFastLED::stepRamps() {
+	uint32_t now = millis();
+	for(int i = 0; i < NUM_RAMPS; i++) {
+		if(!(m_nActiveRamps & (1 << i))) { continue; }
+		OutputRamp & r = m_Ramps[i];
+		uint32_t t = now - r.start;
+		CRGB c = r.to;
+		if(t < r.duration) {
+			fract16 f = ease_ramp(r.curve, ((uint64_t)t << 16) / r.duration);
+			c = CRGB(lerp_ramp(r.from.r, r.to.r, f), lerp_ramp(r.from.g, r.to.g, f), lerp_ramp(r.from.b, r.to.b, f));
+		} else {
+			m_nActiveRamps &= ~(1 << i);
+		}
+
+		if(i == RAMP_FADE) {
+			m_nFadeLevel = c.r;
+			continue;
+		}
+		for(CLEDController *pCur = CLEDController::head(); pCur; pCur = pCur->next()) {
+			if(i == RAMP_TEMPERATURE) {
+				pCur->setTemperature(c);
+			} else {
+				pCur->setCorrection(c);
+			}
+		}
+	}
+}
+
 void CFastLED::setDither(uint8_t ditherMode)  {
 	CLEDController *pCur = CLEDController::head();
 	while(pCur) {
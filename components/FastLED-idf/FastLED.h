@@ -10,7 +10,10 @@
 
 // prefer I2S? Comment this in.
 // Not the default because haven't tried it as much, does work
+// (FASTLED_ESP32_RMT, defined before this file, keeps RMT; the host RMT tests use it)
+#ifndef FASTLED_ESP32_RMT
 #define FASTLED_ESP32_I2S
+#endif
 
 #include "esp32-hal.h"
 
@@ -61,6 +64,7 @@
 #include "fastspi_types.h"
 #include "dmx.h"
 
+#include "alloc_check.h"
 #include "platforms.h"
 #include "fastled_progmem.h"
 
@@ -73,6 +77,9 @@
 
 #include "noise.h"
 #include "power_mgt.h"
+#include "preview.h"
+#include "parallel.h"
+#include "topology.h"
 
 #include "fastspi.h"
 #include "chipsets.h"
@@ -129,6 +136,11 @@ template<uint8_t DATA_PIN, EOrder RGB_ORDER> class GW6205 : public GW6205Control
 template<uint8_t DATA_PIN, EOrder RGB_ORDER> class GW6205_400 : public GW6205Controller400Khz<DATA_PIN, RGB_ORDER> {};
 template<uint8_t DATA_PIN, EOrder RGB_ORDER> class LPD1886 : public LPD1886Controller1250Khz<DATA_PIN, RGB_ORDER> {};
 template<uint8_t DATA_PIN, EOrder RGB_ORDER> class LPD1886_8BIT : public LPD1886Controller1250Khz_8bit<DATA_PIN, RGB_ORDER> {};
+#ifdef FASTLED_HAS_CLOCKLESS_TIMING_CHECK
+template<uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2812B_1000 : public WS2812Controller1000Khz<DATA_PIN, RGB_ORDER> {};
+template<uint8_t DATA_PIN, EOrder RGB_ORDER> class WS2812B_1200 : public WS2812Controller1200Khz<DATA_PIN, RGB_ORDER> {};
+template<uint8_t DATA_PIN, EOrder RGB_ORDER> class SK6812_1000 : public SK6812Controller1000Khz<DATA_PIN, RGB_ORDER> {};
+#endif
 #ifdef DmxSimple_h
 template<uint8_t DATA_PIN, EOrder RGB_ORDER> class DMXSIMPLE : public DMXSimpleController<DATA_PIN, RGB_ORDER> {};
 #endif
@@ -183,6 +195,13 @@ enum EBlockChipsets {
 
 typedef uint8_t (*power_func)(uint8_t scale, uint32_t data);
 
+/// Easing curves for the output ramps, see CFastLED::fadeTo()
+enum EFadeCurve {
+	FADE_LINEAR = 0,
+	FADE_EASE_IN_OUT_QUAD,
+	FADE_EASE_IN_OUT_CUBIC
+};
+
 /// High level controller interface for FastLED.  This class manages controllers, global settings and trackings
 /// such as brightness, and refresh rates, and provides access functions for driving led data to controllers
 /// via the show/showColor/clear methods.
@@ -194,6 +213,22 @@ class CFastLED {
 	uint32_t m_nMinMicros;		///< minimum µs between frames, used for capping frame rates.
 	uint32_t m_nPowerData;		///< max power use parameter
 	power_func m_pPowerFunc;	///< function for overriding brightness when using FastLED.show();
+	uint8_t  m_nFadeLevel;		///< master fade level, scaled into every frame shown
+
+	/// A time based ramp of an output setting, evaluated once per show
+	struct OutputRamp {
+		uint32_t start;			///< millis() when the ramp started
+		uint32_t duration;		///< length in ms
+		uint8_t curve;			///< EFadeCurve
+		CRGB from;				///< value at the start (the fade level ramp only uses .r)
+		CRGB to;				///< value at the end
+	};
+	enum { RAMP_FADE, RAMP_TEMPERATURE, RAMP_CORRECTION, NUM_RAMPS };
+	OutputRamp m_Ramps[NUM_RAMPS];
+	uint8_t m_nActiveRamps;		///< bit per running ramp
+
+	void startRamp(int which, const CRGB & from, const CRGB & to, uint32_t ms, EFadeCurve curve);
+	void stepRamps();
 
 public:
 	CFastLED();
@@ -543,6 +578,33 @@ public:
 	/// @param correction A CRGB structure describin the color correction.
 	void setCorrection(const struct CRGB & correction);
 
+	/// Set a global color matrix.  Sets the color matrix for all added led strips, overriding whatever
+	/// previous matrix those controllers may have had.  See colormatrix.h
+	/// @param matrix the color matrix applied to every pixel on output
+	void setColorMatrix(const CRGBMatrix & matrix);
+
+	/// Fade the output to a master level over the next ms milliseconds.  The level scales every frame on top of
+	/// the brightness passed to show() (and before any power limit), so it is independent of setBrightness()
+	/// and needs no re-render: each show() evaluates the ramp from the clock, whatever the frame rate.
+	/// @param level the master level to end at, 255 (the default) leaves the output unscaled
+	/// @param ms how long the fade takes, 0 to jump to level
+	/// @param curve the easing of the fade
+	void fadeTo(uint8_t level, uint32_t ms, EFadeCurve curve = FADE_LINEAR);
+
+	/// Get the master fade level, as of the last show()
+	uint8_t getFadeLevel() { return m_nFadeLevel; }
+
+	/// Ramp the color temperature of all added led strips from what the first one has now to temp,
+	/// over the next ms milliseconds.  setTemperature() cancels the ramp.
+	void fadeTemperature(const struct CRGB & temp, uint32_t ms, EFadeCurve curve = FADE_LINEAR);
+
+	/// Ramp the color correction of all added led strips from what the first one has now to correction,
+	/// over the next ms milliseconds.  setCorrection() cancels the ramp.
+	void fadeCorrection(const struct CRGB & correction, uint32_t ms, EFadeCurve curve = FADE_LINEAR);
+
+	/// Whether a fade or temperature/correction ramp is still running
+	bool isFading() { return m_nActiveRamps != 0; }
+
 	/// Set the dithering mode.  Sets the dithering mode for all added led strips, overriding
 	/// whatever previous dithering option those controllers may have had.
 	/// @param ditherMode - what type of dithering to use, either BINARY_DITHER or DISABLE_DITHER
@@ -0,0 +1,92 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+#include "esp_log.h"
+
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+#include "esp_heap_trace.h"
+#endif
+
+FASTLED_NAMESPACE_BEGIN
+
+static const char *TAG = "FastLED";
+
+static bool gWarm = false;
+static uint32_t gFrames = 0;
+static uint32_t gAllocs = 0;
+static uint32_t gAllocBytes = 0;
+
+static TaskHandle_t gTasks[FASTLED_ALLOC_MAX_TASKS];
+static int gNumTasks = 0;
+
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+#define ALLOC_CHECK_TRACE_RECORDS 32
+static heap_trace_record_t gTrace[ALLOC_CHECK_TRACE_RECORDS];
+#endif
+
+void alloc_check_warmup_done() {
+    if (gWarm) return;
+    gWarm = true;
+    gAllocs = 0;
+    gAllocBytes = 0;
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+    // -- Hook every allocation from now on, not only the library's
+    heap_trace_init_standalone(gTrace, ALLOC_CHECK_TRACE_RECORDS);
+    heap_trace_start(HEAP_TRACE_ALL);
+#endif
+    ESP_LOGI(TAG, "warm-up done after %u frames", (unsigned)gFrames);
+}
+
+void alloc_check_note(const char * what, size_t bytes) {
+    if (!gWarm) return;
+    gAllocs++;
+    gAllocBytes += bytes;
+    ESP_LOGW(TAG, "allocation after warm-up: %s, %u bytes", what, (unsigned)bytes);
+}
+
+uint32_t alloc_check_count() {
+    return gAllocs;
+}
+
+void alloc_check_watch_task(TaskHandle_t task) {
+    if (task == NULL) task = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < gNumTasks; i++) {
+        if (gTasks[i] == task) return;
+    }
+    if (gNumTasks < FASTLED_ALLOC_MAX_TASKS) gTasks[gNumTasks++] = task;
+}
+
+uint32_t alloc_check_stack_left(TaskHandle_t task) {
+    // ESP-IDF reports the high-water mark in bytes
+    return uxTaskGetStackHighWaterMark(task);
+}
+
+void alloc_check_frame() {
+    alloc_check_watch_task(NULL);
+    gFrames++;
+    if (!gWarm) {
+        if (gFrames >= FASTLED_ALLOC_WARMUP_FRAMES) alloc_check_warmup_done();
+    } else if (gFrames % FASTLED_ALLOC_REPORT_FRAMES == 0) {
+        alloc_check_report();
+    }
+}
+
+void alloc_check_report() {
+    if (gAllocs) {
+        ESP_LOGW(TAG, "%u library allocations (%u bytes) after warm-up", (unsigned)gAllocs, (unsigned)gAllocBytes);
+    } else {
+        ESP_LOGI(TAG, "no library allocations after warm-up");
+    }
+#ifdef CONFIG_HEAP_TRACING_STANDALONE
+    size_t traced = heap_trace_get_count();
+    if (traced) {
+        ESP_LOGW(TAG, "%u heap allocations after warm-up", (unsigned)traced);
+        heap_trace_dump();
+    }
+#endif
+    for (int i = 0; i < gNumTasks; i++) {
+        ESP_LOGI(TAG, "task %s: %u bytes of stack never used", pcTaskGetTaskName(gTasks[i]), (unsigned)alloc_check_stack_left(gTasks[i]));
+    }
+}
+
+FASTLED_NAMESPACE_END
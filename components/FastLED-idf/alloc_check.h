@@ -0,0 +1,79 @@
+#ifndef __INC_ALLOC_CHECK_H
+#define __INC_ALLOC_CHECK_H
+
+#include "FastLED.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+///@file alloc_check.h
+/// steady-state allocation and stack checks
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup AllocCheck Steady-state allocation checks
+/// With FASTLED_ALLOC_CHECK set (see fastled_config.h), every heap allocation the
+/// library and the effects make after warm-up is logged, and the stack high-water
+/// marks of the tasks that call show() are reported. Once the program has warmed
+/// up, a frame should not allocate at all.
+///
+/// If heap tracing is enabled in menuconfig (standalone mode), every allocation in
+/// the program is hooked after warm-up, not just the library's own, and the report
+/// dumps the callers.
+///
+/// host/alloc_test.cpp does the same on a PC for every effect, with all allocations
+/// counted, and fails if any frame after warm-up allocates.
+///
+/// Example:
+///  alloc_check_watch_task(renderTaskHandle);   // render tasks, show() registers itself
+///  ... set up segments, effects, buffers ...
+///  alloc_check_warmup_done();                  // or let FASTLED_ALLOC_WARMUP_FRAMES pass
+///@{
+
+/// Frames shown before warm-up ends on its own
+#ifndef FASTLED_ALLOC_WARMUP_FRAMES
+#define FASTLED_ALLOC_WARMUP_FRAMES 100
+#endif
+
+/// Frames between two reports after warm-up
+#ifndef FASTLED_ALLOC_REPORT_FRAMES
+#define FASTLED_ALLOC_REPORT_FRAMES 1000
+#endif
+
+/// Most tasks whose stack is watched
+#ifndef FASTLED_ALLOC_MAX_TASKS
+#define FASTLED_ALLOC_MAX_TASKS 4
+#endif
+
+/// End the warm-up; allocations from now on are flagged
+void alloc_check_warmup_done();
+
+/// Record an allocation made by the library, logged if it happens after warm-up
+void alloc_check_note(const char * what, size_t bytes);
+
+/// Library allocations recorded since the warm-up ended
+uint32_t alloc_check_count();
+
+/// Watch the stack high-water mark of a task, NULL for the calling task
+void alloc_check_watch_task(TaskHandle_t task);
+
+/// Smallest amount of stack, in bytes, a watched task has left over so far
+uint32_t alloc_check_stack_left(TaskHandle_t task);
+
+/// Count a shown frame; ends the warm-up and reports periodically
+void alloc_check_frame();
+
+/// Log the allocations since warm-up and the stack high-water marks
+void alloc_check_report();
+
+#if FASTLED_ALLOC_CHECK
+#define FASTLED_ALLOC_NOTE(what, bytes) alloc_check_note(what, bytes)
+#else
+#define FASTLED_ALLOC_NOTE(what, bytes)
+#endif
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -190,6 +190,48 @@ protected:
 
 };
 
+#if FASTLED_APA102_HDR == 1
+/// High dynamic range output for the APA102 and SK9822: every pixel's brightest channel,
+/// after the brightness and colour correction scales, picks the pixel's 5-bit global
+/// brightness, and the channels are divided by it. At low brightness the colours keep
+/// close to 8 bits of resolution instead of a handful of levels. The tables are filled
+/// once, by the first controller's init().
+template <int DUMMY = 0>
+struct APA102HdrTables {
+	static uint8_t global[256];   ///< 5-bit field for the brightest scaled channel, by its high byte
+	static uint16_t recip[32];    ///< scaled channel * recip[global] >> 19 gives the 8-bit channel
+
+	static void init() {
+		if (global[0]) return;
+		for (int g = 1; g < 32; g++) {
+			// -- 31 * 2^19 / 255, rounded up so full scale still reaches 255
+			recip[g] = (63737 + g - 1) / g;
+		}
+		for (int k = 0; k < 256; k++) {
+			// -- Smallest field that keeps the top of the bucket within 8 bits
+			int g = (((k << 8) + 255) * 31 + 65024) / 65025;
+			global[k] = (g < 1) ? 1 : ((g > 31) ? 31 : g);
+		}
+	}
+
+	/// Split the channels b0..b2, scaled by s0..s2, into the global field and 8-bit channels
+	static inline void split(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t s0, uint8_t s1, uint8_t s2,
+	                         uint8_t & brightness, uint8_t & o0, uint8_t & o1, uint8_t & o2) __attribute__((always_inline)) {
+		uint16_t m0 = b0 * s0, m1 = b1 * s1, m2 = b2 * s2;
+		uint16_t m = (m0 > m1) ? m0 : m1;
+		if (m2 > m) m = m2;
+		brightness = global[m >> 8];
+		uint32_t r = recip[brightness];
+		o0 = (m0 * r) >> 19;
+		o1 = (m1 * r) >> 19;
+		o2 = (m2 * r) >> 19;
+	}
+};
+template <int DUMMY> uint8_t APA102HdrTables<DUMMY>::global[256];
+template <int DUMMY> uint16_t APA102HdrTables<DUMMY>::recip[32];
+typedef APA102HdrTables<> APA102Hdr;
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // APA102 definition - takes data/clock/select pin values (N.B. should take an SPI definition?)
@@ -229,6 +271,9 @@ public:
 
 	virtual void init() {
 		mSPI.init();
+#if FASTLED_APA102_HDR == 1
+		APA102Hdr::init();
+#endif
 	}
 
 protected:
@@ -237,7 +282,9 @@ protected:
 		mSPI.select();
 
 		uint8_t s0 = pixels.getScale0(), s1 = pixels.getScale1(), s2 = pixels.getScale2();
-#if FASTLED_USE_GLOBAL_BRIGHTNESS == 1
+#if FASTLED_APA102_HDR == 1
+		// -- Brightness is chosen per pixel
+#elif FASTLED_USE_GLOBAL_BRIGHTNESS == 1
 		const uint16_t maxBrightness = 0x1F;
 		uint16_t brightness = ((((uint16_t)max(max(s0, s1), s2) + 1) * maxBrightness - 1) >> 8) + 1;
 		s0 = (maxBrightness * s0 + (brightness >> 1)) / brightness;
@@ -248,11 +295,21 @@ protected:
 #endif
 
 		startBoundary();
+#if FASTLED_APA102_HDR == 1
+		while (pixels.has(1)) {
+			uint8_t brightness, b0, b1, b2;
+			APA102Hdr::split(pixels.template loadByte<0>(pixels), pixels.template loadByte<1>(pixels), pixels.template loadByte<2>(pixels),
+			                 s0, s1, s2, brightness, b0, b1, b2);
+			writeLed(brightness, b0, b1, b2);
+			pixels.advanceData();
+		}
+#else
 		while (pixels.has(1)) {
 			writeLed(brightness, pixels.loadAndScale0(0, s0), pixels.loadAndScale1(0, s1), pixels.loadAndScale2(0, s2));
 			pixels.stepDithering();
 			pixels.advanceData();
 		}
+#endif
 		endBoundary(pixels.size());
 
 		mSPI.waitFully();
@@ -294,6 +351,9 @@ public:
 
 	virtual void init() {
 		mSPI.init();
+#if FASTLED_APA102_HDR == 1
+		APA102Hdr::init();
+#endif
 	}
 
 protected:
@@ -302,7 +362,9 @@ protected:
 		mSPI.select();
 
 		uint8_t s0 = pixels.getScale0(), s1 = pixels.getScale1(), s2 = pixels.getScale2();
-#if FASTLED_USE_GLOBAL_BRIGHTNESS == 1
+#if FASTLED_APA102_HDR == 1
+		// -- Brightness is chosen per pixel
+#elif FASTLED_USE_GLOBAL_BRIGHTNESS == 1
 		const uint16_t maxBrightness = 0x1F;
 		uint16_t brightness = ((((uint16_t)max(max(s0, s1), s2) + 1) * maxBrightness - 1) >> 8) + 1;
 		s0 = (maxBrightness * s0 + (brightness >> 1)) / brightness;
@@ -313,11 +375,21 @@ protected:
 #endif
 
 		startBoundary();
+#if FASTLED_APA102_HDR == 1
+		while (pixels.has(1)) {
+			uint8_t brightness, b0, b1, b2;
+			APA102Hdr::split(pixels.template loadByte<0>(pixels), pixels.template loadByte<1>(pixels), pixels.template loadByte<2>(pixels),
+			                 s0, s1, s2, brightness, b0, b1, b2);
+			writeLed(brightness, b0, b1, b2);
+			pixels.advanceData();
+		}
+#else
 		while (pixels.has(1)) {
 			writeLed(brightness, pixels.loadAndScale0(0, s0), pixels.loadAndScale1(0, s1), pixels.loadAndScale2(0, s2));
 			pixels.stepDithering();
 			pixels.advanceData();
 		}
+#endif
 
 		endBoundary(pixels.size());
 
@@ -537,6 +609,17 @@ class PL9823Controller : public ClocklessController<DATA_PIN, 3 * FMUL, 8 * FMUL
 #define C_NS(_NS) (((_NS * ((CLOCKLESS_FREQUENCY / 1000000L)) + 999)) / 1000)
 #endif
 
+#ifdef FASTLED_HAS_CLOCKLESS_TIMING_CHECK
+// Chipset limits for ClocklessTimingCheck, which the nominal WS2812 and SK6812 profiles
+// pass too. With mixed chipsets on I2S the driver holds their lanes to them at run time.
+// WS2812B datasheet (V5): T0H 220-380ns, T1H 580-1000ns, low at least 220ns
+struct WS2812Limits { enum { T0H_MIN = 220, T0H_MAX = 380, T1H_MIN = 580, T1H_MAX = 1000, TL_MIN = 220 }; };
+
+// SK6812 datasheet: T0H 150-450ns, T1H 450-750ns, low at least 450ns
+struct SK6812Limits { enum { T0H_MIN = 150, T0H_MAX = 450, T1H_MIN = 450, T1H_MAX = 750, TL_MIN = 450 }; };
+
+#endif
+
 // GE8822 - 350ns 660ns 350ns
 template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
 class GE8822Controller800Khz : public ClocklessController<DATA_PIN, C_NS(350), C_NS(660), C_NS(350), RGB_ORDER, 4> {};
@@ -579,7 +662,12 @@ class WS2813Controller : public ClocklessController<DATA_PIN, C_NS(320), C_NS(32
 
 // WS2812 - 250ns, 625ns, 375ns
 template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
+#ifdef FASTLED_HAS_CLOCKLESS_TIMING_CHECK
+class WS2812Controller800Khz : public ClocklessController<DATA_PIN, C_NS(250), C_NS(625), C_NS(375), RGB_ORDER>,
+                               public ClocklessTimingCheck<C_NS(250), C_NS(625), C_NS(375), WS2812Limits> {};
+#else
 class WS2812Controller800Khz : public ClocklessController<DATA_PIN, C_NS(250), C_NS(625), C_NS(375), RGB_ORDER> {};
+#endif
 
 // WS2811@400khz - 800ns, 800ns, 900ns
 template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
@@ -606,13 +694,47 @@ template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
 class SK6822Controller : public ClocklessController<DATA_PIN, C_NS(375), C_NS(1000), C_NS(375), RGB_ORDER> {};
 
 template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
+#ifdef FASTLED_HAS_CLOCKLESS_TIMING_CHECK
+class SK6812Controller : public ClocklessController<DATA_PIN, C_NS(300), C_NS(300), C_NS(600), RGB_ORDER>,
+                         public ClocklessTimingCheck<C_NS(300), C_NS(300), C_NS(600), SK6812Limits> {};
+#else
 class SK6812Controller : public ClocklessController<DATA_PIN, C_NS(300), C_NS(300), C_NS(600), RGB_ORDER> {};
+#endif
 
 template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
 class SM16703Controller : public ClocklessController<DATA_PIN, C_NS(300), C_NS(600), C_NS(300), RGB_ORDER> {};
 
 template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
 class PL9823Controller : public ClocklessController<DATA_PIN, C_NS(350), C_NS(1010), C_NS(350), RGB_ORDER> {};
+
+#ifdef FASTLED_HAS_CLOCKLESS_TIMING_CHECK
+// Overclocked profiles, opt in by using them in place of the nominal controllers. Many
+// batches latch reliably well above 800khz: the chip only looks at the high time, so
+// these keep the high times inside the datasheet windows and shorten the low times.
+// Using a profile fails to compile if the driver's quantization (RMT ticks, I2S pulses)
+// pushes a time outside the limits below. Quantized times in ns, I2S / RMT (host/clocktiming
+// prints them with their margins):
+//
+//   profile                   T0H      T1H      T0L      T1L
+//   WS2812Controller1000Khz   250/250  600/600  750/750  400/400
+//   WS2812Controller1200Khz   238/250  595/600  595/575  238/225
+//   SK6812Controller1000Khz   250/250  550/550  750/750  450/450
+
+// WS2812@1Mhz - 250ns, 350ns, 400ns
+template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
+class WS2812Controller1000Khz : public ClocklessController<DATA_PIN, C_NS(250), C_NS(350), C_NS(400), RGB_ORDER>,
+                                public ClocklessTimingCheck<C_NS(250), C_NS(350), C_NS(400), WS2812Limits> {};
+
+// WS2812@1.2Mhz - 250ns, 350ns, 233ns
+template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
+class WS2812Controller1200Khz : public ClocklessController<DATA_PIN, C_NS(250), C_NS(350), C_NS(233), RGB_ORDER>,
+                                public ClocklessTimingCheck<C_NS(250), C_NS(350), C_NS(233), WS2812Limits> {};
+
+// SK6812@1Mhz - 250ns, 300ns, 450ns
+template <uint8_t DATA_PIN, EOrder RGB_ORDER = RGB>
+class SK6812Controller1000Khz : public ClocklessController<DATA_PIN, C_NS(250), C_NS(300), C_NS(450), RGB_ORDER>,
+                                public ClocklessTimingCheck<C_NS(250), C_NS(300), C_NS(450), SK6812Limits> {};
+#endif
 #endif
 ///@}
 
@@ -0,0 +1,95 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+// Rec. 709 luminance weights, in 1/65536ths: the hue and saturation matrices
+// below keep the luminance of a color (as the SVG feColorMatrix ones do)
+#define LUMA_R 13959
+#define LUMA_G 46858
+#define LUMA_B 4719
+
+CRGBMatrix & CRGBMatrix::classify() {
+    bool diagonal = true;
+    bool identity = true;
+    bool scaleOnly = true;
+    for(int i = 0; i < 3; i++) {
+        for(int j = 0; j < 3; j++) {
+            if(i != j && m[i][j]) { diagonal = false; }
+        }
+        if(m[i][i] != 256 || offset[i]) { identity = false; }
+        if(m[i][i] < 0 || m[i][i] > 256 || offset[i]) { scaleOnly = false; }
+    }
+    if(!diagonal) { kind = MATRIX_FULL; }
+    else if(identity) { kind = MATRIX_IDENTITY; }
+    else if(scaleOnly) { kind = MATRIX_SCALE; }
+    else { kind = MATRIX_DIAGONAL; }
+    return *this;
+}
+
+CRGBMatrix CRGBMatrix::operator*(const CRGBMatrix & b) const {
+    CRGBMatrix r;
+    for(int i = 0; i < 3; i++) {
+        int32_t o = offset[i] << 8;
+        for(int j = 0; j < 3; j++) {
+            int32_t v = 0;
+            for(int k = 0; k < 3; k++) { v += (int32_t)m[i][k] * b.m[k][j]; }
+            r.m[i][j] = (v + 128) >> 8;
+            o += m[i][j] * b.offset[j];
+        }
+        r.offset[i] = (o + 128) >> 8;
+    }
+    return r.classify();
+}
+
+CRGBMatrix CRGBMatrix::hueRotation(uint16_t angle) {
+    // the products below are in 1/65536ths; sin16/cos16 peak at 32645
+    int32_t c = (cos16(angle) * 65536) / 32645;
+    int32_t s = (sin16(angle) * 65536) / 32645;
+    static const int32_t luma[3] = { LUMA_R, LUMA_G, LUMA_B };
+    // r' = luma + cos * (identity - luma) + sin * k, with k the rotation axis cross term
+    static const int32_t k[3][3] = {
+        { -LUMA_R, -LUMA_G, 65536 - LUMA_B },
+        { 9437, 9175, -18612 },     // 0.143, 0.140, -0.283
+        { LUMA_R - 65536, LUMA_G, LUMA_B }
+    };
+    CRGBMatrix r;
+    for(int i = 0; i < 3; i++) {
+        for(int j = 0; j < 3; j++) {
+            int32_t v = luma[j] + (int32_t)(((int64_t)c * ((i == j ? 65536 : 0) - luma[j])) >> 16) + (int32_t)(((int64_t)s * k[i][j]) >> 16);
+            r.m[i][j] = (v + 128) >> 8;
+        }
+    }
+    return r.classify();
+}
+
+CRGBMatrix CRGBMatrix::saturation(uint16_t amount) {
+    static const int32_t luma[3] = { LUMA_R, LUMA_G, LUMA_B };
+    CRGBMatrix r;
+    for(int i = 0; i < 3; i++) {
+        for(int j = 0; j < 3; j++) {
+            int32_t v = luma[j] * (256 - (int32_t)amount) + (i == j ? 65536 * (int32_t)amount : 0);
+            r.m[i][j] = (v + 32768) >> 16;
+        }
+    }
+    return r.classify();
+}
+
+CRGBMatrix CRGBMatrix::whiteBalance(const CRGB & gains) {
+    CRGBMatrix r;
+    for(int i = 0; i < 3; i++) {
+        r.m[i][i] = gains.raw[i] + (gains.raw[i] >> 7);   // 255 -> 256
+    }
+    return r.classify();
+}
+
+CRGBMatrix CRGBMatrix::levels(uint16_t gain, int16_t offset) {
+    CRGBMatrix r;
+    for(int i = 0; i < 3; i++) {
+        r.m[i][i] = gain;
+        r.offset[i] = offset;
+    }
+    return r.classify();
+}
+
+FASTLED_NAMESPACE_END
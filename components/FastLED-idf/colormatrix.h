@@ -0,0 +1,90 @@
+#ifndef __INC_COLORMATRIX_H
+#define __INC_COLORMATRIX_H
+
+#include "FastLED.h"
+#include "pixeltypes.h"
+
+///@file colormatrix.h
+/// fixed point 3x3 color matrix, applied by the controllers on output
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup ColorMatrix Output color matrix
+/// A color matrix is set per controller with CLEDController::setColorMatrix(), or
+/// for all of them with CFastLED::setColorMatrix(). It is applied to every pixel
+/// while the controller converts it to wire order, before dithering and the
+/// brightness/correction/temperature scale, so global color grading (hue rotation,
+/// desaturation, warm/cool shifts) costs no pass over the led arrays.
+///
+/// A matrix that only scales the channels down is folded into the brightness
+/// scale and costs nothing per pixel; other diagonal matrices take a cheaper path
+/// than a full one.
+///
+/// Example:
+///  FastLED.setColorMatrix(CRGBMatrix::hueRotation(hue * 256) * CRGBMatrix::saturation(192));
+///@{
+
+/// Kinds of matrices, from cheapest to apply
+typedef enum {
+    MATRIX_IDENTITY = 0,    ///< leaves the colors alone
+    MATRIX_SCALE,           ///< diagonal, gains of at most 1 and no offsets: folded into the scale
+    MATRIX_DIAGONAL,        ///< diagonal, with gains above 1 or offsets
+    MATRIX_FULL             ///< mixes channels
+} EColorMatrixKind;
+
+/// Maps a color c to m * c + offset, per channel rounded and clamped to 0-255
+struct CRGBMatrix {
+    int16_t m[3][3];        ///< rows are the output r, g, b; 256 is 1.0
+    int16_t offset[3];      ///< added to each output channel, in 0-255 units
+    uint8_t kind;           ///< EColorMatrixKind, kept up to date by classify()
+
+    /// the identity matrix
+    CRGBMatrix() {
+        for(int i = 0; i < 3; i++) {
+            for(int j = 0; j < 3; j++) { m[i][j] = (i == j) ? 256 : 0; }
+            offset[i] = 0;
+        }
+        kind = MATRIX_IDENTITY;
+    }
+
+    /// Work out kind from the coefficients; call after changing them by hand
+    CRGBMatrix & classify();
+
+    /// The output channel ch of the pixel at rgb (in r, g, b order)
+    __attribute__((always_inline)) inline uint8_t apply(int ch, const uint8_t * rgb) const {
+        int32_t v;
+        if(kind == MATRIX_FULL) {
+            v = m[ch][0] * rgb[0] + m[ch][1] * rgb[1] + m[ch][2] * rgb[2];
+        } else {
+            v = m[ch][ch] * rgb[ch];
+        }
+        v = (v + (offset[ch] << 8) + 128) >> 8;
+        return v < 0 ? 0 : (v > 255 ? 255 : v);
+    }
+
+    /// Apply the matrix to a color
+    CRGB apply(const CRGB & c) const {
+        return CRGB(apply(0, c.raw), apply(1, c.raw), apply(2, c.raw));
+    }
+
+    /// The matrix that applies b, then this one
+    CRGBMatrix operator*(const CRGBMatrix & b) const;
+
+    /// Rotate the hues by angle (65536 is a full turn), keeping the luminance
+    static CRGBMatrix hueRotation(uint16_t angle);
+
+    /// Scale the saturation: 0 is grey, 256 leaves it, above 256 oversaturates
+    static CRGBMatrix saturation(uint16_t amount);
+
+    /// Scale each channel by gains.raw[i] / 255, e.g. a ColorTemperature for a warm/cool shift
+    static CRGBMatrix whiteBalance(const CRGB & gains);
+
+    /// Scale each channel by gain (256 is 1.0) and add offset, for contrast and lift
+    static CRGBMatrix levels(uint16_t gain, int16_t offset);
+};
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
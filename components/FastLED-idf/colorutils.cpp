@@ -10,20 +10,25 @@ FASTLED_NAMESPACE_BEGIN
 
 
 
+// fill_solid goes a word at a time: gray (including black, which is
+// how most clears arrive) is a single byte value for memset8, any
+// other color a three byte pattern for memfill24.
 void fill_solid( struct CRGB * leds, int numToFill,
                  const struct CRGB& color)
 {
-    for( int i = 0; i < numToFill; i++) {
-        leds[i] = color;
+    if( numToFill <= 0) return;
+    if( color.r == color.g && color.g == color.b) {
+        memset8( (void*)leds, color.r, (uint32_t)numToFill * sizeof(CRGB));
+    } else {
+        memfill24( leds, color.raw, numToFill);
     }
 }
 
 void fill_solid( struct CHSV * targetArray, int numToFill,
                  const struct CHSV& hsvColor)
 {
-    for( int i = 0; i < numToFill; i++) {
-        targetArray[i] = hsvColor;
-    }
+    if( numToFill <= 0) return;
+    memfill24( targetArray, hsvColor.raw, numToFill);
 }
 
 
@@ -95,6 +100,12 @@ void fill_gradient_RGB( CRGB* leds,
     gdelta87 *= 2;
     bdelta87 *= 2;
 
+    // a flat run is a fill
+    if( rdelta87 == 0 && gdelta87 == 0 && bdelta87 == 0) {
+        fill_solid( leds + startpos, endpos - startpos + 1, startcolor);
+        return;
+    }
+
     accum88 r88 = startcolor.r << 8;
     accum88 g88 = startcolor.g << 8;
     accum88 b88 = startcolor.b << 8;
@@ -434,6 +445,104 @@ void blurColumns(CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount)
 }
 
 
+Affine2D affine2d_rotozoom( uint16_t angle, uint16_t zoom,
+                            int32_t sx, int32_t sy, uint8_t ox, uint8_t oy)
+{
+    if( zoom == 0) zoom = 1;
+    // inverse of "rotate by angle, then zoom": rotate back, divide by zoom.
+    // sin16/cos16 peak at 32645, not 32767: dividing by that, zoom 256 at
+    // a right angle is exactly 1:1. zoom is 8.8, so this lands on 16.16
+    int32_t cs = ((int64_t)cos16( angle) << 24) / (32645L * zoom);
+    int32_t sn = ((int64_t)sin16( angle) << 24) / (32645L * zoom);
+    Affine2D m;
+    m.a = cs;   m.b = sn;
+    m.c = -sn;  m.d = cs;
+    m.tx = sx - (m.a * ox + m.b * oy);
+    m.ty = sy - (m.c * ox + m.d * oy);
+    return m;
+}
+
+static inline void wrapCoord( int32_t& u, int32_t span)
+{
+    while( u < 0) u += span;
+    while( u >= span) u -= span;
+}
+
+// one channel of the 4 pixels around a sample point, weighted by
+// the sample's fractional position (fu, fv)
+static inline uint8_t bilerp8( uint8_t p00, uint8_t p01, uint8_t p10, uint8_t p11,
+                               fract8 fu, fract8 fv)
+{
+    int32_t top = (p00 << 8) + (p01 - p00) * fu;
+    int32_t bottom = (p10 << 8) + (p11 - p10) * fu;
+    return ((top << 8) + (bottom - top) * fv) >> 16;
+}
+
+template<bool BILINEAR, bool WRAP>
+static void resampleRows( const CRGB* src, uint16_t srcWidth, uint16_t srcHeight,
+                          CRGB* leds, uint8_t width, uint8_t height, const Affine2D& m)
+{
+    const int32_t spanU = (int32_t)srcWidth << 16;
+    const int32_t spanV = (int32_t)srcHeight << 16;
+    // nearest picks the closest pixel, bilinear blends the 4 around
+    const int32_t bias = BILINEAR ? 0 : 0x8000;
+    int32_t rowU = m.tx + bias;
+    int32_t rowV = m.ty + bias;
+
+    for( uint8_t y = 0; y < height; y++) {
+        int32_t u = rowU;
+        int32_t v = rowV;
+        for( uint8_t x = 0; x < width; x++) {
+            if( WRAP) {
+                wrapCoord( u, spanU);
+                wrapCoord( v, spanV);
+            }
+            int32_t iu = u >> 16;
+            int32_t iv = v >> 16;
+            CRGB out = CRGB::Black;
+            if( WRAP || ((uint32_t)iu < srcWidth && (uint32_t)iv < srcHeight)) {
+                const CRGB* row0 = src + iv * srcWidth;
+                if( !BILINEAR) {
+                    out = row0[iu];
+                } else {
+                    int32_t iu1 = iu + 1 < srcWidth ? iu + 1 : (WRAP ? 0 : iu);
+                    int32_t iv1 = iv + 1 < srcHeight ? iv + 1 : (WRAP ? 0 : iv);
+                    const CRGB* row1 = src + iv1 * srcWidth;
+                    fract8 fu = u >> 8;
+                    fract8 fv = v >> 8;
+                    const CRGB& p00 = row0[iu];
+                    const CRGB& p01 = row0[iu1];
+                    const CRGB& p10 = row1[iu];
+                    const CRGB& p11 = row1[iu1];
+                    out.r = bilerp8( p00.r, p01.r, p10.r, p11.r, fu, fv);
+                    out.g = bilerp8( p00.g, p01.g, p10.g, p11.g, fu, fv);
+                    out.b = bilerp8( p00.b, p01.b, p10.b, p11.b, fu, fv);
+                }
+            }
+            leds[XY(x,y)] = out;
+            u += m.a;
+            v += m.c;
+        }
+        rowU += m.b;
+        rowV += m.d;
+    }
+}
+
+void resample2d( const CRGB* src, uint16_t srcWidth, uint16_t srcHeight,
+                 CRGB* leds, uint8_t width, uint8_t height,
+                 const Affine2D& m, TResampleMode mode, bool wrap)
+{
+    if( srcWidth == 0 || srcHeight == 0) return;
+    if( mode == RESAMPLE_BILINEAR) {
+        if( wrap) resampleRows<true,true>( src, srcWidth, srcHeight, leds, width, height, m);
+        else      resampleRows<true,false>( src, srcWidth, srcHeight, leds, width, height, m);
+    } else {
+        if( wrap) resampleRows<false,true>( src, srcWidth, srcHeight, leds, width, height, m);
+        else      resampleRows<false,false>( src, srcWidth, srcHeight, leds, width, height, m);
+    }
+}
+
+
 
 // CRGB HeatColor( uint8_t temperature)
 //
@@ -863,6 +972,51 @@ CRGB ColorFromPalette( const CRGBPalette256& pal, uint8_t index, uint8_t brightn
 }
 
 
+// -- a + (b - a) * frac / 2^shift, per channel; frac is below 2^shift
+static inline CRGB48 lerp48( const CRGB48& a, const CRGB48& b, int32_t frac, uint8_t shift)
+{
+    return CRGB48( a.r + ((((int32_t)b.r - a.r) * frac) >> shift),
+                   a.g + ((((int32_t)b.g - a.g) * frac) >> shift),
+                   a.b + ((((int32_t)b.b - a.b) * frac) >> shift));
+}
+
+static inline CRGB48 scale48( const CRGB48& c, uint16_t brightness)
+{
+    uint32_t scale = (uint32_t)brightness + 1;
+    return CRGB48( (c.r * scale) >> 16, (c.g * scale) >> 16, (c.b * scale) >> 16);
+}
+
+CRGB48 ColorFromPalette( const CRGB48Palette16& pal, uint16_t index, uint16_t brightness, TBlendType blendType)
+{
+    uint8_t hi4 = index >> 12;
+    uint16_t lo12 = index & 0x0FFF;
+
+    CRGB48 c = pal[hi4];
+    if( lo12 && (blendType != NOBLEND)) {
+        c = lerp48( c, pal[(hi4 + 1) & 0x0F], lo12, 12);
+    }
+    if( brightness != 65535) {
+        c = scale48( c, brightness);
+    }
+    return c;
+}
+
+CRGB48 ColorFromPalette( const CRGB48Palette256& pal, uint16_t index, uint16_t brightness, TBlendType blendType)
+{
+    uint8_t hi8 = index >> 8;
+    uint8_t lo8 = index & 0xFF;
+
+    CRGB48 c = pal[hi8];
+    if( lo8 && (blendType != NOBLEND)) {
+        c = lerp48( c, pal[(uint8_t)(hi8 + 1)], lo8, 8);
+    }
+    if( brightness != 65535) {
+        c = scale48( c, brightness);
+    }
+    return c;
+}
+
+
 CHSV ColorFromPalette( const struct CHSVPalette16& pal, uint8_t index, uint8_t brightness, TBlendType blendType)
 {
     //      hi4 = index >> 4;
@@ -1095,6 +1249,13 @@ void UpscalePalette(const struct CHSVPalette32& srcpal32, struct CHSVPalette256&
     }
 }
 
+void UpscalePalette(const struct CRGB48Palette16& srcpal16, struct CRGB48Palette256& destpal256)
+{
+    for( int i = 0; i < 256; i++) {
+        destpal256[(uint8_t)(i)] = ColorFromPalette( srcpal16, i << 8);
+    }
+}
+
 
 
 #if 0
@@ -165,6 +165,12 @@ void fill_gradient( T* targetArray,
     satdelta87 *= 2;
     valdelta87 *= 2;
 
+    // a flat run is a fill, with the color converted once
+    if( huedelta87 == 0 && satdelta87 == 0 && valdelta87 == 0) {
+        fill_solid( targetArray + startpos, endpos - startpos + 1, T(startcolor));
+        return;
+    }
+
     accum88 hue88 = startcolor.hue << 8;
     accum88 sat88 = startcolor.sat << 8;
     accum88 val88 = startcolor.val << 8;
@@ -325,6 +331,39 @@ void blurRows( CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount);
 void blurColumns(CRGB* leds, uint8_t width, uint8_t height, fract8 blur_amount);
 
 
+// Affine2D: maps output (matrix) coordinates to source coordinates,
+//           in 16.16 fixed point:
+//
+//             u = a*x + b*y + tx
+//             v = c*x + d*y + ty
+//
+// affine2d_rotozoom: the transform that shows the source rotated by
+//           'angle' (0-65535 is a full turn) and zoomed by 'zoom'
+//           (8.8 fixed point, 256 = 1:1), with source point (sx, sy)
+//           (16.16 fixed point, for sub-pixel panning) landing on
+//           output pixel (ox, oy).
+struct Affine2D {
+    int32_t a, b, c, d;
+    int32_t tx, ty;
+};
+
+Affine2D affine2d_rotozoom( uint16_t angle, uint16_t zoom,
+                            int32_t sx, int32_t sy, uint8_t ox, uint8_t oy);
+
+typedef enum { RESAMPLE_NEAREST=0, RESAMPLE_BILINEAR=1 } TResampleMode;
+
+// resample2d: fill a width x height matrix, through the XY mapping,
+//             with a source field (a rendered layer, a noise field, an
+//             image; stored row by row) seen through an affine transform.
+//             Source coordinates are stepped incrementally along each
+//             row, with no per-pixel multiplies. With 'wrap' the source
+//             tiles the plane, without it everything outside is black.
+void resample2d( const CRGB* src, uint16_t srcWidth, uint16_t srcHeight,
+                 CRGB* leds, uint8_t width, uint8_t height,
+                 const Affine2D& m, TResampleMode mode = RESAMPLE_NEAREST,
+                 bool wrap = true);
+
+
 // CRGB HeatColor( uint8_t temperature)
 //
 // Approximates a 'black body radiation' spectrum for
@@ -1612,6 +1651,153 @@ CHSV ColorFromPalette( const CHSVPalette32& pal,
                       TBlendType blendType=LINEARBLEND);
 
 
+// High precision palettes
+//
+// CRGB48Palette16 and CRGB48Palette256 hold 16 bits per channel, and are
+// looked up with a 16-bit index and a 16-bit brightness: the blend between
+// two entries has 4096 (or 256) steps instead of 16 (or 1), and dimming
+// happens before the result is rounded, so slow gradients and dim palettes
+// don't band.  The result is a CRGB48; CRGB48::toCRGB() rounds or dithers
+// it down for the 8-bit led arrays.
+//
+// They are built from the 8-bit palettes (any of which can be converted to a
+// CRGBPalette16 or CRGBPalette256 first), and a CRGB48Palette256 is upscaled
+// from a CRGB48Palette16 just as a CRGBPalette256 is from a CRGBPalette16,
+// to trade memory (1.5k) for a cheaper lookup.
+
+class CRGB48Palette16;
+class CRGB48Palette256;
+void UpscalePalette(const struct CRGB48Palette16& srcpal16, struct CRGB48Palette256& destpal256);
+
+class CRGB48Palette16 {
+public:
+    CRGB48 entries[16];
+    CRGB48Palette16() {};
+
+    CRGB48Palette16( const CRGB48Palette16& rhs)
+    {
+        for (int i=0;i<16;i++) {
+            entries[i] = rhs.entries[i];
+        }
+    }
+    CRGB48Palette16& operator=( const CRGB48Palette16& rhs)
+    {
+        for (int i=0;i<16;i++) {
+            entries[i] = rhs.entries[i];
+        }
+        return *this;
+    }
+
+    CRGB48Palette16( const CRGBPalette16& rhs)
+    {
+        *this = rhs;
+    }
+    CRGB48Palette16& operator=( const CRGBPalette16& rhs)
+    {
+        for (int i=0;i<16;i++) {
+            entries[i] = rhs.entries[i];
+        }
+        return *this;
+    }
+
+    CRGB48Palette16( const TProgmemRGBPalette16& rhs)
+    {
+        *this = rhs;
+    }
+    CRGB48Palette16& operator=( const TProgmemRGBPalette16& rhs)
+    {
+        for( uint8_t i = 0; i < 16; i++) {
+            entries[i] = CRGB( FL_PGM_READ_DWORD_NEAR( rhs + i));
+        }
+        return *this;
+    }
+
+    inline CRGB48& operator[] (uint8_t x) __attribute__((always_inline))
+    {
+        return entries[x];
+    }
+    inline const CRGB48& operator[] (uint8_t x) const __attribute__((always_inline))
+    {
+        return entries[x];
+    }
+};
+
+class CRGB48Palette256 {
+public:
+    CRGB48 entries[256];
+    CRGB48Palette256() {};
+
+    CRGB48Palette256( const CRGB48Palette256& rhs)
+    {
+        for (int i=0;i<256;i++) {
+            entries[i] = rhs.entries[i];
+        }
+    }
+    CRGB48Palette256& operator=( const CRGB48Palette256& rhs)
+    {
+        for (int i=0;i<256;i++) {
+            entries[i] = rhs.entries[i];
+        }
+        return *this;
+    }
+
+    CRGB48Palette256( const CRGBPalette256& rhs)
+    {
+        *this = rhs;
+    }
+    CRGB48Palette256& operator=( const CRGBPalette256& rhs)
+    {
+        for (int i=0;i<256;i++) {
+            entries[i] = rhs.entries[i];
+        }
+        return *this;
+    }
+
+    CRGB48Palette256( const CRGB48Palette16& rhs16)
+    {
+        UpscalePalette( rhs16, *this);
+    }
+    CRGB48Palette256& operator=( const CRGB48Palette16& rhs16)
+    {
+        UpscalePalette( rhs16, *this);
+        return *this;
+    }
+
+    CRGB48Palette256( const CRGBPalette16& rhs16)
+    {
+        UpscalePalette( CRGB48Palette16( rhs16), *this);
+    }
+    CRGB48Palette256& operator=( const CRGBPalette16& rhs16)
+    {
+        UpscalePalette( CRGB48Palette16( rhs16), *this);
+        return *this;
+    }
+
+    inline CRGB48& operator[] (uint8_t x) __attribute__((always_inline))
+    {
+        return entries[x];
+    }
+    inline const CRGB48& operator[] (uint8_t x) const __attribute__((always_inline))
+    {
+        return entries[x];
+    }
+};
+
+/// index 0-65535 spans the palette (4096 steps between two entries of a
+/// CRGB48Palette16, 256 between two of a CRGB48Palette256), brightness
+/// 65535 is full; the last entry blends back into the first, as in the
+/// 8-bit lookups.
+CRGB48 ColorFromPalette( const CRGB48Palette16& pal,
+                         uint16_t index,
+                         uint16_t brightness=65535,
+                         TBlendType blendType=LINEARBLEND);
+
+CRGB48 ColorFromPalette( const CRGB48Palette256& pal,
+                         uint16_t index,
+                         uint16_t brightness=65535,
+                         TBlendType blendType=LINEARBLEND);
+
+
 // Fill a range of LEDs with a sequece of entryies from a palette
 template <typename PALETTE>
 void fill_palette(CRGB* L, uint16_t N, uint8_t startIndex, uint8_t incIndex,
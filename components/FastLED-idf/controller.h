@@ -8,6 +8,7 @@
 #include "led_sysdefs.h"
 #include "pixeltypes.h"
 #include "color.h"
+#include "colormatrix.h"
 #include <stddef.h>
 
 FASTLED_NAMESPACE_BEGIN
@@ -43,6 +44,7 @@ protected:
     CLEDController *m_pNext;
     CRGB m_ColorCorrection;
     CRGB m_ColorTemperature;
+    CRGBMatrix m_ColorMatrix;
     EDitherMode m_DitherMode;
     int m_nLeds;
     static CLEDController *m_pHead;
@@ -142,9 +144,23 @@ public:
     /// get the color temperature, aka whipe point, for this controller
     CRGB getTemperature() { return m_ColorTemperature; }
 
+    /// set the color matrix applied to every pixel on output, see colormatrix.h
+    CLEDController & setColorMatrix(const CRGBMatrix & matrix) { m_ColorMatrix = matrix; return *this; }
+    /// get the color matrix used by this controller
+    const CRGBMatrix & getColorMatrix() { return m_ColorMatrix; }
+
+    /// the color matrix the pixels have to go through, NULL if it is folded into the adjustment
+    const CRGBMatrix * pixelMatrix() const {
+        return (m_ColorMatrix.kind >= MATRIX_DIAGONAL) ? &m_ColorMatrix : NULL;
+    }
+
 	/// Get the combined brightness/color adjustment for this controller
     CRGB getAdjustment(uint8_t scale) {
-        return computeAdjustment(scale, m_ColorCorrection, m_ColorTemperature);
+        CRGB adj = computeAdjustment(scale, m_ColorCorrection, m_ColorTemperature);
+        if(m_ColorMatrix.kind == MATRIX_SCALE) {
+            for(uint8_t i = 0; i < 3; i++) { adj.raw[i] = (adj.raw[i] * m_ColorMatrix.m[i][i]) >> 8; }
+        }
+        return adj;
     }
 
     static CRGB computeAdjustment(uint8_t scale, const CRGB & colorCorrection, const CRGB & colorTemperature) {
@@ -183,6 +199,7 @@ struct PixelController {
         CRGB mScale;
         int8_t mAdvance;
         int mOffsets[LANES];
+        const CRGBMatrix *mMatrix;  // applied to each pixel before dithering, NULL for none
 
         PixelController(const PixelController & other) {
             d[0] = other.d[0];
@@ -193,6 +210,7 @@ struct PixelController {
             e[2] = other.e[2];
             mData = other.mData;
             mScale = other.mScale;
+            mMatrix = other.mMatrix;
             mAdvance = other.mAdvance;
             mLenRemaining = mLen = other.mLen;
             for(int i = 0; i < LANES; i++) { mOffsets[i] = other.mOffsets[i]; }
@@ -207,20 +225,20 @@ struct PixelController {
           }
         }
 
-        PixelController(const uint8_t *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER, bool advance=true, uint8_t skip=0) : mData(d), mLen(len), mLenRemaining(len), mScale(s) {
+        PixelController(const uint8_t *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER, bool advance=true, uint8_t skip=0) : mData(d), mLen(len), mLenRemaining(len), mScale(s), mMatrix(NULL) {
             enable_dithering(dither);
             mData += skip;
             mAdvance = (advance) ? 3+skip : 0;
             initOffsets(len);
         }
 
-        PixelController(const CRGB *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)d), mLen(len), mLenRemaining(len), mScale(s) {
+        PixelController(const CRGB *d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)d), mLen(len), mLenRemaining(len), mScale(s), mMatrix(NULL) {
             enable_dithering(dither);
             mAdvance = 3;
             initOffsets(len);
         }
 
-        PixelController(const CRGB &d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)&d), mLen(len), mLenRemaining(len), mScale(s) {
+        PixelController(const CRGB &d, int len, CRGB & s, EDitherMode dither = BINARY_DITHER) : mData((const uint8_t*)&d), mLen(len), mLenRemaining(len), mScale(s), mMatrix(NULL) {
             enable_dithering(dither);
             mAdvance = 0;
             initOffsets(len);
@@ -340,8 +358,13 @@ struct PixelController {
             d[RO(0)] = e[RO(0)] - d[RO(0)];
         }
 
-        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadByte(PixelController & pc) { return pc.mData[RO(SLOT)]; }
-        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadByte(PixelController & pc, int lane) { return pc.mData[pc.mOffsets[lane] + RO(SLOT)]; }
+        // the color matrix, if any, is applied here, so every load path sees it
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadByte(PixelController & pc) {
+            return pc.mMatrix ? pc.mMatrix->apply(RO(SLOT), pc.mData) : pc.mData[RO(SLOT)];
+        }
+        template<int SLOT>  __attribute__((always_inline)) inline static uint8_t loadByte(PixelController & pc, int lane) {
+            return pc.mMatrix ? pc.mMatrix->apply(RO(SLOT), pc.mData + pc.mOffsets[lane]) : pc.mData[pc.mOffsets[lane] + RO(SLOT)];
+        }
 
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t dither(PixelController & pc, uint8_t b) { return b ? qadd8(b, pc.d[RO(SLOT)]) : 0; }
         template<int SLOT>  __attribute__((always_inline)) inline static uint8_t dither(PixelController & , uint8_t b, uint8_t d) { return b ? qadd8(b,d) : 0; }
@@ -396,6 +419,7 @@ protected:
   ///@param scale the rgb scaling value for outputting color
   virtual void showColor(const struct CRGB & data, int nLeds, CRGB scale) {
     PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither());
+    pixels.mMatrix = pixelMatrix();
     showPixels(pixels);
   }
 
@@ -405,6 +429,7 @@ protected:
 ///@param scale the rgb scaling to apply to each led before writing it out
   virtual void show(const struct CRGB *data, int nLeds, CRGB scale) {
     PixelController<RGB_ORDER, LANES, MASK> pixels(data, nLeds, scale, getDither());
+    pixels.mMatrix = pixelMatrix();
     showPixels(pixels);
   }
 
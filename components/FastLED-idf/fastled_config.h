@@ -66,4 +66,37 @@
 // This enable much more accurate color control on low brightness settings.
 //#define FASTLED_USE_GLOBAL_BRIGHTNESS 1
 
+// Use this toggle to drive APA102 and SK9822 leds in high dynamic range: every pixel gets its own
+// global brightness, picked from its brightest channel, so colours keep their resolution at low
+// brightness settings. Takes precedence over FASTLED_USE_GLOBAL_BRIGHTNESS for these chipsets.
+//#define FASTLED_APA102_HDR 1
+
+// Use this to log heap allocations made by FastLED and the effects after a warm-up period,
+// and to report the stack high-water marks of the tasks calling show(). See alloc_check.h.
+// Also set from menuconfig (CONFIG_FASTLED_ALLOC_CHECK). The default is 0: no checks.
+#ifndef FASTLED_ALLOC_CHECK
+#ifdef CONFIG_FASTLED_ALLOC_CHECK
+#define FASTLED_ALLOC_CHECK 1
+#else
+#define FASTLED_ALLOC_CHECK 0
+#endif
+#endif
+
+// Use this to send a downsampled, delta-encoded copy of the shown frames over UDP for a live
+// preview. See preview.h. Also set from menuconfig (CONFIG_FASTLED_PREVIEW). The default is 0.
+#ifndef FASTLED_PREVIEW
+#ifdef CONFIG_FASTLED_PREVIEW
+#define FASTLED_PREVIEW 1
+#else
+#define FASTLED_PREVIEW 0
+#endif
+#endif
+
+// Storage class of the random16 seed and the other state effects keep between calls. Set it to
+// __thread to give every task its own copy, so WS2812FX instances on virtual clocks can render
+// on several tasks at once (the host renderer does). The default is one copy for all tasks.
+#ifndef FASTLED_THREAD_LOCAL
+#define FASTLED_THREAD_LOCAL
+#endif
+
 #endif
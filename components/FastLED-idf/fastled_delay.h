@@ -34,7 +34,7 @@ public:
 		else { /*buzz is only other option outch */
 			do {
 				waited = esp_timer_get_time() - mLastMicros;
-			} while( waited > WAIT);
+			} while( waited < WAIT);
 		}
 	}
 
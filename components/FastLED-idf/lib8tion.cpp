@@ -5,7 +5,7 @@
 FASTLED_NAMESPACE_BEGIN
 
 #define RAND16_SEED  1337
-uint16_t rand16seed = RAND16_SEED;
+FASTLED_THREAD_LOCAL uint16_t rand16seed = RAND16_SEED;
 
 
 // memset8, memcpy8, memmove8:
@@ -26,6 +26,48 @@ uint16_t rand16seed = RAND16_SEED;
 //  than standard avr-libc, at a cost of a few extra
 //  bytes of code.
 
+// memfill24: the pattern is written byte by byte until ptr is word
+//  aligned, rotating it as it goes.  Twelve bytes then hold four
+//  copies of it, in whatever phase it is in, which are stored as three
+//  words until fewer than twelve bytes are left.
+typedef uint32_t __attribute__((__may_alias__)) uint32_alias_t;
+
+void * memfill24( void * ptr, const uint8_t * pattern, uint32_t count )
+{
+    uint8_t * p = (uint8_t *)ptr;
+    uint8_t a = pattern[0], b = pattern[1], c = pattern[2], t;
+    uint32_t bytes = count * 3;
+
+    while( bytes && ((uintptr_t)p & 3)) {
+        *p++ = a;
+        t = a; a = b; b = c; c = t;
+        bytes--;
+    }
+
+    if( bytes >= 12) {
+        uint8_t four[12] = { a, b, c, a, b, c, a, b, c, a, b, c };
+        uint32_t w0, w1, w2;
+        memcpy( &w0, four, 4);
+        memcpy( &w1, four + 4, 4);
+        memcpy( &w2, four + 8, 4);
+        uint32_alias_t * pw = (uint32_alias_t *)p;
+        while( bytes >= 12) {
+            pw[0] = w0;
+            pw[1] = w1;
+            pw[2] = w2;
+            pw += 3;
+            bytes -= 12;
+        }
+        p = (uint8_t *)pw;
+    }
+
+    while( bytes--) {
+        *p++ = a;
+        t = a; a = b; b = c; c = t;
+    }
+    return ptr;
+}
+
 #if defined(__AVR__)
 extern "C" {
 //__attribute__ ((noinline))
@@ -463,12 +463,19 @@ void * memcpy8 ( void * dst, const void * src, uint16_t num )  __attribute__ ((n
 void * memset8 ( void * ptr, uint8_t value, uint16_t num ) __attribute__ ((noinline)) ;
 }
 #else
-// on non-AVR platforms, these names just call standard libc.
+// on non-AVR platforms, these names just call standard libc, whose
+// versions already go a word at a time and take size_t lengths.
 #define memmove8 memmove
 #define memcpy8 memcpy
 #define memset8 memset
 #endif
 
+// memfill24: fills count copies of a three byte pattern, such as a
+//   CRGB or a CHSV, starting at ptr.  Past the first few bytes it
+//   writes whole aligned words, three words for every four copies,
+//   which is what memset8 does for a single byte.
+void * memfill24( void * ptr, const uint8_t * pattern, uint32_t count );
+
 
 ///////////////////////////////////////////////////////////////////////
 //
@@ -925,8 +932,15 @@ typedef q<uint16_t, 12,4> q124;
 // It's a little expensive to get micros and divide, but.... good for now and later we'll
 // fix that uses it
 
+// Define USE_GET_MILLISECOND_TIMER before including FastLED.h to supply the timer yourself,
+// as WS2812FX does so that its effects follow the clock of the instance rendering them.
+
 #define GET_MILLIS() (get_millisecond_timer())
+#ifdef USE_GET_MILLISECOND_TIMER
+uint32_t get_millisecond_timer();
+#else
 static inline uint32_t get_millisecond_timer() { return( esp_timer_get_time() / 1000);  }
+#endif
 
 // beat16 generates a 16-bit 'sawtooth' wave at a given BPM,
 ///        with BPM specified in Q8.8 fixed-point format; e.g.
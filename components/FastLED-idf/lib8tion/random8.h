@@ -19,7 +19,7 @@
 #endif
 
 /// random number seed
-extern uint16_t rand16seed;// = RAND16_SEED;
+extern FASTLED_THREAD_LOCAL uint16_t rand16seed;// = RAND16_SEED;
 
 /// Generate an 8-bit random number
 LIB8STATIC uint8_t random8()
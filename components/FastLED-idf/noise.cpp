@@ -545,12 +545,135 @@ uint8_t inoise8(uint16_t x) {
     return ans;
 }
 
+// Simplex noise: the lattice is made of triangles (2d) or tetrahedra (3d), so a sample
+// sums the contributions of 3 or 4 corners instead of interpolating between 4 or 8.
+// Coordinates are skewed onto the lattice in 16.16 (wrapping, like the coordinates), the
+// corner offsets are Q15. The raw values are scaled to the spread of inoise16_raw.
+
+// (sqrt(3)-1)/2 and (3-sqrt(3))/6 in Q16, 1/3 and 1/6 in Q16
+#define SIMPLEX_F2 23987
+#define SIMPLEX_G2 13849
+#define SIMPLEX_F3 21845
+#define SIMPLEX_G3 10923
+
+// -- Contribution of one corner, (0.5 - d^2)^4 * gradient, in Q15
+static int32_t inline __attribute__((always_inline)) simplex_corner(uint8_t hash, int32_t x, int32_t y) {
+  uint32_t d = (uint32_t)(x*x) + (uint32_t)(y*y);
+  if(d >= (1UL<<29)) { return 0; }
+  int32_t t = ((1L<<29) - d) >> 15;
+  t = (t*t) >> 15;
+  t = (t*t) >> 15;
+  return (t * grad16(hash, x, y)) >> 15;
+}
+
+static int32_t inline __attribute__((always_inline)) simplex_corner(uint8_t hash, int32_t x, int32_t y, int32_t z) {
+  uint32_t d = (uint32_t)(x*x) + (uint32_t)(y*y) + (uint32_t)(z*z);
+  if(d >= (1UL<<29)) { return 0; }
+  int32_t t = ((1L<<29) - d) >> 15;
+  t = (t*t) >> 15;
+  t = (t*t) >> 15;
+  return (t * grad16(hash, x, y, z)) >> 15;
+}
+
+int16_t snoise16_raw(uint32_t x, uint32_t y)
+{
+  // Skew the point onto the lattice, find its cell and the offset in the cell
+  uint32_t s = ((x >> 16) + (y >> 16)) * SIMPLEX_F2 + ((((x & 0xFFFF) + (y & 0xFFFF)) * SIMPLEX_F2) >> 16);
+  uint32_t xs = x + s;
+  uint32_t ys = y + s;
+  uint8_t X = xs >> 16;
+  uint8_t Y = ys >> 16;
+  int32_t xf = (xs & 0xFFFF) >> 1;
+  int32_t yf = (ys & 0xFFFF) >> 1;
+
+  // Unskew the offset back to the distance from the cell's origin corner
+  int32_t t = ((xf + yf) * SIMPLEX_G2) >> 16;
+  int32_t x0 = xf - t;
+  int32_t y0 = yf - t;
+
+  // Lower or upper triangle of the cell
+  uint8_t i1 = (xf > yf);
+  uint8_t j1 = !i1;
+  int32_t x1 = x0 - (i1 << 15) + (SIMPLEX_G2 >> 1);
+  int32_t y1 = y0 - (j1 << 15) + (SIMPLEX_G2 >> 1);
+  int32_t x2 = x0 - 0x8000 + SIMPLEX_G2;
+  int32_t y2 = y0 - 0x8000 + SIMPLEX_G2;
+
+  int32_t n = simplex_corner(P((uint8_t)(P(X)+Y)), x0, y0);
+  n += simplex_corner(P((uint8_t)(P(X+i1)+Y+j1)), x1, y1);
+  n += simplex_corner(P((uint8_t)(P(X+1)+Y+1)), x2, y2);
+
+  return n * 75;
+}
+
+uint16_t snoise16(uint32_t x, uint32_t y) {
+  int32_t ans = snoise16_raw(x,y) + 32768L;
+  return (ans > 65535) ? 65535 : ((ans < 0) ? 0 : ans);
+}
+
+int16_t snoise16_raw(uint32_t x, uint32_t y, uint32_t z)
+{
+  // Skew the point onto the lattice, find its cell and the offset in the cell
+  uint32_t s = ((x >> 16) + (y >> 16) + (z >> 16)) * SIMPLEX_F3 + ((((x & 0xFFFF) + (y & 0xFFFF) + (z & 0xFFFF)) * SIMPLEX_F3) >> 16);
+  uint32_t xs = x + s;
+  uint32_t ys = y + s;
+  uint32_t zs = z + s;
+  uint8_t X = xs >> 16;
+  uint8_t Y = ys >> 16;
+  uint8_t Z = zs >> 16;
+  int32_t xf = (xs & 0xFFFF) >> 1;
+  int32_t yf = (ys & 0xFFFF) >> 1;
+  int32_t zf = (zs & 0xFFFF) >> 1;
+
+  // Unskew the offset back to the distance from the cell's origin corner
+  int32_t t = ((xf + yf + zf) * SIMPLEX_G3) >> 16;
+  int32_t x0 = xf - t;
+  int32_t y0 = yf - t;
+  int32_t z0 = zf - t;
+
+  // Which of the six tetrahedra of the cell, from the order of the offsets
+  uint8_t i1, j1, k1, i2, j2, k2;
+  if(xf >= yf) {
+    if(yf >= zf)      { i1=1; j1=0; k1=0; i2=1; j2=1; k2=0; }
+    else if(xf >= zf) { i1=1; j1=0; k1=0; i2=1; j2=0; k2=1; }
+    else              { i1=0; j1=0; k1=1; i2=1; j2=0; k2=1; }
+  } else {
+    if(yf < zf)       { i1=0; j1=0; k1=1; i2=0; j2=1; k2=1; }
+    else if(xf < zf)  { i1=0; j1=1; k1=0; i2=0; j2=1; k2=1; }
+    else              { i1=0; j1=1; k1=0; i2=1; j2=1; k2=0; }
+  }
+  int32_t g1 = SIMPLEX_G3 >> 1;
+  int32_t g2 = SIMPLEX_G3;
+  int32_t g3 = (3 * SIMPLEX_G3) >> 1;
+
+  int32_t n = simplex_corner(P((uint8_t)(P((uint8_t)(P(X)+Y))+Z)), x0, y0, z0);
+  n += simplex_corner(P((uint8_t)(P((uint8_t)(P(X+i1)+Y+j1))+Z+k1)), x0 - (i1 << 15) + g1, y0 - (j1 << 15) + g1, z0 - (k1 << 15) + g1);
+  n += simplex_corner(P((uint8_t)(P((uint8_t)(P(X+i2)+Y+j2))+Z+k2)), x0 - (i2 << 15) + g2, y0 - (j2 << 15) + g2, z0 - (k2 << 15) + g2);
+  n += simplex_corner(P((uint8_t)(P((uint8_t)(P(X+1)+Y+1))+Z+1)), x0 - 0x8000 + g3, y0 - 0x8000 + g3, z0 - 0x8000 + g3);
+
+  return n * 89;
+}
+
+uint16_t snoise16(uint32_t x, uint32_t y, uint32_t z) {
+  int32_t ans = snoise16_raw(x,y,z) + 32768L;
+  return (ans > 65535) ? 65535 : ((ans < 0) ? 0 : ans);
+}
+
+uint8_t snoise8(uint16_t x, uint16_t y) {
+  return snoise16((uint32_t)x << 8, (uint32_t)y << 8) >> 8;
+}
+
+uint8_t snoise8(uint16_t x, uint16_t y, uint16_t z) {
+  return snoise16((uint32_t)x << 8, (uint32_t)y << 8, (uint32_t)z << 8) >> 8;
+}
+
 // struct q44 {
 //   uint8_t i:4;
 //   uint8_t f:4;
 //   q44(uint8_t _i, uint8_t _f) {i=_i; f=_f; }
 // };
 
+
 // uint32_t mul44(uint32_t v, q44 mulby44) {
 //     return (v *mulby44.i)  + ((v * mulby44.f) >> 4);
 // }
@@ -697,6 +820,59 @@ void fill_raw_2dnoise16into8(uint8_t *pData, int width, int height, uint8_t octa
   fill_raw_2dnoise16into8(pData, width, height, octaves, q44(2,0), 171, 1, x, scalex, y, scaley, time);
 }
 
+void fill_raw_snoise16into8(uint8_t *pData, uint8_t num_points, uint8_t octaves, uint32_t x, int scale, uint32_t time) {
+  uint32_t _xx = x;
+  uint32_t scx = scale;
+  for(int o = 0; o < octaves; o++) {
+    for(int i = 0,xx=_xx; i < num_points; i++, xx+=scx) {
+      uint32_t accum = (snoise16(xx,time))>>o;
+      accum += (pData[i]<<8);
+      if(accum > 65535) { accum = 65535; }
+      pData[i] = accum>>8;
+    }
+
+    _xx <<= 1;
+    scx <<= 1;
+  }
+}
+
+void fill_raw_2dsnoise16into8(uint8_t *pData, int width, int height, uint8_t octaves, q44 freq44, fract8 amplitude, int skip, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
+  if(octaves > 1) {
+    fill_raw_2dsnoise16into8(pData, width, height, octaves-1, freq44, amplitude, skip+1, x*freq44, scalex *freq44, y*freq44, scaley * freq44, time);
+  } else {
+    // amplitude is always 255 on the lowest level
+    amplitude=255;
+  }
+
+  scalex *= skip;
+  scaley *= skip;
+  uint32_t xx;
+  fract8 invamp = 255-amplitude;
+  for(int i = 0; i < height; i+=skip, y+=scaley) {
+    uint8_t *pRow = pData + (i*width);
+    xx = x;
+    for(int j = 0; j < width; j+=skip, xx+=scalex) {
+      uint16_t noise_base = snoise16(xx,y,time);
+      noise_base = (0x8000 & noise_base) ? noise_base - (32767) : 32767 - noise_base;
+      noise_base = scale8(noise_base>>7,amplitude);
+      if(skip==1) {
+        pRow[j] = qadd8(scale8(pRow[j],invamp),noise_base);
+      } else {
+        for(int ii = i; ii<(i+skip) && ii<height; ii++) {
+          uint8_t *pRow = pData + (ii*width);
+          for(int jj=j; jj<(j+skip) && jj<width; jj++) {
+            pRow[jj] = scale8(pRow[jj],invamp) + noise_base;
+          }
+        }
+      }
+    }
+  }
+}
+
+void fill_raw_2dsnoise16into8(uint8_t *pData, int width, int height, uint8_t octaves, uint32_t x, int scalex, uint32_t y, int scaley, uint32_t time) {
+  fill_raw_2dsnoise16into8(pData, width, height, octaves, q44(2,0), 171, 1, x, scalex, y, scaley, time);
+}
+
 void fill_noise8(CRGB *leds, int num_leds,
             uint8_t octaves, uint16_t x, int scale,
             uint8_t hue_octaves, uint16_t hue_x, int hue_scale,
@@ -0,0 +1,168 @@
+#define FASTLED_INTERNAL
+#include "parallel.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#else
+#include <pthread.h>
+#endif
+
+FASTLED_NAMESPACE_BEGIN
+
+// -- A posted job goes from POSTED to RUNNING when the worker picks it up, and to
+//    DONE when the worker is through, or when the caller takes the job back first
+enum { JOB_DONE, JOB_POSTED, JOB_RUNNING };
+
+struct ParallelJob {
+	parallel_body body;
+	void * ctx;
+	int next;				// first pixel nobody claimed yet
+	int end;
+	int chunk;
+	volatile int state;
+};
+
+static ParallelJob gJob;
+static int gInUse = 0;		// set while a parallel_run() owns the worker
+static volatile bool gRunning = false;
+
+static void run_chunks(ParallelJob & job) {
+	for(;;) {
+		int b = __atomic_fetch_add(&job.next, job.chunk, __ATOMIC_RELAXED);
+		if(b >= job.end) { return; }
+		int e = b + job.chunk;
+		job.body(job.ctx, b, e < job.end ? e : job.end);
+	}
+}
+
+static void worker_run() {
+	int posted = JOB_POSTED;
+	if(__atomic_compare_exchange_n(&gJob.state, &posted, JOB_RUNNING, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		run_chunks(gJob);
+		__atomic_store_n(&gJob.state, JOB_DONE, __ATOMIC_RELEASE);
+	}
+}
+
+#ifdef ESP_PLATFORM
+
+static const char *TAG = "FastLED";
+static TaskHandle_t gWorker = NULL;
+static volatile bool gWorkerAlive = false;
+
+static void parallelTask(void * arg) {
+	for(;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if(!gRunning) { break; }
+		worker_run();
+	}
+	gWorkerAlive = false;
+	vTaskDelete(NULL);
+}
+
+bool parallel_begin() {
+	if(gRunning) { return true; }
+#if CONFIG_FREERTOS_UNICORE
+	return false;
+#else
+	gRunning = true;
+	gWorkerAlive = true;
+	BaseType_t core = 1 - xPortGetCoreID();
+	if(xTaskCreatePinnedToCore(parallelTask, "fastled_par", FASTLED_PARALLEL_STACK, NULL, uxTaskPriorityGet(NULL), &gWorker, core) != pdPASS) {
+		ESP_LOGE(TAG, "parallel: no worker task");
+		gRunning = false;
+		gWorkerAlive = false;
+		return false;
+	}
+	return true;
+#endif
+}
+
+void parallel_end() {
+	if(!gRunning) { return; }
+	while(__atomic_exchange_n(&gInUse, 1, __ATOMIC_ACQUIRE)) { vTaskDelay(1); }
+	gRunning = false;
+	xTaskNotifyGive(gWorker);
+	while(gWorkerAlive) { vTaskDelay(1); }
+	gWorker = NULL;
+	__atomic_store_n(&gInUse, 0, __ATOMIC_RELEASE);
+}
+
+static inline void wake_worker() { xTaskNotifyGive(gWorker); }
+
+#else
+
+static pthread_t gThread;
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gWake = PTHREAD_COND_INITIALIZER;
+static unsigned gPosts = 0;
+
+static void * parallelThread(void * arg) {
+	unsigned seen = 0;
+	for(;;) {
+		pthread_mutex_lock(&gLock);
+		while(seen == gPosts && gRunning) { pthread_cond_wait(&gWake, &gLock); }
+		seen = gPosts;
+		pthread_mutex_unlock(&gLock);
+		if(!gRunning) { return NULL; }
+		worker_run();
+	}
+}
+
+bool parallel_begin() {
+	if(gRunning) { return true; }
+	gRunning = true;
+	if(pthread_create(&gThread, NULL, parallelThread, NULL) != 0) {
+		gRunning = false;
+		return false;
+	}
+	return true;
+}
+
+void parallel_end() {
+	if(!gRunning) { return; }
+	while(__atomic_exchange_n(&gInUse, 1, __ATOMIC_ACQUIRE)) { }
+	pthread_mutex_lock(&gLock);
+	gRunning = false;
+	pthread_cond_signal(&gWake);
+	pthread_mutex_unlock(&gLock);
+	pthread_join(gThread, NULL);
+	__atomic_store_n(&gInUse, 0, __ATOMIC_RELEASE);
+}
+
+static inline void wake_worker() {
+	pthread_mutex_lock(&gLock);
+	gPosts++;
+	pthread_cond_signal(&gWake);
+	pthread_mutex_unlock(&gLock);
+}
+
+#endif
+
+void parallel_run(int begin, int end, parallel_body body, void * ctx, int chunk) {
+	int n = end - begin;
+	if(n < FASTLED_PARALLEL_MIN_RANGE || (!gRunning && !parallel_begin()) ||
+	   __atomic_exchange_n(&gInUse, 1, __ATOMIC_ACQUIRE)) {
+		if(n > 0) { body(ctx, begin, end); }
+		return;
+	}
+
+	gJob.body = body;
+	gJob.ctx = ctx;
+	gJob.next = begin;
+	gJob.end = end;
+	gJob.chunk = chunk > 0 ? chunk : (n + 1) / 2;
+	__atomic_store_n(&gJob.state, JOB_POSTED, __ATOMIC_RELEASE);
+	wake_worker();
+
+	run_chunks(gJob);
+
+	// -- If the worker has not started yet, every chunk is taken: call it off rather than
+	//    wait for it to be scheduled. Otherwise it is in its last chunk, wait for that.
+	int posted = JOB_POSTED;
+	if(!__atomic_compare_exchange_n(&gJob.state, &posted, JOB_DONE, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+		while(__atomic_load_n(&gJob.state, __ATOMIC_ACQUIRE) != JOB_DONE) { }
+	}
+	__atomic_store_n(&gInUse, 0, __ATOMIC_RELEASE);
+}
+
+FASTLED_NAMESPACE_END
@@ -0,0 +1,89 @@
+#ifndef __INC_PARALLEL_H
+#define __INC_PARALLEL_H
+
+#ifdef ESP_PLATFORM
+#include "FastLED.h"
+#else
+// -- Host build, with a pthread worker, for testing and benchmarking on a PC
+#include <stdint.h>
+#ifndef FASTLED_NAMESPACE_BEGIN
+#define FASTLED_NAMESPACE_BEGIN
+#define FASTLED_NAMESPACE_END
+#endif
+#endif
+
+///@file parallel.h
+/// splitting pixel loops between both cores
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup Parallel Dual-core pixel loops
+/// parallel_for() runs a loop body over [begin, end), shared between the calling task
+/// and a persistent worker task pinned to the other core, and returns once both are
+/// done. The range is cut into chunks that the caller and the worker claim in turn:
+/// with chunk 0 it is cut in two halves, otherwise into chunks of that many pixels,
+/// which balances uneven work better at the cost of a few more claims.
+///
+/// Handing out the work costs a task notification, so it pays off from a few hundred
+/// cheap pixels (or a few dozen ColorFromPalette() calls) up. Ranges shorter than
+/// FASTLED_PARALLEL_MIN_RANGE, nested calls and calls made while another task owns the
+/// worker simply run in the caller. If the worker has not woken up by the time the
+/// caller ran out of chunks, the caller takes its share back rather than wait for it.
+///
+/// The body must only touch its own pixels, and must not call show().
+///
+/// Example:
+///  parallel_for(0, NUM_LEDS, [&](int i) {
+///      leds[i] = ColorFromPalette(currentPalette, startIndex + 3 * i, 64, currentBlending);
+///  });
+///@{
+
+/// Shorter ranges are not split
+#ifndef FASTLED_PARALLEL_MIN_RANGE
+#define FASTLED_PARALLEL_MIN_RANGE 32
+#endif
+
+/// Stack of the worker task, in bytes. The worker runs the loop bodies on it, so a
+/// body with large locals or deep calls (printf, for one) needs more. The host build
+/// leaves its thread the default stack.
+#ifndef FASTLED_PARALLEL_STACK
+#define FASTLED_PARALLEL_STACK 4096
+#endif
+
+/// Loop body over [begin, end), with the context passed to parallel_run()
+typedef void (*parallel_body)(void * ctx, int begin, int end);
+
+/// Start the worker on the core the caller does not run on, at the caller's priority.
+/// parallel_run() calls it when needed; returns false if there is no second core.
+bool parallel_begin();
+
+/// Stop the worker
+void parallel_end();
+
+/// Run body over [begin, end), shared with the worker, and return when all of it ran
+void parallel_run(int begin, int end, parallel_body body, void * ctx, int chunk = 0);
+
+/// Run f(i) for every i in [begin, end), shared with the worker
+template<class F> void parallel_for(int begin, int end, F f, int chunk = 0) {
+	struct Body {
+		static void run(void * ctx, int b, int e) {
+			F & fn = *(F *)ctx;
+			for(int i = b; i < e; i++) { fn(i); }
+		}
+	};
+	parallel_run(begin, end, &Body::run, &f, chunk);
+}
+
+/// Run f(b, e) over sub-ranges covering [begin, end), shared with the worker
+template<class F> void parallel_for_range(int begin, int end, F f, int chunk = 0) {
+	struct Body {
+		static void run(void * ctx, int b, int e) { (*(F *)ctx)(b, e); }
+	};
+	parallel_run(begin, end, &Body::run, &f, chunk);
+}
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -864,6 +864,48 @@ inline CRGB operator%( const CRGB& p1, uint8_t d)
 }
 
 
+/// Representation of an RGB pixel with 16 bits per channel, as returned by the
+/// high precision palette lookups; 65535 is full intensity.
+struct CRGB48 {
+    union {
+        struct {
+            uint16_t r;
+            uint16_t g;
+            uint16_t b;
+        };
+        uint16_t raw[3];
+    };
+
+    /// default values are UNINITIALIZED
+    inline CRGB48() __attribute__((always_inline))
+    {
+    }
+
+    /// allow construction from 16-bit R, G, B
+    inline CRGB48( uint16_t ir, uint16_t ig, uint16_t ib)  __attribute__((always_inline))
+        : r(ir), g(ig), b(ib)
+    {
+    }
+
+    /// allow construction from an 8-bit CRGB, scaling 255 to 65535
+    inline CRGB48( const CRGB& rhs) __attribute__((always_inline))
+        : r(rhs.r * 257), g(rhs.g * 257), b(rhs.b * 257)
+    {
+    }
+
+    /// reduce to 8 bits per channel. dither is added to the dropped low byte
+    /// before truncating: 128 rounds to nearest, and varying it from frame to
+    /// frame (or pixel to pixel) dithers the extra precision in time.
+    inline CRGB toCRGB( uint8_t dither = 128) const __attribute__((always_inline))
+    {
+        // v - (v >> 8) maps 0..65535 onto 0..255*256 so nothing overflows
+        return CRGB( (r - (r >> 8) + dither) >> 8,
+                     (g - (g >> 8) + dither) >> 8,
+                     (b - (b >> 8) + dither) >> 8);
+    }
+};
+
+
 
 /// RGB orderings, used when instantiating controllers to determine what
 /// order the controller should send RGB data out in, RGB being the default
@@ -5,9 +5,19 @@
 
 #define PORT_MASK (((1<<LANES)-1) & 0x0000FFFFL)
 #define MIN(X,Y) (((X)<(Y)) ? (X):(Y))
-#define USED_LANES (MIN(LANES,4))
-#define REAL_FIRST_PIN 12
-#define LAST_PIN (12 + USED_LANES - 1)
+// -- Lanes sent: one per pin of FASTLED_ESP32_BLOCK_PINS, up to the 8 bits that each
+//    transposed byte of writeBits() holds
+#define USED_LANES (MIN(MIN(LANES, LanePins::lanes()), 8))
+
+#ifndef CLKS_PER_US
+#define CLKS_PER_US (F_CPU/1000000)
+#endif
+
+// -- The pins of the lanes, lane 0 first. They can be on either bank:
+//    each edge is then one store per bank, see FastPinGroup.
+#ifndef FASTLED_ESP32_BLOCK_PINS
+#define FASTLED_ESP32_BLOCK_PINS 12, 13, 14, 15
+#endif
 
 FASTLED_NAMESPACE_BEGIN
 
@@ -21,6 +31,8 @@ class InlineBlockClocklessController : public CPixelLEDController<RGB_ORDER, LAN
     typedef typename FastPin<FIRST_PIN>::port_ptr_t data_ptr_t;
     typedef typename FastPin<FIRST_PIN>::port_t data_t;
 
+    typedef FastPinGroup<FASTLED_ESP32_BLOCK_PINS> LanePins;
+
     data_t mPinMask;
     data_ptr_t mPort;
     CMinWait<WAIT_TIME> mWait;
@@ -48,20 +60,9 @@ public:
 	// mWait.mark();
     }
 
-    template<int PIN> static void initPin() {
-	if(PIN >= REAL_FIRST_PIN && PIN <= LAST_PIN) {
-	    _ESPPIN<PIN, 1<<(PIN & 0xFF)>::setOutput();
-	    // FastPin<PIN>::setOutput();
-	}
-    }
-
     virtual void init() {
-	// Only supportd on pins 12-15
-        // SZG: This probably won't work (check pins definitions in fastpin_esp32)
-	initPin<12>();
-	initPin<13>();
-	initPin<14>();
-	initPin<15>();
+	// Only on the pins of FASTLED_ESP32_BLOCK_PINS, 12-15 by default
+	LanePins::setOutput();
 	mPinMask = FastPin<FIRST_PIN>::mask();
 	mPort = FastPin<FIRST_PIN>::port();
 	
@@ -88,14 +89,16 @@ public:
 	for(register uint32_t i = 0; i < USED_LANES; i++) {
 	    while((__clock_cycles() - last_mark) < (T1+T2+T3));
 	    last_mark = __clock_cycles();
-	    *FastPin<FIRST_PIN>::sport() = PORT_MASK << REAL_FIRST_PIN;
+	    LanePins::hi(PORT_MASK);
 	    
-	    uint32_t nword = ((uint32_t)(~b2.bytes[7-i]) & PORT_MASK) << REAL_FIRST_PIN;
+	    uint32_t zeros = (uint32_t)(~b2.bytes[7-i]) & PORT_MASK;
+	    data_t nword0 = LanePins::mask0(zeros);
+	    data_t nword1 = LanePins::mask1(zeros);
 	    while((__clock_cycles() - last_mark) < (T1-6));
-	    *FastPin<FIRST_PIN>::cport() = nword;
+	    LanePins::loMasks(nword0, nword1);
 	    
 	    while((__clock_cycles() - last_mark) < (T1+T2));
-	    *FastPin<FIRST_PIN>::cport() = PORT_MASK << REAL_FIRST_PIN;
+	    LanePins::lo(PORT_MASK);
 	    
 	    b.bytes[i] = pixels.template loadAndScale<PX>(pixels,i,d,scale);
 	}
@@ -103,14 +106,16 @@ public:
 	for(register uint32_t i = USED_LANES; i < 8; i++) {
 	    while((__clock_cycles() - last_mark) < (T1+T2+T3));
 	    last_mark = __clock_cycles();
-	    *FastPin<FIRST_PIN>::sport() = PORT_MASK << REAL_FIRST_PIN;
+	    LanePins::hi(PORT_MASK);
 	    
-	    uint32_t nword = ((uint32_t)(~b2.bytes[7-i]) & PORT_MASK) << REAL_FIRST_PIN;
+	    uint32_t zeros = (uint32_t)(~b2.bytes[7-i]) & PORT_MASK;
+	    data_t nword0 = LanePins::mask0(zeros);
+	    data_t nword1 = LanePins::mask1(zeros);
 	    while((__clock_cycles() - last_mark) < (T1-6));
-	    *FastPin<FIRST_PIN>::cport() = nword;
+	    LanePins::loMasks(nword0, nword1);
 	    
 	    while((__clock_cycles() - last_mark) < (T1+T2));
-	    *FastPin<FIRST_PIN>::cport() = PORT_MASK << REAL_FIRST_PIN;
+	    LanePins::lo(PORT_MASK);
 	}
     }
 
@@ -5,9 +5,10 @@
  * Copyright (c) 2019 Samuel Z. Guyer
  * Derived from lots of code examples from other people.
  *
- * The I2S implementation can drive up to 24 strips in parallel, but
- * with the following limitation: all the strips must have the same
- * timing (i.e., they must all use the same chip).
+ * The I2S implementation can drive up to 24 strips in parallel. The
+ * strips may use different chipsets: all of them share one pulse grid
+ * and one bit period, and each strip gets its own high times for a "0"
+ * and a "1" bit (see MIXED CHIPSETS below).
  *
  * To enable the I2S driver, add the following line *before* including
  * FastLED.h (no other changes are necessary):
@@ -63,6 +64,65 @@
  * buffer while the next one is being sent. The DMA interface allows
  * us to configure the buffers as a circularly linked list, so that it
  * can automatically start on the next buffer.
+ *
+ * RACE-THE-BEAM RENDERING
+ *
+ * Normally the whole frame is rendered before show() is called, so
+ * the first pixel leaves the chip only after the last one has been
+ * computed. For interactive installations the program can instead
+ * register a pixel producer:
+ *
+ *     i2sSetPixelProducer(renderRange, &myState, 16);
+ *
+ * show() then calls renderRange(arg, start, count) for chunks of 16
+ * pixel rows (the same index range on every strip), starts the DMA
+ * as soon as the first chunk is ready, and renders the remaining
+ * chunks while the interrupt handler is sending. The producer writes
+ * straight into the CRGB arrays given to addLeds(). If the encoder
+ * catches up with the producer, the row is sent with whatever the
+ * array holds (usually the previous frame) and counted as an
+ * underrun. i2sSetLatencyHook() reports the timing of every frame.
+ * Power limiting (setMaxPowerInVoltsAndMilliamps()) is done by
+ * CFastLED::show() before any controller runs, so before the producer
+ * renders: it measures what the arrays hold then, the previous frame.
+ *
+ * SHADER OUTPUT
+ *
+ * Very long strips driven by formula-based effects do not need a
+ * pixel buffer at all. Add the strip with a NULL array and attach a
+ * shader to the controller:
+ *
+ *     CLEDController & c = FastLED.addLeds<WS2812, 18, GRB>((CRGB *)NULL, 50000);
+ *     i2sSetPixelShader(c, plasmaRows, &myState);
+ *
+ * show() calls plasmaRows(arg, out, start, count) to compute pixels
+ * [start, start + count) into out, a ring of FASTLED_I2S_SHADER_ROWS
+ * pixels that the interrupt handler sends from. Memory use is the ring,
+ * independent of the strip length. Shaders run in the task that calls
+ * show(), in chunks, just like a pixel producer. Whenever the ring is
+ * full the task blocks until the interrupt handler has sent enough of
+ * it, so other tasks on that core run meanwhile. showColor() still works
+ * on shader strips. Power limiting ignores them, since they have no
+ * pixel data to measure.
+ *
+ * MIXED CHIPSETS
+ *
+ * When all strips use the same chipset, the pulse length and count are
+ * found by Yves' search in initBitPatterns(). When they differ, the
+ * driver instead picks an integer clock divider, with a bit period long
+ * enough for the slowest chipset, and keeps per-lane masks:
+ *
+ *    gHighMask[p]   lanes that are HIGH in pulse p whatever the bit
+ *    gDataMask[p]   lanes that send the data bit in pulse p
+ *
+ * Faster chipsets then get a longer low time, which they tolerate. Each
+ * lane is held to the limits of its chipset: the datasheet windows of
+ * the profiles with a ClocklessTimingCheck (WS2812, SK6812 and their
+ * overclocked ones, see chipsets.h), and otherwise its own high times
+ * within FASTLED_I2S_MIXED_TOLERANCE_NS. If no divider keeps every lane
+ * inside its window, the mix is refused with an error naming the lane,
+ * and all lanes get the last controller's timing. The grid is
+ * recomputed at the first show() after a controller is added.
  */
 /*
  * Permission is hereby granted, free of charge, to any person obtaining a copy
@@ -115,11 +175,18 @@ extern "C" {
 }
 #endif
 
+#ifdef ESP_PLATFORM
 __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
     uint32_t cyc;
     __asm__ __volatile__ ("rsr %0,ccount":"=a" (cyc));
     return cyc;
 }
+#else
+// -- Host build (see host/): the cycles of the CPU clock
+inline static uint32_t __clock_cycles() {
+    return (uint32_t)(esp_timer_get_time() * F_CPU_MHZ);
+}
+#endif
 
 #define FASTLED_HAS_CLOCKLESS 1
 #define NUM_COLOR_CHANNELS 3
@@ -138,6 +205,13 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
 #define I2S_BASE_CLK (80000000L)
 #define I2S_MAX_CLK (20000000L) //more tha a certain speed and the I2s loses some bits
 #define I2S_MAX_PULSE_PER_BIT 20 //put it higher to get more accuracy but it could decrease the refresh rate without real improvement
+#define I2S_MAX_MIXED_PULSE_PER_BIT 40 // size of the bit pattern arrays
+// -- On a mixed grid, a chipset without registered limits keeps its high
+//    times within this many ns, and its low time at most this much shorter.
+//    The WS281x datasheets allow 150ns (WS2811) down to 80ns (WS2812B)
+#ifndef FASTLED_I2S_MIXED_TOLERANCE_NS
+#define FASTLED_I2S_MIXED_TOLERANCE_NS 75
+#endif
 // -- Convert ESP32 cycles back into nanoseconds
 #define ESPCLKS_TO_NS(_CLKS) (((long)(_CLKS) * 1000L) / F_CPU_MHZ)
 
@@ -150,6 +224,9 @@ static int gNumStarted = 0;
 //    Semaphore is not given until all data has been sent
 static xSemaphoreHandle gTX_sem = NULL;
 
+// -- Given by the interrupt handler when the shader ring has room again
+static xSemaphoreHandle gRing_sem = NULL;
+
 // -- One-time I2S initialization
 static bool gInitialized = false;
 
@@ -172,8 +249,9 @@ struct DMABuffer {
 static DMABuffer * dmaBuffers[NUM_DMA_BUFFERS];
 
 // -- Bit patterns
-//    For now, we require all strips to be the same chipset, so these
-//    are global variables.
+//    All strips share the pulse grid. ones_for_zero and ones_for_one
+//    are the first and the end of the pulses that carry data on any
+//    lane; gHighMask and gDataMask say which lanes do what in each pulse.
 
 static int      gPulsesPerBit = 0;
 static uint32_t gOneBit[40] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
@@ -184,6 +262,25 @@ static int gCurBuffer = 0;
 static bool gDoneFilling = false;
 static int ones_for_one;
 static int ones_for_zero;
+static uint32_t gHighMask[I2S_MAX_MIXED_PULSE_PER_BIT];
+static uint32_t gDataMask[I2S_MAX_MIXED_PULSE_PER_BIT];
+
+// -- Timing of each lane (controller), in ESP32 cycles, and the window
+//    its high and low times must stay in on a mixed grid, in ns
+struct I2SLaneTiming {
+    int T1, T2, T3;
+    int t0hMin, t0hMax, t1hMin, t1hMax, tlMin;
+};
+static I2SLaneTiming gLaneTiming[FASTLED_I2S_MAX_CONTROLLERS];
+
+// -- Chipset limits of the profiles that carry a ClocklessTimingCheck,
+//    by timing. They are registered when such a controller is
+//    constructed, so before its init()
+#define I2S_MAX_CHIPSET_LIMITS 8
+static I2SLaneTiming gChipsetLimits[I2S_MAX_CHIPSET_LIMITS];
+static int gNumChipsetLimits = 0;
+static bool gTimingDirty = true;
+static int gDMABufferBytes = 0;
 
 // -- Temp buffers for pixels and bits being formatted for DMA
 static uint8_t gPixelRow[NUM_COLOR_CHANNELS][32];
@@ -192,6 +289,227 @@ static int CLOCK_DIVIDER_N;
 static int CLOCK_DIVIDER_A;
 static int CLOCK_DIVIDER_B;
 
+// -- Race-the-beam rendering
+//    The producer renders pixel rows [start, start + count) of every strip
+typedef void (*I2SPixelProducer)(void * arg, int start, int count);
+
+struct I2SStreamStats {
+    uint32_t firstPixelCycles; // show() of the last strip until the DMA starts
+    uint32_t frameCycles;      // show() of the last strip until the last row is sent
+    uint32_t underruns;        // rows sent before the producer reached them, last frame
+    uint32_t totalUnderruns;
+};
+
+typedef void (*I2SLatencyHook)(void * arg, const I2SStreamStats & stats);
+
+static I2SPixelProducer gProducer = NULL;
+static void * gProducerArg = NULL;
+static int gProducerChunk = 0;
+static I2SLatencyHook gLatencyHook = NULL;
+static void * gLatencyHookArg = NULL;
+static I2SStreamStats gStreamStats;
+
+// -- Shader output: pixels computed into a small ring instead of a buffer
+//    The shader computes pixels [start, start + count) of one strip into out
+#ifndef FASTLED_I2S_SHADER_ROWS
+#define FASTLED_I2S_SHADER_ROWS 64
+#endif
+#ifndef FASTLED_I2S_SHADER_CHUNK
+#define FASTLED_I2S_SHADER_CHUNK 16
+#endif
+
+typedef void (*I2SPixelShader)(void * arg, CRGB * out, int start, int count);
+
+struct I2SShader {
+    I2SPixelShader shader;
+    void * arg;
+    CRGB * ring;
+};
+
+static I2SShader gShaders[FASTLED_I2S_MAX_CONTROLLERS];
+
+// -- Loads the next pixel of lane i into gPixelRow at bit_index, in the
+//    lane's own color order; false when the lane has no more pixels
+typedef bool (*I2SLoadPixel)(int i, int bit_index);
+static I2SLoadPixel gLoadPixel[FASTLED_I2S_MAX_CONTROLLERS];
+
+// -- Rows rendered by the producer and rows handed to the DMA this frame
+static volatile int gRowsReady = 0;
+static volatile int gRowsFilled = 0;
+// -- Row the show task is waiting for the interrupt handler to reach, or -1
+static volatile int gRingWakeRow = -1;
+static bool gShading = false;
+static bool gStreaming = false;
+
+// -- Register a pixel producer; NULL goes back to rendering whole frames.
+//    Chunks are at least two rows, so both DMA buffers can be prefilled.
+static inline void i2sSetPixelProducer(I2SPixelProducer producer, void * arg, int chunk)
+{
+    gProducer = producer;
+    gProducerArg = arg;
+    gProducerChunk = (chunk < NUM_DMA_BUFFERS) ? NUM_DMA_BUFFERS : chunk;
+}
+
+// -- Called from the task that calls show(), after every frame
+static inline void i2sSetLatencyHook(I2SLatencyHook hook, void * arg)
+{
+    gLatencyHook = hook;
+    gLatencyHookArg = arg;
+}
+
+static inline const I2SStreamStats & i2sGetStreamStats()
+{
+    return gStreamStats;
+}
+
+// -- Attach a shader to a controller added with a NULL pixel array;
+//    NULL detaches it. Returns false if the controller is not driven by
+//    I2S or the ring cannot be allocated.
+static inline bool i2sSetPixelShader(CLEDController & controller, I2SPixelShader shader, void * arg)
+{
+    for (int i = 0; i < gNumControllers; i++) {
+        if (gControllers[i] != &controller) continue;
+        I2SShader & s = gShaders[i];
+        if (shader && s.ring == NULL) {
+            s.ring = (CRGB *) malloc(sizeof(CRGB) * FASTLED_I2S_SHADER_ROWS);
+            if (s.ring == NULL) return false;
+            FASTLED_ALLOC_NOTE("I2S shader ring", sizeof(CRGB) * FASTLED_I2S_SHADER_ROWS);
+        } else if (shader == NULL && s.ring) {
+            free(s.ring);
+            s.ring = NULL;
+        }
+        s.arg = arg;
+        s.shader = shader;
+        return true;
+    }
+    return false;
+}
+
+// -- Called by ClocklessTimingCheck: lanes with this timing are held to
+//    the limits of the chipset on a mixed grid
+static void i2sSetChipsetLimits(int T1, int T2, int T3, int t0hMin, int t0hMax, int t1hMin, int t1hMax, int tlMin)
+{
+    for (int i = 0; i < gNumChipsetLimits; i++) {
+        if (gChipsetLimits[i].T1 == T1 && gChipsetLimits[i].T2 == T2 && gChipsetLimits[i].T3 == T3) return;
+    }
+    if (gNumChipsetLimits == I2S_MAX_CHIPSET_LIMITS) return;
+    I2SLaneTiming l = { T1, T2, T3, t0hMin, t0hMax, t1hMin, t1hMax, tlMin };
+    gChipsetLimits[gNumChipsetLimits++] = l;
+}
+
+// -- Timing of a lane, with the registered limits of its chipset, or else
+//    FASTLED_I2S_MIXED_TOLERANCE_NS around its own times
+static I2SLaneTiming i2sLaneTiming(int T1, int T2, int T3)
+{
+    for (int i = 0; i < gNumChipsetLimits; i++) {
+        if (gChipsetLimits[i].T1 == T1 && gChipsetLimits[i].T2 == T2 && gChipsetLimits[i].T3 == T3) return gChipsetLimits[i];
+    }
+    int t0h = ESPCLKS_TO_NS(T1);
+    int t1h = ESPCLKS_TO_NS(T1 + T2);
+    I2SLaneTiming l = { T1, T2, T3,
+                        t0h - FASTLED_I2S_MIXED_TOLERANCE_NS, t0h + FASTLED_I2S_MIXED_TOLERANCE_NS,
+                        t1h - FASTLED_I2S_MIXED_TOLERANCE_NS, t1h + FASTLED_I2S_MIXED_TOLERANCE_NS,
+                        (int)ESPCLKS_TO_NS(T3) - FASTLED_I2S_MIXED_TOLERANCE_NS };
+    return l;
+}
+
+// -- Common pulse grid for lanes with different chipsets: an integer
+//    clock divider (pulse of divider x 12.5ns) with a bit period long
+//    enough for the slowest lane, and the high pulse counts of a "0" and
+//    a "1" for each lane. Every lane is held to its own window (see
+//    I2SLaneTiming): the margin of a lane is how far its worst time is
+//    inside the window. The grid with the largest worst margin wins,
+//    except that any margin of I2S_MIXED_ENOUGH_MARGIN ns is as good as a
+//    larger one, so that the longer pulse (fewer pulses to encode) wins.
+//    Returns false, with the least bad grid, if some lane is outside its
+//    window on every grid; margin and lane then say how far and which.
+//    divider is 0 if no divider fits at all.
+#define I2S_MIXED_ENOUGH_MARGIN 50
+
+struct I2SMixedGrid {
+    int divider;
+    int pulsesPerBit;
+    int margin;
+    int lane;
+    uint8_t zeroHigh[FASTLED_I2S_MAX_CONTROLLERS];
+    uint8_t oneHigh[FASTLED_I2S_MAX_CONTROLLERS];
+};
+
+// -- Margin of a lane's times in its window, in tenths of ns
+static long i2sLaneMargin(const I2SLaneTiming & l, long pulse, int pulses, int h0, int h1)
+{
+    long t0h = h0 * pulse;
+    long t1h = h1 * pulse;
+    // -- The low time of a "1" is the shorter one
+    long m[5] = { t0h - 10L * l.t0hMin, 10L * l.t0hMax - t0h, t1h - 10L * l.t1hMin, 10L * l.t1hMax - t1h,
+                  (pulses - h1) * pulse - 10L * l.tlMin };
+    long worst = m[0];
+    for (int k = 1; k < 5; k++) {
+        if (m[k] < worst) worst = m[k];
+    }
+    return worst;
+}
+
+static bool i2sMixedGrid(const I2SLaneTiming * lanes, int numLanes, I2SMixedGrid & grid)
+{
+    // -- Everything in tenths of ns
+    long period = 0;
+    long shortest = 0x7FFFFFFF;
+    for (int i = 0; i < numLanes; i++) {
+        long t = 10 * ESPCLKS_TO_NS(lanes[i].T1 + lanes[i].T2 + lanes[i].T3);
+        if (t > period) period = t;
+        t = 10 * ESPCLKS_TO_NS(lanes[i].T1);
+        if (t < shortest) shortest = t;
+    }
+
+    grid.divider = 0;
+    long best = 0;
+    for (int div = I2S_BASE_CLK / I2S_MAX_CLK; div < 256; div++) {
+        long pulse = 125 * div;
+        if (pulse > 2 * shortest) break;
+        int pulses = (period + pulse - 1) / pulse;
+        if (pulses > I2S_MAX_MIXED_PULSE_PER_BIT) continue;
+
+        I2SMixedGrid g;
+        g.divider = div;
+        g.pulsesPerBit = pulses;
+        long worst = 0x7FFFFFFF;
+        for (int i = 0; i < numLanes; i++) {
+            // -- The counts on either side of the middle of each window
+            const I2SLaneTiming & l = lanes[i];
+            int c0 = (5L * (l.t0hMin + l.t0hMax)) / pulse;
+            int c1 = (5L * (l.t1hMin + l.t1hMax)) / pulse;
+            long laneBest = -0x7FFFFFFF;
+            for (int h0 = (c0 < 1 ? 1 : c0); h0 <= c0 + 1; h0++) {
+                for (int h1 = (c1 <= h0 ? h0 + 1 : c1); h1 <= c1 + 1 || h1 == h0 + 1; h1++) {
+                    // -- A "1" needs at least one low pulse before the next bit
+                    if (h1 >= pulses) continue;
+                    long m = i2sLaneMargin(l, pulse, pulses, h0, h1);
+                    if (m > laneBest) {
+                        laneBest = m;
+                        g.zeroHigh[i] = h0;
+                        g.oneHigh[i] = h1;
+                    }
+                }
+            }
+            if (laneBest < worst) {
+                worst = laneBest;
+                g.lane = i;
+            }
+        }
+        if (worst == -0x7FFFFFFF) continue;
+
+        // -- Ties go to the longer pulse, which means fewer pulses to encode
+        long score = worst < 10L * I2S_MIXED_ENOUGH_MARGIN ? worst : 10L * I2S_MIXED_ENOUGH_MARGIN;
+        if (grid.divider == 0 || score >= best) {
+            best = score;
+            grid = g;
+            grid.margin = worst / 10;
+        }
+    }
+    return grid.divider != 0 && grid.margin >= 0;
+}
+
 template <int DATA_PIN, int T1, int T2, int T3, EOrder RGB_ORDER = RGB, int XTRA0 = 0, bool FLIP = false, int WAIT_TIME = 5>
 class ClocklessController : public CPixelLEDController<RGB_ORDER>
 {
@@ -216,10 +534,16 @@ class ClocklessController : public CPixelLEDController<RGB_ORDER>
         // -- Allocate space to save the pixel controller
         //    during parallel output
         mPixels = (PixelController<RGB_ORDER> *) malloc(sizeof(PixelController<RGB_ORDER>));
+        FASTLED_ALLOC_NOTE("I2S pixel controller", sizeof(PixelController<RGB_ORDER>));
         
         gControllers[gNumControllers] = this;
         int my_index = gNumControllers;
         gNumControllers++;
+
+        // -- The pulse grid is computed for all lanes at the next show
+        gLaneTiming[my_index] = i2sLaneTiming(T1, T2, T3);
+        gLoadPixel[my_index] = &loadPixel;
+        gTimingDirty = true;
         
         // -- Set up the pin We have to do two things: configure the
         //    actual GPIO pin, and route the output from the default
@@ -416,12 +740,75 @@ protected:
         memset(gPixelRow, 0, NUM_COLOR_CHANNELS * 32);
         memset(gPixelBits, 0, NUM_COLOR_CHANNELS * 32);
     }
-    
+
+    static void setLaneMasks(int lane, int zeroHigh, int oneHigh)
+    {
+        uint32_t bit = 1 << (lane + 8);
+        for (int p = 0; p < zeroHigh; p++) gHighMask[p] |= bit;
+        for (int p = zeroHigh; p < oneHigh; p++) gDataMask[p] |= bit;
+    }
+
+    /** Compute the pulse grid for the strips added so far
+     *
+     *  If they all use the same chipset, which then is this one, it is
+     *  Yves' pattern. Otherwise it is the common grid from i2sMixedGrid().
+     */
+    static void setupTiming()
+    {
+        bool mixed = false;
+        for (int i = 0; i < gNumControllers; i++) {
+            if (gLaneTiming[i].T1 != T1 || gLaneTiming[i].T2 != T2 || gLaneTiming[i].T3 != T3) mixed = true;
+        }
+
+        I2SMixedGrid grid;
+        if (mixed && ! i2sMixedGrid(gLaneTiming, gNumControllers, grid)) {
+            if (grid.divider == 0) {
+                ESP_LOGE("FastLED", "I2S: no common pulse grid for the chipsets, using the last one's timing");
+            } else {
+                const I2SLaneTiming & l = gLaneTiming[grid.lane];
+                ESP_LOGE("FastLED", "I2S: no common pulse grid keeps lane %d (%ld/%ld/%ld ns) within its chipset's limits, "
+                         "%d ns off at best; using the last one's timing", grid.lane,
+                         ESPCLKS_TO_NS(l.T1), ESPCLKS_TO_NS(l.T2), ESPCLKS_TO_NS(l.T3), -grid.margin);
+            }
+            mixed = false;
+        }
+
+        memset(gHighMask, 0, sizeof(gHighMask));
+        memset(gDataMask, 0, sizeof(gDataMask));
+        if ( ! mixed) {
+            initBitPatterns();
+            for (int i = 0; i < gNumControllers; i++) setLaneMasks(i, ones_for_zero, ones_for_one);
+        } else {
+            gPulsesPerBit = grid.pulsesPerBit;
+            CLOCK_DIVIDER_N = grid.divider;
+            CLOCK_DIVIDER_A = 1;
+            CLOCK_DIVIDER_B = 0;
+            ones_for_zero = gPulsesPerBit;
+            ones_for_one = 0;
+            for (int i = 0; i < gNumControllers; i++) {
+                setLaneMasks(i, grid.zeroHigh[i], grid.oneHigh[i]);
+                if (grid.zeroHigh[i] < ones_for_zero) ones_for_zero = grid.zeroHigh[i];
+                if (grid.oneHigh[i] > ones_for_one) ones_for_one = grid.oneHigh[i];
+            }
+        }
+
+        // -- Data clock is computed as Base/(div_num + (div_b/div_a))
+        //    Base is 80Mhz, so 80/(10 + 0/1) = 8Mhz
+        //    One cycle is 125ns
+        i2s->clkm_conf.clkm_div_a = CLOCK_DIVIDER_A;
+        i2s->clkm_conf.clkm_div_b = CLOCK_DIVIDER_B;
+        i2s->clkm_conf.clkm_div_num = CLOCK_DIVIDER_N;
+
+        allocateDMABuffers(32 * NUM_COLOR_CHANNELS * gPulsesPerBit);
+        gTimingDirty = false;
+    }
+
     static DMABuffer * allocateDMABuffer(int bytes)
     {
         DMABuffer * b = (DMABuffer *)heap_caps_malloc(sizeof(DMABuffer), MALLOC_CAP_DMA);
         
         b->buffer = (uint8_t *)heap_caps_malloc(bytes, MALLOC_CAP_DMA);
+        FASTLED_ALLOC_NOTE("I2S DMA buffer", sizeof(DMABuffer) + bytes);
         memset(b->buffer, 0, bytes);
         
         b->descriptor.length = bytes;
@@ -436,15 +823,36 @@ protected:
         
         return b;
     }
+
+    // -- (Re)allocate the two DMA buffers when the pulse grid grew, and
+    //    size their descriptors to the grid
+    static void allocateDMABuffers(int bytes)
+    {
+        if (bytes > gDMABufferBytes) {
+            for (int i = 0; i < NUM_DMA_BUFFERS; i++) {
+                if (dmaBuffers[i]) {
+                    heap_caps_free(dmaBuffers[i]->buffer);
+                    heap_caps_free(dmaBuffers[i]);
+                }
+                dmaBuffers[i] = allocateDMABuffer(bytes);
+            }
+            gDMABufferBytes = bytes;
+        }
+        for (int i = 0; i < NUM_DMA_BUFFERS; i++) {
+            dmaBuffers[i]->descriptor.length = bytes;
+            dmaBuffers[i]->descriptor.size = bytes;
+        }
+
+        // -- Arrange them as a circularly linked list
+        dmaBuffers[0]->descriptor.qe.stqe_next = &(dmaBuffers[1]->descriptor);
+        dmaBuffers[1]->descriptor.qe.stqe_next = &(dmaBuffers[0]->descriptor);
+    }
     
     static void i2sInit()
     {
         // -- Only need to do this once
         if (gInitialized) return;
         
-        // -- Construct the bit patterns for ones and zeros
-        initBitPatterns();
-        
         // -- Choose whether to use I2S device 0 or device 1
         //    Set up the various device-specific parameters
         int interruptSource;
@@ -486,12 +894,7 @@ protected:
         i2s->clkm_conf.val = 0;
         i2s->clkm_conf.clka_en = 0;
         
-        // -- Data clock is computed as Base/(div_num + (div_b/div_a))
-        //    Base is 80Mhz, so 80/(10 + 0/1) = 8Mhz
-        //    One cycle is 125ns
-        i2s->clkm_conf.clkm_div_a = CLOCK_DIVIDER_A;
-        i2s->clkm_conf.clkm_div_b = CLOCK_DIVIDER_B;
-        i2s->clkm_conf.clkm_div_num = CLOCK_DIVIDER_N;
+        // -- The data clock is set up with the bit patterns, at the first show
         
         i2s->fifo_conf.val = 0;
         i2s->fifo_conf.tx_fifo_mod_force_en = 1;
@@ -508,14 +911,6 @@ protected:
         
         i2s->timing.val = 0;
         
-        // -- Allocate two DMA buffers
-        dmaBuffers[0] = allocateDMABuffer(32 * NUM_COLOR_CHANNELS * gPulsesPerBit);
-        dmaBuffers[1] = allocateDMABuffer(32 * NUM_COLOR_CHANNELS * gPulsesPerBit);
-        
-        // -- Arrange them as a circularly linked list
-        dmaBuffers[0]->descriptor.qe.stqe_next = &(dmaBuffers[1]->descriptor);
-        dmaBuffers[1]->descriptor.qe.stqe_next = &(dmaBuffers[0]->descriptor);
-       
         // -- Allocate i2s interrupt
         SET_PERI_REG_BITS(I2S_INT_ENA_REG(I2S_DEVICE), I2S_OUT_EOF_INT_ENA_V, 1, I2S_OUT_EOF_INT_ENA_S);
         ESP_ERROR_CHECK(
@@ -530,6 +925,9 @@ protected:
             gTX_sem = xSemaphoreCreateBinary();
             xSemaphoreGive(gTX_sem);
         }
+        if (gRing_sem == NULL) {
+            gRing_sem = xSemaphoreCreateBinary();
+        }
         
         // println("Init I2S");
         gInitialized = true;
@@ -546,7 +944,7 @@ protected:
         {
             int offset=gPulsesPerBit*i;
             for(int j=0;j<ones_for_zero;j++)
-                buf[offset+j]=0xffffffff;
+                buf[offset+j]=gHighMask[j];
             
             for(int j=ones_for_one;j<gPulsesPerBit;j++)
                 buf[offset+j]=0;
@@ -577,10 +975,30 @@ protected:
         // -- The last call to showPixels is the one responsible for doing
         //    all of the actual work
         if (gNumStarted == gNumControllers) {
+            uint32_t showStart = __clock_cycles();
+            if (gTimingDirty) setupTiming();
             empty((uint32_t*)dmaBuffers[0]->buffer);
             empty((uint32_t*)dmaBuffers[1]->buffer);
             gCurBuffer = 0;
             gDoneFilling = false;
+            gRowsFilled = 0;
+            gStreamStats.underruns = 0;
+            
+            // -- With a producer or shaders, render only the first chunk before sending
+            gShading = false;
+            for (int i = 0; i < gNumControllers; i++) {
+                if (isShaded(i)) gShading = true;
+            }
+            gStreaming = gShading || gProducer;
+            int numRows = 0;
+            if (gStreaming) {
+                for (int i = 0; i < gNumControllers; i++) {
+                    int size = static_cast<ClocklessController*>(gControllers[i])->mPixels->size();
+                    if (size > numRows) numRows = size;
+                }
+                gRowsReady = 0;
+                produceRows(numRows);
+            }
             
             // -- Prefill both buffers
             fillBuffer();
@@ -590,6 +1008,12 @@ protected:
             mWait.wait();
 
             i2sStart();
+            gStreamStats.firstPixelCycles = __clock_cycles() - showStart;
+            
+            // -- Render the rest of the frame just ahead of the interrupt handler
+            if (gStreaming) {
+                while (gRowsReady < numRows) produceRows(numRows);
+            }
             
             // -- Wait here while the rest of the data is sent. The interrupt handler
             //    will keep refilling the DMA buffers until it is all sent; then it
@@ -601,11 +1025,68 @@ protected:
             
             mWait.mark();
 
+            gStreamStats.frameCycles = __clock_cycles() - showStart;
+            gStreamStats.totalUnderruns += gStreamStats.underruns;
+            if (gLatencyHook) gLatencyHook(gLatencyHookArg, gStreamStats);
+
             // -- Reset the counters
             gNumStarted = 0;
         }
     }
     
+    // -- Render the next chunk of rows with the producer
+    //    and the shaders
+    static void produceRows(int numRows)
+    {
+        int start = gRowsReady;
+        int count = numRows - start;
+        int chunk = gProducer ? gProducerChunk : FASTLED_I2S_SHADER_CHUNK;
+        if (gShading && chunk > FASTLED_I2S_SHADER_ROWS / 2) chunk = FASTLED_I2S_SHADER_ROWS / 2;
+        if (count > chunk) count = chunk;
+        if (gProducer) gProducer(gProducerArg, start, count);
+        
+        for (int i = 0; i < gNumControllers; i++) {
+            if ( ! isShaded(i)) continue;
+            
+            // -- Don't overwrite ring rows the interrupt handler has not sent yet
+            waitForRing(start + count - FASTLED_I2S_SHADER_ROWS);
+            
+            I2SShader & s = gShaders[i];
+            int row = start;
+            int end = static_cast<ClocklessController*>(gControllers[i])->mPixels->size();
+            if (end > start + count) end = start + count;
+            while (row < end) {
+                int slot = row % FASTLED_I2S_SHADER_ROWS;
+                int n = FASTLED_I2S_SHADER_ROWS - slot;
+                if (n > end - row) n = end - row;
+                s.shader(s.arg, &s.ring[slot], row, n);
+                row += n;
+            }
+        }
+        gRowsReady = start + count;
+    }
+    
+    // -- Block until the interrupt handler has sent row, so the ring slot
+    //    can be reused. The row is published before the check, so a row
+    //    sent in between still gives the semaphore; a give left over from
+    //    an earlier wait only costs one more time around the loop.
+    static void waitForRing(int row)
+    {
+        while (gRowsFilled < row) {
+            gRingWakeRow = row;
+            if (gRowsFilled < row) xSemaphoreTake(gRing_sem, portMAX_DELAY);
+            gRingWakeRow = -1;
+        }
+    }
+    
+    // -- Does this controller compute its pixels with a shader this frame?
+    //    showColor() frames don't advance through the data, so they are
+    //    sent as usual.
+    static IRAM_ATTR bool isShaded(int i)
+    {
+        return gShaders[i].shader && static_cast<ClocklessController*>(gControllers[i])->mPixels->mAdvance;
+    }
+    
     // -- Custom interrupt handler
     static IRAM_ATTR void interruptHandler(void *arg)
     {
@@ -617,7 +1098,9 @@ protected:
             } else {
                 portBASE_TYPE HPTaskAwoken = 0;
                 xSemaphoreGiveFromISR(gTX_sem, &HPTaskAwoken);
-                if(HPTaskAwoken == pdTRUE) portYIELD_FROM_ISR();
+                if (HPTaskAwoken == pdTRUE) {
+                    portYIELD_FROM_ISR();
+                }
             }
         }
     }
@@ -642,14 +1125,7 @@ protected:
             //    This causes the bits to come out in the right position after we
             //    transpose them.
             int bit_index = 23-i;
-            ClocklessController * pController = static_cast<ClocklessController*>(gControllers[i]);
-            if (pController->mPixels->has(1)) {
-                gPixelRow[0][bit_index] = pController->mPixels->loadAndScale0();
-                gPixelRow[1][bit_index] = pController->mPixels->loadAndScale1();
-                gPixelRow[2][bit_index] = pController->mPixels->loadAndScale2();
-                pController->mPixels->advanceData();
-                pController->mPixels->stepDithering();
-                
+            if (gLoadPixel[i](i, bit_index)) {
                 // -- Record that this controller still has data to send
                 has_data_mask |= (1 << (i+8));
             }
@@ -661,6 +1137,18 @@ protected:
             return;
         }
         
+        // -- The producer has not reached this row yet: it goes out stale
+        if (gStreaming && gRowsFilled >= gRowsReady) gStreamStats.underruns++;
+        gRowsFilled++;
+        if (gRingWakeRow >= 0 && gRowsFilled >= gRingWakeRow) {
+            gRingWakeRow = -1;
+            portBASE_TYPE HPTaskAwoken = 0;
+            xSemaphoreGiveFromISR(gRing_sem, &HPTaskAwoken);
+            if (HPTaskAwoken == pdTRUE) {
+                portYIELD_FROM_ISR();
+            }
+        }
+        
         // -- Transpose and encode the pixel data for the DMA buffer
         // int buf_index = 0;
         for (int channel = 0; channel < NUM_COLOR_CHANNELS; channel++) {
@@ -680,13 +1168,31 @@ protected:
                */
 
                 // -- Only fill in the pulses that are different between the "0" and "1" encodings
+                //    on some lane; the other lanes are high or low there whatever the bit
                 for(int pulse_num = ones_for_zero; pulse_num < ones_for_one; pulse_num++) {
-                    buf[bitnum*gPulsesPerBit+channel*8*gPulsesPerBit+pulse_num] = has_data_mask & bit;
+                    buf[bitnum*gPulsesPerBit+channel*8*gPulsesPerBit+pulse_num] = (has_data_mask & bit & gDataMask[pulse_num]) | gHighMask[pulse_num];
                 }
             }
         }
     }
     
+    // -- Lane i is a controller of this class: fillBuffer() is the one of
+    //    whichever controller runs it, and the color order is this one's
+    static IRAM_ATTR bool loadPixel(int i, int bit_index)
+    {
+        ClocklessController * pController = static_cast<ClocklessController*>(gControllers[i]);
+        if ( ! pController->mPixels->has(1)) return false;
+        if (isShaded(i)) {
+            pController->mPixels->mData = (const uint8_t *) &gShaders[i].ring[gRowsFilled % FASTLED_I2S_SHADER_ROWS];
+        }
+        gPixelRow[0][bit_index] = pController->mPixels->loadAndScale0();
+        gPixelRow[1][bit_index] = pController->mPixels->loadAndScale1();
+        gPixelRow[2][bit_index] = pController->mPixels->loadAndScale2();
+        pController->mPixels->advanceData();
+        pController->mPixels->stepDithering();
+        return true;
+    }
+    
     static void transpose32(uint8_t * pixels, uint8_t * bits)
     {
         transpose8rS32(& pixels[0],  1, 4, & bits[0]);
@@ -730,7 +1236,7 @@ protected:
         i2sReset();
         //println(dmaBuffers[0]->sampleCount());
         i2s->lc_conf.val=I2S_OUT_DATA_BURST_EN | I2S_OUTDSCR_BURST_EN | I2S_OUT_DATA_BURST_EN;
-        i2s->out_link.addr = (uint32_t) & (dmaBuffers[0]->descriptor);
+        i2s->out_link.addr = (uint32_t)(uintptr_t) & (dmaBuffers[0]->descriptor);
         i2s->out_link.start = 1;
         ////vTaskDelay(5);
         i2s->int_clr.val = i2s->int_raw.val;
@@ -204,7 +204,8 @@ static inline void fastled_set_mem_owner(rmt_channel_t channel, uint8_t owner)
 
 
 ESP32RMTController::ESP32RMTController(int DATA_PIN, int T1, int T2, int T3)
-    : mPixelData(0), 
+    : mPixelSource(0),
+      mPixelArg(0),
       mSize(0), 
       mCur(0), 
       mWhichHalf(0),
@@ -241,16 +242,14 @@ ESP32RMTController::ESP32RMTController(int DATA_PIN, int T1, int T2, int T3)
     mPin = gpio_num_t(DATA_PIN);
 }
 
-// -- Get or create the buffer for the pixel data
-//    We can't allocate it ahead of time because we don't have
+// -- Set the source of the pixel data
+//    We can't set it ahead of time because we don't have
 //    the PixelController object until show is called.
-uint32_t * ESP32RMTController::getPixelBuffer(int size_in_bytes)
+void ESP32RMTController::setPixelSource(PixelSource source, void * arg, int size_in_bytes)
 {
-    if (mPixelData == 0) {
-        mSize = ((size_in_bytes-1) / sizeof(uint32_t)) + 1;
-        mPixelData = (uint32_t *) calloc( mSize, sizeof(uint32_t));
-    }
-    return mPixelData;
+    mPixelSource = source;
+    mPixelArg = arg;
+    mSize = ((size_in_bytes-1) / sizeof(uint32_t)) + 1;
 }
 
 // -- Initialize RMT subsystem
@@ -434,7 +433,7 @@ void ESP32RMTController::startOnChannel(int channel)
 
     if (FASTLED_RMT_BUILTIN_DRIVER) {
         // -- Use the built-in RMT driver to send all the data in one shot
-        rmt_register_tx_end_callback(doneOnRMTChannel, (void *) channel);
+        rmt_register_tx_end_callback(doneOnRMTChannel, (void *)(intptr_t) channel);
         rmt_write_items(mRMT_channel, mBuffer, mBufferSize, false);
     } else {
         // -- Use our custom driver to send the data incrementally
@@ -481,7 +480,7 @@ void ESP32RMTController::tx_start()
 // so we use the arg instead
 void ESP32RMTController::doneOnRMTChannel(rmt_channel_t channel, void * arg) 
 {
-    doneOnChannel((int) arg, (void *) 0);
+    doneOnChannel((int)(intptr_t) arg, (void *) 0);
 }
 
 // -- A controller is done 
@@ -639,7 +638,7 @@ void IRAM_ATTR ESP32RMTController::fillNext()
 
         for (int i=0; i < PULSES_PER_FILL / 32; i++) {
             if (mCur < mSize) {
-                register uint32_t thispixel = mPixelData[mCur];
+                register uint32_t thispixel = mPixelSource(mPixelArg);
                 for (int j = 0; j < 32; j++) {
 
                     *pItem++ = (thispixel & 0x80000000L) ? one_val : zero_val;
@@ -699,6 +698,7 @@ void ESP32RMTController::initPulseBuffer(int size_in_bytes)
     mBufferSize = size_in_bytes * 8;
 
     mBuffer = (rmt_item32_t *) calloc( mBufferSize, sizeof(rmt_item32_t) );
+    FASTLED_ALLOC_NOTE("RMT pulse buffer", mBufferSize * sizeof(rmt_item32_t));
 
 }
 
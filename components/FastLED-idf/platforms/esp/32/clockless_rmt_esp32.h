@@ -130,11 +130,18 @@ extern void spi_flash_op_unlock(void);
 }
 #endif
 
+#ifdef ESP_PLATFORM
 __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
   uint32_t cyc;
   __asm__ __volatile__ ("rsr %0,ccount":"=a" (cyc));
   return cyc;
 }
+#else
+// -- Host build (see host/): the cycles of the CPU clock
+inline static uint32_t __clock_cycles() {
+  return (uint32_t)(esp_timer_get_time() * F_CPU_MHZ);
+}
+#endif
 
 #define FASTLED_HAS_CLOCKLESS 1
 #define NUM_COLOR_CHANNELS 3
@@ -145,10 +152,12 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
                                 /* there is no point in higher dividers, as this parameter only needs to make
                                    sure the scaling factors of the RMT intervals fit in 15 bits. */
 
+#ifndef MEM_BLOCK_NUM
 #define MEM_BLOCK_NUM       2 /* the number of memory blocks. There are 8 for the entire RMT system, and nominally
                                 1 per channel. Using a larger number reduces the number of hardware channels that can be used
                                 at one time, but increases the resistance to RTOS interrupt jitter. 1 seems to be good enough,
                                 but jitter created by wifi might still cause glitches and 2 or more may be reuired. */
+#endif
 #define PULSES_PER_CHANNEL  (64 * MEM_BLOCK_NUM) /* A channel has a 64 "pulse" buffer of 32 bits (aka Items in RMT interface) */
 #define PULSES_PER_FILL     (PULSES_PER_CHANNEL / 2)     /* Half of the channel buffer */
                             // PPF must be a multipel of 32 or fillNext must be re-coded
@@ -196,6 +205,13 @@ __attribute__ ((always_inline)) inline static uint32_t __clock_cycles() {
 
 class ESP32RMTController
 {
+public:
+
+    // -- Source of the pixel data
+    //    Returns the next four bytes of pixel data, packed MSB first. It is
+    //    called from the interrupt handler, so it must be in IRAM.
+    typedef uint32_t (*PixelSource)(void * arg);
+
 private:
 
     // -- RMT has 8 channels, numbered 0 to 7
@@ -218,7 +234,10 @@ private:
     uint32_t       mLastFill;
 
     // -- Pixel data
-    uint32_t *     mPixelData;
+    //    There is no copy of it: the source function reads the next 32 bits
+    //    straight out of the caller's leds, scaled and in color order
+    PixelSource    mPixelSource;
+    void *         mPixelArg;
     int            mSize;
     int            mCur;
 
@@ -243,8 +262,8 @@ public:
     // -- Get max cycles per fill
     uint32_t IRAM_ATTR getMaxCyclesPerFill() const { return mMaxCyclesPerFill; }
 
-    // -- Get or create the pixel data buffer
-    uint32_t * getPixelBuffer(int size_in_bytes);
+    // -- Set the source of the pixel data for the next show
+    void setPixelSource(PixelSource source, void * arg, int size_in_bytes);
 
     // -- Initialize RMT subsystem
     //    This only needs to be done once
@@ -328,10 +347,17 @@ private:
     // -- This instantiation forces a check on the pin choice
     FastPin<DATA_PIN> mFastPin;
 
+    // -- Copy of the pixel controller, read from the interrupt handler,
+    //    and which of its three colors comes next
+    PixelController<RGB_ORDER> * mPixels;
+    int mWhich;
+
 public:
 
     ClocklessController()
-        : mRMTController(DATA_PIN, T1, T2, T3)
+        : mRMTController(DATA_PIN, T1, T2, T3),
+          mPixels(0),
+          mWhich(0)
         {}
 
     void init()
@@ -344,52 +370,57 @@ public:
 protected:
 
     // -- Load pixel data
-    //    This method loads all of the pixel data into a separate buffer for use by
-    //    by the RMT driver. Copying does two important jobs: it fixes the color
-    //    order for the pixels, and it performs the scaling/adjusting ahead of time.
-    //    It also packs the bytes into 32 bit chunks with the right bit order.
+    //    The RMT driver reads the pixels straight out of the leds as it sends
+    //    them, rather than from a copy. That saves a pass over the pixels and
+    //    a buffer per strip; the pixel controller does the color order and the
+    //    scaling/adjusting on the way out. We need to keep a copy of it because
+    //    pixels is a local variable in the calling function, and the data is
+    //    only sent after the last controller's call to showPixels.
     void loadPixelData(PixelController<RGB_ORDER> & pixels)
     {
-        // -- Make sure the buffer is allocated
-        int size_in_bytes = pixels.size() * 3;
-        uint32_t * pData = mRMTController.getPixelBuffer(size_in_bytes);
-
-        // -- Read out the pixel data using the pixel controller methods that
-        //    perform the scaling and adjustments 
-        int count = 0;
-        int which = 0;
-        while (pixels.has(1)) {
-            // -- Get the next four bytes of data
-            uint8_t four[4] = {0,0,0,0};
-            for (int i = 0; i < 4; i++) {
-                switch (which) {
-                case 0: 
-                    four[i] = pixels.loadAndScale0();
-                    break;
-                case 1:
-                    four[i] = pixels.loadAndScale1();
-                    break;
-                case 2:
-                    four[i] = pixels.loadAndScale2();
-                    pixels.advanceData();
-                    pixels.stepDithering();
-                    break;
-                }
-                // -- Move to the next color
-                which++;
-                if (which > 2) which = 0;
-
-                // -- Stop if there's no more data
-                if ( ! pixels.has(1)) break;
+        if (mPixels == 0) {
+            mPixels = (PixelController<RGB_ORDER> *) malloc(sizeof(PixelController<RGB_ORDER>));
+            FASTLED_ALLOC_NOTE("RMT pixel controller", sizeof(PixelController<RGB_ORDER>));
+        }
+        (*mPixels) = pixels;
+        mWhich = 0;
+        mRMTController.setPixelSource(nextPixelData, this, pixels.size() * 3);
+    }
+
+    // -- Get the next four bytes of pixel data
+    //    Packs them into a 32-bit value with the right bit order. When the
+    //    pixels run out part way, the rest of the value is zero.
+    static uint32_t IRAM_ATTR nextPixelData(void * arg)
+    {
+        ClocklessController * pController = (ClocklessController *) arg;
+        PixelController<RGB_ORDER> & pixels = *(pController->mPixels);
+        int which = pController->mWhich;
+
+        uint32_t four = 0;
+        if ( ! pixels.has(1)) return four;
+        for (int i = 0; i < 4; i++) {
+            switch (which) {
+            case 0:
+                four |= (uint32_t) pixels.loadAndScale0() << (24 - 8*i);
+                break;
+            case 1:
+                four |= (uint32_t) pixels.loadAndScale1() << (24 - 8*i);
+                break;
+            case 2:
+                four |= (uint32_t) pixels.loadAndScale2() << (24 - 8*i);
+                pixels.advanceData();
+                pixels.stepDithering();
+                break;
             }
+            // -- Move to the next color
+            which++;
+            if (which > 2) which = 0;
 
-            // -- Pack the four bytes into a 32-bit value with the right bit order
-            uint8_t a = four[0];
-            uint8_t b = four[1];
-            uint8_t c = four[2];
-            uint8_t d = four[3];
-            pData[count++] = a << 24 | b << 16 | c << 8 | d;
+            // -- Stop if there's no more data
+            if ( ! pixels.has(1)) break;
         }
+        pController->mWhich = which;
+        return four;
     }
 
     // -- Show pixels
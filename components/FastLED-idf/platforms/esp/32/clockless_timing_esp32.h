@@ -0,0 +1,91 @@
+#pragma once
+
+FASTLED_NAMESPACE_BEGIN
+
+/*
+ * Compile-time model of the waveform the clockless driver actually puts out for the
+ * timings T1, T2, T3 (in ESP32 cycles), after the driver has quantized them:
+ *
+ *   - RMT: every duration is truncated to whole RMT ticks (NS_PER_CYCLE)
+ *   - I2S: the bit is cut into gPulsesPerBit pulses of one length, found by the
+ *     same search initBitPatterns() does at run time. This holds while all lanes
+ *     use one chipset; mixed lanes share a grid from i2sMixedGrid() instead,
+ *     which is only known at run time, so the check hands its limits to the
+ *     driver, which refuses a grid that leaves them
+ *
+ * ClocklessTimingCheck uses it to reject an overclocked profile (see chipsets.h)
+ * whose real high and low times fall outside the limits of its chipset family. The
+ * margins are left in the check as enum values; host/clocktiming prints them for
+ * every profile under both drivers.
+ */
+
+#define FASTLED_HAS_CLOCKLESS_TIMING_CHECK
+
+#ifdef FASTLED_ESP32_I2S
+
+// -- Mirror of pgcd() in the I2S driver
+constexpr int i2s_timing_pgcd(int i, int precision, int a, int b, int c) {
+    return (i <= 0) ? 1 :
+           (a % i <= precision && b % i <= precision && c % i <= precision) ? i :
+           i2s_timing_pgcd(i - 1, precision, a, b, c);
+}
+
+// -- Mirror of the precision search in initBitPatterns()
+constexpr int i2s_timing_pulse(int smallest, int precision, int a, int b, int c) {
+    return (i2s_timing_pgcd(smallest, precision, a, b, c) == 1 ||
+            (a / i2s_timing_pgcd(smallest, precision, a, b, c) +
+             b / i2s_timing_pgcd(smallest, precision, a, b, c) +
+             c / i2s_timing_pgcd(smallest, precision, a, b, c)) > I2S_MAX_PULSE_PER_BIT)
+        ? i2s_timing_pulse(smallest, precision + 1, a, b, c)
+        : i2s_timing_pgcd(smallest, precision, a, b, c);
+}
+
+template <int T1, int T2, int T3>
+struct ClocklessTiming {
+    enum {
+        SMALLEST = (T1 < T2 ? (T1 < T3 ? T1 : T3) : (T2 < T3 ? T2 : T3)),
+        PULSE = i2s_timing_pulse(SMALLEST, 0, T1, T2, T3),
+        PULSES = T1 / PULSE + T2 / PULSE + T3 / PULSE,
+        PERIOD = ESPCLKS_TO_NS(T1 + T2 + T3),
+        T0H = (T1 / PULSE) * PERIOD / PULSES,
+        T1H = (T1 / PULSE + T2 / PULSE) * PERIOD / PULSES,
+        T0L = PERIOD - T0H,
+        T1L = PERIOD - T1H
+    };
+};
+
+#else
+
+template <int T1, int T2, int T3>
+struct ClocklessTiming {
+    enum {
+        T0H = ESP_TO_RMT_CYCLES(T1) * NS_PER_CYCLE,
+        T1H = ESP_TO_RMT_CYCLES(T1 + T2) * NS_PER_CYCLE,
+        T0L = ESP_TO_RMT_CYCLES(T2 + T3) * NS_PER_CYCLE,
+        T1L = ESP_TO_RMT_CYCLES(T3) * NS_PER_CYCLE,
+        PERIOD = T0H + T0L
+    };
+};
+
+#endif
+
+// -- Fails to compile, when instantiated, if the quantized timing leaves the LIMITS
+template <int T1, int T2, int T3, class LIMITS>
+struct ClocklessTimingCheck {
+    typedef ClocklessTiming<T1, T2, T3> T;
+    enum {
+        T0H_MARGIN = (T::T0H - LIMITS::T0H_MIN < LIMITS::T0H_MAX - T::T0H) ? T::T0H - LIMITS::T0H_MIN : LIMITS::T0H_MAX - T::T0H,
+        T1H_MARGIN = (T::T1H - LIMITS::T1H_MIN < LIMITS::T1H_MAX - T::T1H) ? T::T1H - LIMITS::T1H_MIN : LIMITS::T1H_MAX - T::T1H,
+        TL_MARGIN = ((T::T0L < T::T1L) ? T::T0L : T::T1L) - LIMITS::TL_MIN
+    };
+    static_assert(T0H_MARGIN >= 0, "clockless profile: quantized T0H is outside the chipset limits");
+    static_assert(T1H_MARGIN >= 0, "clockless profile: quantized T1H is outside the chipset limits");
+    static_assert(TL_MARGIN >= 0, "clockless profile: quantized low time is below the chipset minimum");
+#ifdef FASTLED_ESP32_I2S
+    ClocklessTimingCheck() {
+        i2sSetChipsetLimits(T1, T2, T3, LIMITS::T0H_MIN, LIMITS::T0H_MAX, LIMITS::T1H_MIN, LIMITS::T1H_MAX, LIMITS::TL_MIN);
+    }
+#endif
+};
+
+FASTLED_NAMESPACE_END
@@ -11,5 +11,6 @@
 #else
 #include "clockless_rmt_esp32.h"
 #endif
+#include "clockless_timing_esp32.h"
 
 // #include "clockless_block_esp32.h"
@@ -103,7 +103,8 @@ uint8_t calculate_max_brightness_for_power_mW( uint8_t target_brightness, uint32
 
     CLEDController *pCur = CLEDController::head();
 	while(pCur) {
-        total_mW += calculate_unscaled_power_mW( pCur->leds(), pCur->size());
+        // controllers without pixel data (shader output) can't be measured
+        if (pCur->leds()) total_mW += calculate_unscaled_power_mW( pCur->leds(), pCur->size());
 		pCur = pCur->next();
 	}
 
@@ -0,0 +1,166 @@
+#define FASTLED_INTERNAL
+#include "FastLED.h"
+
+#include "esp_log.h"
+#include "lwip/sockets.h"
+
+FASTLED_NAMESPACE_BEGIN
+
+static const char *TAG = "FastLED";
+
+// -- Downsampled copy of the frame shown last, and of the frame last sent
+static CRGB * gSnap = NULL;
+static CRGB * gPrev = NULL;
+static uint8_t * gPacket = NULL;
+
+static PreviewLayout gSnapLayout;
+static PreviewLayout gPrevLayout;
+static uint8_t gSnapScale;
+
+// -- gBusy is set by show() when it hands a frame over, cleared by the sender
+static volatile bool gBusy = false;
+static volatile bool gRunning = false;
+static TaskHandle_t gTask = NULL;
+static int gSock = -1;
+static struct sockaddr_in gDest;
+
+static uint32_t gMinMicros = 0;
+static uint32_t gLastFrame = 0;
+static uint16_t gSeq = 0;
+static uint8_t gSinceKey = 0;
+static bool gForceKey = true;
+static uint32_t gSent = 0;
+static uint32_t gDropped = 0;
+
+static void sendFrame() {
+    bool key = gForceKey || gSinceKey >= FASTLED_PREVIEW_KEY_INTERVAL || !preview_same_layout(gSnapLayout, gPrevLayout);
+    const uint8_t * snap = (const uint8_t *)gSnap;
+    int len = preview_encode(gPacket, PREVIEW_PACKET_SIZE, gSnapLayout, gSnapScale, gSeq + 1, snap, (const uint8_t *)gPrev, key);
+    if (len < 0) {
+        // -- A key frame always fits
+        key = true;
+        len = preview_encode(gPacket, PREVIEW_PACKET_SIZE, gSnapLayout, gSnapScale, gSeq + 1, snap, NULL, true);
+    }
+
+    if (sendto(gSock, gPacket, len, MSG_DONTWAIT, (struct sockaddr *)&gDest, sizeof(gDest)) != len) {
+        // -- The client never got this frame, so the next delta would not apply
+        gDropped++;
+        gForceKey = true;
+        return;
+    }
+
+    gSent++;
+    gSeq++;
+    gSinceKey = key ? 0 : gSinceKey + 1;
+    gForceKey = false;
+    CRGB * t = gPrev; gPrev = gSnap; gSnap = t;
+    gPrevLayout = gSnapLayout;
+}
+
+static void previewTask(void * arg) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (gRunning) sendFrame();
+        gBusy = false;
+    }
+}
+
+bool preview_begin(const char * host, uint16_t port, uint8_t fps) {
+    if (gRunning) preview_end();
+
+    if (gSnap == NULL) {
+        size_t frameBytes = FASTLED_PREVIEW_MAX_PIXELS * sizeof(CRGB);
+        gSnap = (CRGB *)malloc(frameBytes);
+        gPrev = (CRGB *)malloc(frameBytes);
+        gPacket = (uint8_t *)malloc(PREVIEW_PACKET_SIZE);
+        FASTLED_ALLOC_NOTE("preview buffers", 2 * frameBytes + PREVIEW_PACKET_SIZE);
+        if (gSnap == NULL || gPrev == NULL || gPacket == NULL) {
+            ESP_LOGE(TAG, "preview: out of memory");
+            free(gSnap); free(gPrev); free(gPacket);
+            gSnap = gPrev = NULL;
+            gPacket = NULL;
+            return false;
+        }
+    }
+
+    gSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (gSock < 0) {
+        ESP_LOGE(TAG, "preview: no socket");
+        return false;
+    }
+    memset(&gDest, 0, sizeof(gDest));
+    gDest.sin_family = AF_INET;
+    gDest.sin_port = htons(port);
+    gDest.sin_addr.s_addr = inet_addr(host);
+
+    if (gTask == NULL) {
+        // -- Lowest priority above idle: the preview only gets time nobody else wants
+        xTaskCreatePinnedToCore(previewTask, "fastled_preview", 3072, NULL, tskIDLE_PRIORITY + 1, &gTask, tskNO_AFFINITY);
+    }
+
+    gMinMicros = 1000000 / (fps ? fps : 1);
+    gForceKey = true;
+    gRunning = true;
+    ESP_LOGI(TAG, "preview: sending to %s:%u at up to %u fps", host, port, fps);
+    return true;
+}
+
+void preview_end() {
+    if (!gRunning) return;
+    gRunning = false;
+    while (gBusy) vTaskDelay(1);
+    close(gSock);
+    gSock = -1;
+}
+
+void preview_frame(uint8_t scale) {
+    if (!gRunning) return;
+    uint32_t now = micros();
+    if ((now - gLastFrame) < gMinMicros) return;
+    gLastFrame = now;
+    if (gBusy) {
+        // -- The sender has not finished the last frame, never wait for it
+        gDropped++;
+        return;
+    }
+
+    // -- Every controller is sampled with the same step, small enough to fit them all
+    int count = 0;
+    int total = 0;
+    for (CLEDController *pCur = CLEDController::head(); pCur && count < FASTLED_PREVIEW_MAX_CONTROLLERS; pCur = pCur->next()) {
+        if (pCur->leds()) total += pCur->size();
+        count++;
+    }
+    int step = (total + FASTLED_PREVIEW_MAX_PIXELS - count - 1) / (FASTLED_PREVIEW_MAX_PIXELS - count);
+    if (step < 1) step = 1;
+    if (step > 255) step = 255;
+
+    PreviewLayout & l = gSnapLayout;
+    CRGB * dst = gSnap;
+    int left = FASTLED_PREVIEW_MAX_PIXELS;
+    l.count = count;
+    int c = 0;
+    for (CLEDController *pCur = CLEDController::head(); pCur && c < count; pCur = pCur->next(), c++) {
+        const CRGB * src = pCur->leds();
+        int len = src ? (pCur->size() + step - 1) / step : 0;
+        if (len > left) len = left;
+        for (int i = 0; i < len; i++) {
+            *dst++ = src[i * step];
+        }
+        left -= len;
+        l.len[c] = len;
+        l.step[c] = step;
+    }
+    l.total = FASTLED_PREVIEW_MAX_PIXELS - left;
+    gSnapScale = scale;
+
+    gBusy = true;
+    xTaskNotifyGive(gTask);
+}
+
+void preview_stats(uint32_t * sent, uint32_t * dropped) {
+    if (sent) *sent = gSent;
+    if (dropped) *dropped = gDropped;
+}
+
+FASTLED_NAMESPACE_END
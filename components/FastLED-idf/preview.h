@@ -0,0 +1,51 @@
+#ifndef __INC_PREVIEW_H
+#define __INC_PREVIEW_H
+
+#include "FastLED.h"
+#include "preview_codec.h"
+
+///@file preview.h
+/// low-bandwidth live preview of the shown frames over UDP
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup Preview Live preview stream
+/// With FASTLED_PREVIEW set (see fastled_config.h), show() hands a downsampled copy
+/// of every controller's pixels to a low priority sender task, at most
+/// preview_begin()'s fps times a second. The sender delta-encodes the frame against
+/// the previous one it sent and sends it as one UDP datagram. The render and output
+/// path never wait on it: if the sender is still busy with the last frame, or the
+/// socket would block, the preview frame is dropped and the next one sent is a key
+/// frame.
+///
+/// The packets are described in preview_codec.h. A client reconstructs frames with
+/// preview_decode(); preview_codec.cpp has no ESP-IDF dependencies and can be built
+/// into a viewer on a PC, as host/preview_loopback.cpp does.
+///
+/// Example:
+///  preview_begin("192.168.1.20", 7890, 10);   // once the network is up
+///@{
+
+/// A key frame is sent at least every this many preview frames
+#ifndef FASTLED_PREVIEW_KEY_INTERVAL
+#define FASTLED_PREVIEW_KEY_INTERVAL 30
+#endif
+
+/// Start sending preview frames to host:port, at most fps a second. Call once the
+/// network is up; allocates the buffers and starts the sender task.
+bool preview_begin(const char * host, uint16_t port, uint8_t fps = 10);
+
+/// Stop sending preview frames
+void preview_end();
+
+/// Hand the frame just shown to the sender; called by show()
+void preview_frame(uint8_t scale);
+
+/// Preview frames sent, and dropped because the sender or the socket was busy
+void preview_stats(uint32_t * sent, uint32_t * dropped);
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
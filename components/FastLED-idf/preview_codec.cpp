@@ -0,0 +1,101 @@
+#define FASTLED_INTERNAL
+#include "preview_codec.h"
+
+#include <string.h>
+
+FASTLED_NAMESPACE_BEGIN
+
+static inline void put16(uint8_t * p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static inline uint16_t get16(const uint8_t * p) { return p[0] | (p[1] << 8); }
+
+static inline bool changed(const uint8_t * frame, const uint8_t * prev, int i) {
+    return memcmp(frame + 3 * i, prev + 3 * i, 3) != 0;
+}
+
+bool preview_same_layout(const PreviewLayout & a, const PreviewLayout & b) {
+    if (a.count != b.count) return false;
+    for (int c = 0; c < a.count; c++) {
+        if (a.len[c] != b.len[c] || a.step[c] != b.step[c]) return false;
+    }
+    return true;
+}
+
+/*
+ * Single unchanged pixels between changes are sent along, they cost as much as
+ * a new run.
+ */
+int preview_encode(uint8_t * packet, int size, const PreviewLayout & l, uint8_t scale, uint16_t seq,
+                   const uint8_t * frame, const uint8_t * prev, bool key) {
+    if (prev == NULL) key = true;
+    uint8_t * p = packet;
+    const uint8_t * end = packet + size;
+    if (PREVIEW_HEADER_SIZE + 3 * l.count > size) return -1;
+    p[0] = 'F';
+    p[1] = 'P';
+    p[2] = PREVIEW_VERSION;
+    p[3] = key ? PREVIEW_FLAG_KEY : 0;
+    put16(p + 4, seq);
+    put16(p + 6, key ? seq : seq - 1);
+    p[8] = scale;
+    p[9] = l.count;
+    p += PREVIEW_HEADER_SIZE;
+    for (int c = 0; c < l.count; c++) {
+        put16(p, l.len[c]);
+        p[2] = l.step[c];
+        p += 3;
+    }
+
+    int n = l.total;
+    int i = 0;
+    while (i < n) {
+        if (!key && !changed(frame, prev, i)) { i++; continue; }
+        int start = i++;
+        while (i < n && i - start < 255) {
+            if (key || changed(frame, prev, i)) {
+                i++;
+            } else if (i + 1 < n && i + 1 - start < 255 && changed(frame, prev, i + 1)) {
+                i += 2;
+            } else {
+                break;
+            }
+        }
+        int count = i - start;
+        if (p + PREVIEW_RUN_SIZE + 3 * count > end) return -1;
+        put16(p, start);
+        p[2] = count;
+        p += PREVIEW_RUN_SIZE;
+        memcpy(p, frame + 3 * start, 3 * count);
+        p += 3 * count;
+    }
+    return p - packet;
+}
+
+int preview_decode(const uint8_t * packet, int len, uint8_t * frame, int maxPixels, uint16_t * seq) {
+    if (len < PREVIEW_HEADER_SIZE || packet[0] != 'F' || packet[1] != 'P' || packet[2] != PREVIEW_VERSION) return -1;
+    bool key = packet[3] & PREVIEW_FLAG_KEY;
+    uint16_t s = get16(packet + 4);
+    uint16_t base = get16(packet + 6);
+    int count = packet[9];
+    int p = PREVIEW_HEADER_SIZE + 3 * count;
+    if (p > len) return -1;
+
+    int total = 0;
+    for (int c = 0; c < count; c++) {
+        total += get16(packet + PREVIEW_HEADER_SIZE + 3 * c);
+    }
+    if (total > maxPixels) return -1;
+    if (!key && base != *seq) return 0;
+
+    while (p + PREVIEW_RUN_SIZE <= len) {
+        int first = get16(packet + p);
+        int n = packet[p + 2];
+        p += PREVIEW_RUN_SIZE;
+        if (first + n > total || p + 3 * n > len) return -1;
+        memcpy(frame + 3 * first, packet + p, 3 * n);
+        p += 3 * n;
+    }
+    *seq = s;
+    return total;
+}
+
+FASTLED_NAMESPACE_END
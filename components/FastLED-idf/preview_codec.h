@@ -0,0 +1,82 @@
+#ifndef __INC_PREVIEW_CODEC_H
+#define __INC_PREVIEW_CODEC_H
+
+#ifdef ESP_PLATFORM
+#include "FastLED.h"
+#else
+// -- Host build, for a viewer on a PC: this file and preview_codec.cpp are all it needs
+#include <stdint.h>
+#include <stddef.h>
+#ifndef FASTLED_NAMESPACE_BEGIN
+#define FASTLED_NAMESPACE_BEGIN
+#define FASTLED_NAMESPACE_END
+#endif
+#endif
+
+///@file preview_codec.h
+/// packet format of the live preview stream
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup PreviewCodec Preview packets
+/// The live preview (see preview.h) sends every frame as one UDP datagram, delta-encoded
+/// against the frame sent before it. Frames are rgb triples, 3 bytes a pixel, so a CRGB
+/// array can be passed as is.
+///
+/// Packet layout, multi-byte fields little endian:
+///  - 'F' 'P', version (1), flags (bit 0: key frame)
+///  - uint16 sequence number, uint16 sequence number of the frame the delta is against
+///  - brightness scale passed to show(), number of controllers
+///  - per controller: uint16 preview pixels, uint8 step (every step'th led is sent)
+///  - then runs up to the end of the packet: uint16 first pixel, uint8 count, count rgb
+///    triples. Pixels are numbered across the controllers, in controller order.
+///@{
+
+/// Most pixels in a preview frame, over all controllers
+#ifndef FASTLED_PREVIEW_MAX_PIXELS
+#define FASTLED_PREVIEW_MAX_PIXELS 400
+#endif
+
+/// Most controllers in a preview frame
+#ifndef FASTLED_PREVIEW_MAX_CONTROLLERS
+#define FASTLED_PREVIEW_MAX_CONTROLLERS 8
+#endif
+
+#define PREVIEW_VERSION 1
+#define PREVIEW_FLAG_KEY 0x01
+#define PREVIEW_HEADER_SIZE 10
+#define PREVIEW_RUN_SIZE 3
+/// Largest packet, a key frame of FASTLED_PREVIEW_MAX_PIXELS pixels
+#define PREVIEW_PACKET_SIZE (PREVIEW_HEADER_SIZE + 3 * FASTLED_PREVIEW_MAX_CONTROLLERS + \
+                             3 * FASTLED_PREVIEW_MAX_PIXELS + \
+                             PREVIEW_RUN_SIZE * ((FASTLED_PREVIEW_MAX_PIXELS + 254) / 255))
+
+/// How a preview frame is made up of the controllers
+struct PreviewLayout {
+    uint8_t count;          ///< controllers
+    uint16_t total;         ///< pixels, over all controllers
+    uint16_t len[FASTLED_PREVIEW_MAX_CONTROLLERS];
+    uint8_t step[FASTLED_PREVIEW_MAX_CONTROLLERS];
+};
+
+/// Do two frames have the same controllers and steps, so one can be a delta of the other?
+bool preview_same_layout(const PreviewLayout & a, const PreviewLayout & b);
+
+/// Encode frame, numbered seq, into packet: against prev, the frame numbered seq - 1,
+/// or on its own if key is set or prev is NULL. Returns the packet length, -1 if it
+/// would be longer than size (a key frame always fits in PREVIEW_PACKET_SIZE).
+int preview_encode(uint8_t * packet, int size, const PreviewLayout & layout, uint8_t scale, uint16_t seq,
+                   const uint8_t * frame, const uint8_t * prev, bool key);
+
+/// Apply a preview packet to frame, which holds the pixels of all controllers in
+/// order. seq holds the sequence number of the frame last applied; deltas against
+/// any other frame are refused until the next key frame. Returns the number of
+/// pixels in the frame, 0 if the packet was refused, -1 if it is malformed or
+/// frame is too small.
+int preview_decode(const uint8_t * packet, int len, uint8_t * frame, int maxPixels, uint16_t * seq);
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -0,0 +1,365 @@
+#define FASTLED_INTERNAL
+#include "topology.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+FASTLED_NAMESPACE_BEGIN
+
+// -- Timings of the ESP32 clockless controllers in chipsets.h (T1, T2, T3 in ns),
+//    and the bytes sent per led and per frame by the clocked ones
+struct TopologyChipsetInfo {
+	const char * name;
+	uint16_t t1, t2, t3;
+	uint8_t bytesPerLed;	// clocked only
+	uint8_t frameBytes;		// start and end frames, clocked only
+	uint16_t latchUs;
+};
+
+static const TopologyChipsetInfo gChipsets[TOPO_NUM_CHIPSETS] = {
+	{ "WS2812B",    250,  625, 375, 0, 0,  50 },
+	{ "WS2811",     320,  320, 640, 0, 0,  50 },
+	{ "WS2811_400", 800,  800, 900, 0, 0,  50 },
+	{ "WS2813",     320,  320, 640, 0, 0,  50 },
+	{ "SK6812",     300,  300, 600, 0, 0,  50 },
+	{ "TM1809",     350,  350, 450, 0, 0,  50 },
+	{ "UCS1903",    500, 1500, 500, 0, 0,  50 },
+	{ "GE8822",     350,  660, 350, 0, 0,  50 },
+	{ "APA102",       0,    0,   0, 4, 8,   0 },
+	{ "SK9822",       0,    0,   0, 4, 12,  0 },
+	{ "WS2801",       0,    0,   0, 3, 0, 500 },
+	{ "LPD8806",      0,    0,   0, 3, 0,   0 },
+	{ "P9813",        0,    0,   0, 4, 8,   0 },
+};
+
+#define TOPO_I2S_MAX_LANES		24		// FASTLED_I2S_MAX_CONTROLLERS
+#define TOPO_RMT_MAX_CONTROLLERS	32		// FASTLED_RMT_MAX_CONTROLLERS
+#define TOPO_RMT_BLOCKS			8
+#define TOPO_I2S_PULSE_NS		125		// typical I2S pulse, to size the DMA buffers
+
+static inline bool isClocked(uint8_t chipset) { return chipset >= TOPO_APA102; }
+
+// -- GPIOs fastpin_esp32.h defines: 6-11 hold the flash, 20, 24 and 28-31 do
+//    not exist, and 34-39 are inputs only
+static bool isOutputPin(int pin) {
+	return (pin >= 0 && pin <= 5) || (pin >= 12 && pin <= 19) || (pin >= 21 && pin <= 23) ||
+		   (pin >= 25 && pin <= 27) || pin == 32 || pin == 33;
+}
+
+static uint32_t bitPeriodNs(uint8_t chipset) {
+	const TopologyChipsetInfo & c = gChipsets[chipset];
+	return c.t1 + c.t2 + c.t3;
+}
+
+// -- Time on the wire for a whole strip, in us
+static uint32_t stripUs(const TopologyStrip & s, const TopologyOptions & o, uint8_t driver) {
+	const TopologyChipsetInfo & c = gChipsets[s.chipset];
+	if(!isClocked(s.chipset)) {
+		return (uint32_t)((uint64_t)s.numLeds * 24 * bitPeriodNs(s.chipset) / 1000) + c.latchUs;
+	}
+	// -- APA102 style end frames need a bit per two leds
+	uint32_t bytes = (uint32_t)s.numLeds * c.bytesPerLed + c.frameBytes;
+	if(c.frameBytes) { bytes += (s.numLeds + 15) / 16; }
+	if(s.chipset == TOPO_LPD8806) { bytes += (s.numLeds + 31) / 32; }
+	uint32_t hz = o.spiHz;
+	uint64_t byteNs;
+	if(driver == TOPO_HW_SPI) {
+		byteNs = 8000000000ULL / hz + o.hwSpiByteNs;
+	} else {
+		if(hz > o.softSpiHz) { hz = o.softSpiHz; }
+		byteNs = 8000000000ULL / hz;
+	}
+	return (uint32_t)(bytes * byteNs / 1000) + c.latchUs;
+}
+
+void topology_default_options(TopologyOptions & o) {
+	o.allowI2S = true;
+	o.allowRMT = true;
+	o.allowHardwareSPI = false;
+	o.rmtBuiltinDriver = false;
+	o.rmtMinMemBlocks = 1;
+	o.heapBudget = 0;
+	o.spiHz = 12000000;
+	o.softSpiHz = 4000000;
+	o.hwSpiByteNs = 1000;
+}
+
+const char * topology_chipset_name(uint8_t chipset) {
+	return chipset < TOPO_NUM_CHIPSETS ? gChipsets[chipset].name : "?";
+}
+
+// -- One way of sending the clockless strips, and what it comes to
+struct TopologyCandidate {
+	uint8_t driver;
+	uint8_t memBlocks;
+	uint8_t numPlaced;
+	uint16_t prioritySum;
+	uint32_t frameUs;
+	uint32_t heapBytes;
+	uint8_t placed[TOPOLOGY_MAX_STRIPS];	// driver per strip, TOPO_UNPLACED if left out
+	const char * reason[TOPOLOGY_MAX_STRIPS];
+	uint32_t startUs[TOPOLOGY_MAX_STRIPS];
+	uint32_t endUs[TOPOLOGY_MAX_STRIPS];
+};
+
+static void evaluate(const TopologyStrip * strips, int n, const uint8_t * rank, const TopologyOptions & o,
+					 TopologyCandidate & c) {
+	int lanes = 0;
+	int maxLanes = c.driver == TOPO_I2S ? TOPO_I2S_MAX_LANES : TOPO_RMT_MAX_CONTROLLERS;
+	uint32_t i2sPeriod = 0;
+	c.numPlaced = 0;
+	c.prioritySum = 0;
+	c.heapBytes = 0;
+
+	// -- Place in rank order, while the lanes and the heap last
+	for(int r = 0; r < n; r++) {
+		int i = rank[r];
+		const TopologyStrip & s = strips[i];
+		if(c.reason[i]) { continue; }
+		uint32_t heap = (uint32_t)s.numLeds * 3;
+		bool clockless = !isClocked(s.chipset);
+		if(clockless) {
+			if(c.driver == TOPO_UNPLACED || lanes == maxLanes) {
+				c.reason[i] = "no I2S lane or RMT controller left";
+				continue;
+			}
+			if(c.driver == TOPO_RMT && o.rmtBuiltinDriver) {
+				heap += (uint32_t)s.numLeds * 24 * 4;
+			}
+			if(c.driver == TOPO_I2S && bitPeriodNs(s.chipset) > i2sPeriod) {
+				// -- Two DMA buffers of one pixel on every lane, grown to the slowest chipset
+				uint32_t pulses = (bitPeriodNs(s.chipset) + TOPO_I2S_PULSE_NS - 1) / TOPO_I2S_PULSE_NS;
+				uint32_t old = (i2sPeriod + TOPO_I2S_PULSE_NS - 1) / TOPO_I2S_PULSE_NS;
+				heap += 2 * 3 * 8 * 4 * (pulses - old);
+			}
+		}
+		if(o.heapBudget && c.heapBytes + heap > o.heapBudget) {
+			c.reason[i] = "over the heap budget";
+			continue;
+		}
+		c.heapBytes += heap;
+		c.numPlaced++;
+		c.prioritySum += s.priority;
+		if(clockless) {
+			lanes++;
+			c.placed[i] = c.driver;
+			if(c.driver == TOPO_I2S && bitPeriodNs(s.chipset) > i2sPeriod) { i2sPeriod = bitPeriodNs(s.chipset); }
+		} else {
+			c.placed[i] = TOPO_SW_SPI;
+		}
+	}
+
+	// -- Hardware SPI sends every clocked strip over the bus pins, so it only
+	//    works for a single clocked strip on them
+	int numClocked = 0, clocked = -1;
+	for(int i = 0; i < n; i++) {
+		if(c.placed[i] == TOPO_SW_SPI) { numClocked++; clocked = i; }
+	}
+	if(o.allowHardwareSPI && numClocked == 1) {
+		const TopologyStrip & s = strips[clocked];
+		if((s.dataPin == 23 && s.clockPin == 18) || (s.dataPin == 13 && s.clockPin == 14)) {
+			c.placed[clocked] = TOPO_HW_SPI;
+		}
+	}
+
+	// -- Clockless strips: I2S sends them all at once, on one bit period for
+	//    every lane; RMT starts them in order on whichever channel frees up first
+	uint32_t busy[TOPO_RMT_BLOCKS];
+	int channels = c.driver == TOPO_RMT ? TOPO_RMT_BLOCKS / c.memBlocks : 0;
+	for(int ch = 0; ch < channels; ch++) { busy[ch] = 0; }
+	uint32_t clocklessUs = 0;
+	for(int r = 0; r < n; r++) {
+		int i = rank[r];
+		if(c.placed[i] != TOPO_I2S && c.placed[i] != TOPO_RMT) { continue; }
+		const TopologyStrip & s = strips[i];
+		if(c.driver == TOPO_I2S) {
+			c.startUs[i] = 0;
+			c.endUs[i] = (uint32_t)((uint64_t)s.numLeds * 24 * i2sPeriod / 1000) + gChipsets[s.chipset].latchUs;
+		} else {
+			int first = 0;
+			for(int ch = 1; ch < channels; ch++) {
+				if(busy[ch] < busy[first]) { first = ch; }
+			}
+			c.startUs[i] = busy[first];
+			c.endUs[i] = busy[first] = busy[first] + stripUs(s, o, TOPO_RMT);
+		}
+		if(c.endUs[i] > clocklessUs) { clocklessUs = c.endUs[i]; }
+	}
+
+	// -- Clocked strips go out one after the other, once the clockless ones are done
+	c.frameUs = clocklessUs;
+	for(int r = 0; r < n; r++) {
+		int i = rank[r];
+		if(c.placed[i] != TOPO_HW_SPI && c.placed[i] != TOPO_SW_SPI) { continue; }
+		c.startUs[i] = c.frameUs;
+		c.frameUs += stripUs(strips[i], o, c.placed[i]);
+		c.endUs[i] = c.frameUs;
+	}
+}
+
+static bool better(const TopologyCandidate & a, const TopologyCandidate & b) {
+	if(a.numPlaced != b.numPlaced) { return a.numPlaced > b.numPlaced; }
+	if(a.prioritySum != b.prioritySum) { return a.prioritySum > b.prioritySum; }
+	if(a.frameUs != b.frameUs) { return a.frameUs < b.frameUs; }
+	return a.heapBytes < b.heapBytes;
+}
+
+bool topology_plan(const TopologyStrip * strips, int numStrips, TopologyPlan & plan,
+				   const TopologyOptions * options) {
+	TopologyOptions o;
+	if(options) { o = *options; } else { topology_default_options(o); }
+	int n = numStrips < TOPOLOGY_MAX_STRIPS ? numStrips : TOPOLOGY_MAX_STRIPS;
+
+	// -- Strips that cannot go anywhere, whatever the plan
+	const char * invalid[TOPOLOGY_MAX_STRIPS];
+	bool anyClockless = false;
+	for(int i = 0; i < n; i++) {
+		const TopologyStrip & s = strips[i];
+		invalid[i] = NULL;
+		if(s.chipset >= TOPO_NUM_CHIPSETS) { invalid[i] = "unknown chipset"; }
+		else if(s.numLeds == 0) { invalid[i] = "no leds"; }
+		else if(!isOutputPin(s.dataPin)) { invalid[i] = "data pin is not an output"; }
+		else if(isClocked(s.chipset) && !isOutputPin(s.clockPin)) { invalid[i] = "clock pin is not an output"; }
+		for(int j = 0; j < i && !invalid[i]; j++) {
+			if(!invalid[j] && strips[j].dataPin == s.dataPin) { invalid[i] = "data pin already used"; }
+		}
+		if(!invalid[i] && !isClocked(s.chipset)) { anyClockless = true; }
+	}
+
+	// -- Highest priority first, then longest first: that is the order RMT should
+	//    start them in, and the order they get dropped in the other way round
+	uint8_t rank[TOPOLOGY_MAX_STRIPS];
+	uint32_t length[TOPOLOGY_MAX_STRIPS];
+	for(int i = 0; i < n; i++) {
+		rank[i] = i;
+		length[i] = invalid[i] ? 0 : stripUs(strips[i], o, TOPO_RMT);
+	}
+	for(int i = 1; i < n; i++) {
+		uint8_t v = rank[i];
+		int j = i;
+		while(j > 0 && (strips[rank[j - 1]].priority < strips[v].priority ||
+				(strips[rank[j - 1]].priority == strips[v].priority && length[rank[j - 1]] < length[v]))) {
+			rank[j] = rank[j - 1];
+			j--;
+		}
+		rank[j] = v;
+	}
+
+	// -- Try I2S, then RMT from the most memory blocks per channel down, keeping
+	//    the first of equally good plans
+	uint8_t drivers[5], blocks[5];
+	int numCandidates = 0;
+	if(!anyClockless) {
+		drivers[numCandidates] = TOPO_UNPLACED; blocks[numCandidates++] = 0;
+	}
+	if(anyClockless && o.allowI2S) {
+		drivers[numCandidates] = TOPO_I2S; blocks[numCandidates++] = 0;
+	}
+	for(int m = TOPO_RMT_BLOCKS; anyClockless && o.allowRMT && m >= 1 && m >= o.rmtMinMemBlocks; m /= 2) {
+		drivers[numCandidates] = TOPO_RMT; blocks[numCandidates++] = m;
+	}
+	if(numCandidates == 0) {
+		drivers[numCandidates] = TOPO_UNPLACED; blocks[numCandidates++] = 0;
+	}
+
+	// -- Over a kilobyte together, so kept off the stack
+	static TopologyCandidate best, c;
+	for(int k = 0; k < numCandidates; k++) {
+		TopologyCandidate & cand = (k == 0) ? best : c;
+		cand.driver = drivers[k];
+		cand.memBlocks = blocks[k];
+		for(int i = 0; i < n; i++) {
+			cand.placed[i] = TOPO_UNPLACED;
+			cand.reason[i] = invalid[i];
+			cand.startUs[i] = cand.endUs[i] = 0;
+		}
+		evaluate(strips, n, rank, o, cand);
+		if(k > 0 && better(c, best)) { best = c; }
+	}
+
+	plan.numStrips = n;
+	plan.numPlaced = best.numPlaced;
+	plan.clocklessDriver = best.driver;
+	plan.rmtMemBlocks = best.driver == TOPO_RMT ? best.memBlocks : 0;
+	plan.rmtChannels = best.driver == TOPO_RMT ? TOPO_RMT_BLOCKS / best.memBlocks : 0;
+	plan.spiBus = 0;
+	plan.frameUs = best.frameUs;
+	plan.fps = best.frameUs ? (1000000 / best.frameUs > 65535 ? 65535 : 1000000 / best.frameUs) : 0;
+	plan.heapBytes = best.heapBytes;
+
+	// -- Clockless strips in rank order, then the clocked ones, then the rest
+	int k = 0;
+	for(int pass = 0; pass < 3; pass++) {
+		for(int r = 0; r < n; r++) {
+			int i = rank[r];
+			uint8_t d = best.placed[i];
+			bool mine = (pass == 0) ? (d == TOPO_I2S || d == TOPO_RMT)
+					  : (pass == 1) ? (d == TOPO_HW_SPI || d == TOPO_SW_SPI)
+					  : (d == TOPO_UNPLACED);
+			if(!mine) { continue; }
+			TopologyAssignment & a = plan.order[k++];
+			a.strip = i;
+			a.driver = d;
+			a.reason = (d == TOPO_UNPLACED) ? (best.reason[i] ? best.reason[i] : "not placed") : NULL;
+			a.startUs = best.startUs[i];
+			a.endUs = best.endUs[i];
+			if(d == TOPO_HW_SPI) { plan.spiBus = strips[i].dataPin == 23 ? 3 : 2; }
+		}
+	}
+	return plan.numPlaced == numStrips;
+}
+
+// -- snprintf that keeps counting past the end of the buffer
+static int append(char * buf, int size, int len, const char * fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	int room = len < size ? size - len : 0;
+	int w = vsnprintf(room ? buf + len : NULL, room, fmt, args);
+	va_end(args);
+	return len + (w > 0 ? w : 0);
+}
+
+int topology_print(const TopologyStrip * strips, int numStrips, const TopologyPlan & plan,
+				   char * buf, int size) {
+	static const char * driverNames[] = { "left out", "I2S", "RMT", "hardware SPI", "software SPI" };
+	int len = 0;
+	if(size > 0) { buf[0] = 0; }
+
+	len = append(buf, size, len, "// %d of %d strips, frame %lu us (%u fps), %lu bytes of heap\n",
+				 plan.numPlaced, numStrips, (unsigned long)plan.frameUs, plan.fps, (unsigned long)plan.heapBytes);
+	if(plan.clocklessDriver == TOPO_I2S) {
+		len = append(buf, size, len, "// clockless strips on I2S: keep #define FASTLED_ESP32_I2S in FastLED.h\n");
+	} else if(plan.clocklessDriver == TOPO_RMT) {
+		len = append(buf, size, len,
+					 "// clockless strips on RMT: remove #define FASTLED_ESP32_I2S from FastLED.h, add\n"
+					 "// \"platforms/esp/32/clockless_rmt_esp32.cpp\" to srcs in CMakeLists.txt, and in fastled_config.h:\n"
+					 "#define MEM_BLOCK_NUM %u\n"
+					 "#define FASTLED_RMT_MAX_CHANNELS %u\n",
+					 plan.rmtMemBlocks, plan.rmtChannels);
+	}
+	if(plan.spiBus) {
+		len = append(buf, size, len,
+					 "// clocked strip on hardware SPI, in fastled_config.h:\n"
+					 "#define FASTLED_ALL_PINS_HARDWARE_SPI\n"
+					 "#define FASTLED_ESP32_SPI_BUS %s\n", plan.spiBus == 3 ? "VSPI" : "HSPI");
+	}
+
+	for(int k = 0; k < plan.numStrips; k++) {
+		const TopologyAssignment & a = plan.order[k];
+		const TopologyStrip & s = strips[a.strip];
+		if(a.driver == TOPO_UNPLACED) {
+			len = append(buf, size, len, "// left out: leds[%u], %s\n", a.strip, a.reason);
+		} else if(isClocked(s.chipset)) {
+			len = append(buf, size, len, "FastLED.addLeds<%s, %d, %d>(leds[%u], %u);\t// %s, %lu - %lu us\n",
+						 gChipsets[s.chipset].name, s.dataPin, s.clockPin, a.strip, s.numLeds,
+						 driverNames[a.driver], (unsigned long)a.startUs, (unsigned long)a.endUs);
+		} else {
+			len = append(buf, size, len, "FastLED.addLeds<%s, %d>(leds[%u], %u);\t// %s, %lu - %lu us\n",
+						 gChipsets[s.chipset].name, s.dataPin, a.strip, s.numLeds,
+						 driverNames[a.driver], (unsigned long)a.startUs, (unsigned long)a.endUs);
+		}
+	}
+	return len;
+}
+
+FASTLED_NAMESPACE_END
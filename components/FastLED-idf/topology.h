@@ -0,0 +1,153 @@
+#ifndef __INC_TOPOLOGY_H
+#define __INC_TOPOLOGY_H
+
+#ifdef ESP_PLATFORM
+#include "FastLED.h"
+#else
+// -- Host build, for testing and planning on a PC
+#include <stdint.h>
+#include <stddef.h>
+#ifndef FASTLED_NAMESPACE_BEGIN
+#define FASTLED_NAMESPACE_BEGIN
+#define FASTLED_NAMESPACE_END
+#endif
+#endif
+
+///@file topology.h
+/// assigning strips to the RMT, I2S and SPI drivers
+
+FASTLED_NAMESPACE_BEGIN
+
+///@defgroup Topology Driver planning
+/// topology_plan() takes the strips of an installation (pins, chipset, length and an
+/// optional priority) and works out which driver sends each of them, in which order
+/// they should be added, and the frame time that results:
+///
+/// - clockless strips all go to I2S (up to 24 lanes, sent in parallel, so the frame
+///   takes as long as the longest strip) or all to RMT (queued over 8 / MEM_BLOCK_NUM
+///   channels in the order they were added, so the order matters). Which one is a
+///   build choice in this port, so the plan picks one for all of them. For RMT it
+///   also picks MEM_BLOCK_NUM (fewer blocks give more channels, more blocks ride out
+///   interrupt latency better) and orders the strips longest first.
+/// - clocked strips are bit banged, one after another. With allowHardwareSPI, a single
+///   clocked strip on the pins of the VSPI or HSPI bus goes to hardware SPI instead,
+///   since FASTLED_ALL_PINS_HARDWARE_SPI sends every clocked strip over that bus. That
+///   needs the Arduino SPIClass fastspi_esp32.h is written for, which this port lacks,
+///   so it is off by default.
+///
+/// When a limit is hit (24 I2S lanes, 32 RMT controllers, the heap budget), strips
+/// with the lowest priority are left out first, and are marked TOPO_UNPLACED.
+///
+/// topology_print() writes the plan out as the build settings and the addLeds()
+/// calls, in order. All of this is plain C++, so it runs on the host too.
+///
+/// Example:
+///  TopologyStrip strips[] = {
+///      { 13, -1, TOPO_WS2812, 300 }, { 14, -1, TOPO_WS2812, 300 },
+///      { 23, 18, TOPO_APA102, 144 },
+///  };
+///  TopologyPlan plan;
+///  topology_plan(strips, 3, plan);
+///  char text[1024];
+///  topology_print(strips, 3, plan, text, sizeof(text));
+///@{
+
+/// Most strips a plan can take
+#ifndef TOPOLOGY_MAX_STRIPS
+#define TOPOLOGY_MAX_STRIPS 32
+#endif
+
+/// Chipsets known to the planner, with the timings of the ESP32 controllers
+typedef enum {
+	TOPO_WS2812 = 0,		///< WS2812 / WS2812B / NEOPIXEL
+	TOPO_WS2811,
+	TOPO_WS2811_400,
+	TOPO_WS2813,
+	TOPO_SK6812,
+	TOPO_TM1809,
+	TOPO_UCS1903,
+	TOPO_GE8822,
+	TOPO_APA102,			///< first clocked chipset
+	TOPO_SK9822,
+	TOPO_WS2801,
+	TOPO_LPD8806,
+	TOPO_P9813,
+	TOPO_NUM_CHIPSETS
+} ETopologyChipset;
+
+/// Drivers a strip can be sent with
+typedef enum {
+	TOPO_UNPLACED = 0,		///< left out: see TopologyAssignment::reason
+	TOPO_I2S,
+	TOPO_RMT,
+	TOPO_HW_SPI,
+	TOPO_SW_SPI
+} ETopologyDriver;
+
+/// One strip of the installation
+struct TopologyStrip {
+	int8_t dataPin;
+	int8_t clockPin;		///< clocked chipsets only, -1 otherwise
+	uint8_t chipset;		///< ETopologyChipset
+	uint16_t numLeds;
+	uint8_t priority;		///< higher is placed first when something runs out, default 0
+};
+
+/// Limits and cost model; topology_default_options() fills in the defaults
+struct TopologyOptions {
+	bool allowI2S;
+	bool allowRMT;
+	bool allowHardwareSPI;		///< off by default, fastspi_esp32.h needs the Arduino SPIClass
+	bool rmtBuiltinDriver;		///< FASTLED_RMT_BUILTIN_DRIVER: 96 bytes of buffer per led
+	uint8_t rmtMinMemBlocks;	///< lowest MEM_BLOCK_NUM to consider: 1, 2, 4 or 8
+	uint32_t heapBudget;		///< bytes for the led arrays and driver buffers, 0 for no limit
+	uint32_t spiHz;				///< clock of the clocked strips (the controllers default to 12MHz)
+	uint32_t softSpiHz;			///< fastest a bit banged strip goes
+	uint16_t hwSpiByteNs;		///< per byte overhead of the hardware SPI driver
+};
+
+/// Where one strip goes
+struct TopologyAssignment {
+	uint8_t strip;			///< index in the strips given to topology_plan()
+	uint8_t driver;			///< ETopologyDriver
+	const char * reason;	///< why it was left out, NULL when placed
+	uint32_t startUs;		///< predicted start and end of its output in the frame
+	uint32_t endUs;
+};
+
+/// The result of topology_plan(); order[] is the order to add the controllers in,
+/// followed by the strips left out
+struct TopologyPlan {
+	uint8_t numStrips;
+	uint8_t numPlaced;
+	uint8_t clocklessDriver;	///< TOPO_I2S or TOPO_RMT, TOPO_UNPLACED if there are no clockless strips
+	uint8_t rmtMemBlocks;		///< MEM_BLOCK_NUM, when clocklessDriver is TOPO_RMT
+	uint8_t rmtChannels;		///< FASTLED_RMT_MAX_CHANNELS
+	uint8_t spiBus;				///< 0, or 2 (HSPI) / 3 (VSPI) when a strip is on hardware SPI
+	uint32_t frameUs;			///< predicted time to send a frame
+	uint16_t fps;				///< 1000000 / frameUs, not counting the rendering
+	uint32_t heapBytes;			///< predicted led arrays plus driver buffers
+	TopologyAssignment order[TOPOLOGY_MAX_STRIPS];
+};
+
+/// The default options: I2S and RMT allowed but not hardware SPI, MEM_BLOCK_NUM of 1 or
+/// more, no heap limit
+void topology_default_options(TopologyOptions & options);
+
+/// Plan the strips; returns false if some of them could not be placed
+bool topology_plan(const TopologyStrip * strips, int numStrips, TopologyPlan & plan,
+				   const TopologyOptions * options = NULL);
+
+/// Name of a chipset, as used with addLeds()
+const char * topology_chipset_name(uint8_t chipset);
+
+/// Write the plan as build settings and addLeds() calls into buf, returning the
+/// length of the text (which is cut short if size is too small, like snprintf)
+int topology_print(const TopologyStrip * strips, int numStrips, const TopologyPlan & plan,
+				   char * buf, int size);
+
+///@}
+
+FASTLED_NAMESPACE_END
+
+#endif
@@ -97,7 +97,7 @@ uint16_t WS2812FX::mode_blink(void) {
  * Classic Blink effect. Cycling through the rainbow.
  */
 uint16_t WS2812FX::mode_blink_rainbow(void) {
-  return blink(color_wheel(SEGENV.call & 0xFF), SEGCOLOR(1), false, false);
+  return blink(color_wheel((now / FRAMETIME_FIXED) & 0xFF), SEGCOLOR(1), false, false);
 }
 
 
@@ -113,7 +113,7 @@ uint16_t WS2812FX::mode_strobe(void) {
  * Classic Strobe effect. Cycling through the rainbow.
  */
 uint16_t WS2812FX::mode_strobe_rainbow(void) {
-  return blink(color_wheel(SEGENV.call & 0xFF), SEGCOLOR(1), true, false);
+  return blink(color_wheel((now / FRAMETIME_FIXED) & 0xFF), SEGCOLOR(1), true, false);
 }
 
 
@@ -532,10 +532,11 @@ uint16_t WS2812FX::dissolve(uint32_t color) {
     }
   }
 
-  if (SEGENV.call > (255 - SEGMENT.speed) + 15) 
+  SEGENV.step += FRAMEDELTA;
+  if (SEGENV.step > ((255 - SEGMENT.speed) + 15) * FRAMETIME_FIXED)
   {
     SEGENV.aux0 = !SEGENV.aux0;
-    SEGENV.call = 0;
+    SEGENV.step = 0;
   }
   
   return FRAMETIME;
@@ -784,7 +785,7 @@ uint16_t WS2812FX::mode_chase_random(void) {
  */
 uint16_t WS2812FX::mode_chase_rainbow(void) {
   uint8_t color_sep = 256 / SEGLEN;
-  uint8_t color_index = SEGENV.call & 0xFF;
+  uint8_t color_index = (now / FRAMETIME_FIXED) & 0xFF;
   uint32_t color = color_wheel(((SEGENV.step * color_sep) + color_index) & 0xFF);
 
   return chase(color, SEGCOLOR(0), SEGCOLOR(1), false);
@@ -797,8 +798,9 @@ uint16_t WS2812FX::mode_chase_rainbow(void) {
 uint16_t WS2812FX::mode_chase_rainbow_white(void) {
   uint16_t n = SEGENV.step;
   uint16_t m = (SEGENV.step + 1) % SEGLEN;
-  uint32_t color2 = color_wheel(((n * 256 / SEGLEN) + (SEGENV.call & 0xFF)) & 0xFF);
-  uint32_t color3 = color_wheel(((m * 256 / SEGLEN) + (SEGENV.call & 0xFF)) & 0xFF);
+  uint8_t color_index = (now / FRAMETIME_FIXED) & 0xFF;
+  uint32_t color2 = color_wheel(((n * 256 / SEGLEN) + color_index) & 0xFF);
+  uint32_t color3 = color_wheel(((m * 256 / SEGLEN) + color_index) & 0xFF);
 
   return chase(SEGCOLOR(0), color2, color3, false);
 }
@@ -1018,13 +1020,13 @@ uint16_t WS2812FX::mode_running_random(void) {
   uint32_t it = now / cycleTime;
   if (SEGENV.aux1 == it) return FRAMETIME;
 
-  for(uint16_t i=SEGLEN-1; i > 0; i--) {
-    setPixelColor( i, getPixelColor( i - 1));
-  }
+  scroll(1);
 
   if(SEGENV.step == 0) {
     SEGENV.aux0 = get_random_wheel_index(SEGENV.aux0);
     setPixelColor(0, color_wheel(SEGENV.aux0));
+  } else if (SEGLEN > 1) {
+    setPixelGroup(0, col_to_crgb(getPixelColor(1))); //extend the current color as shown, the wrapped pixel is stale
   }
 
   SEGENV.step++;
@@ -1137,15 +1139,11 @@ uint16_t WS2812FX::mode_fireworks() {
 //Twinkling LEDs running. Inspired by https://github.com/kitesurfer1404/WS2812FX/blob/master/src/custom/Rain.h
 uint16_t WS2812FX::mode_rain()
 {
-  SEGENV.step += FRAMETIME;
+  SEGENV.step += FRAMEDELTA;
   if (SEGENV.step > SPEED_FORMULA_L) {
     SEGENV.step = 0;
-    //shift all leds right
-    uint32_t ctemp = getPixelColor(SEGLEN -1);
-    for(uint16_t i = SEGLEN -1; i > 0; i--) {
-      setPixelColor(i, getPixelColor(i-1));
-    }
-    setPixelColor(0, ctemp);
+    //shift all leds right, the last one wraps around to the start
+    scroll(1);
     SEGENV.aux0++;
     SEGENV.aux1++;
     if (SEGENV.aux0 == 0) SEGENV.aux0 = UINT16_MAX;
@@ -1526,9 +1524,7 @@ uint16_t WS2812FX::mode_random_chase(void)
   uint32_t it = now / cycleTime;
   if (SEGENV.step == it) return FRAMETIME;
 
-  for(uint16_t i = SEGLEN -1; i > 0; i--) {
-    setPixelColor(i, getPixelColor(i-1));
-  }
+  scroll(1);
   uint32_t color = getPixelColor(0);
   if (SEGLEN > 1) color = getPixelColor( 1);
   uint8_t r = random8(6) != 0 ? (color >> 16 & 0xFF) : random8();
@@ -1868,7 +1864,7 @@ uint16_t WS2812FX::mode_fillnoise8()
     fastled_col = ColorFromPalette(currentPalette, index, 255, LINEARBLEND);
     setPixelColor(i, fastled_col.red, fastled_col.green, fastled_col.blue);
   }
-  SEGENV.step += beatsin8(SEGMENT.speed, 1, 6); //10,1,4
+  SEGENV.step += timeScaled(beatsin8(SEGMENT.speed, 1, 6)); //10,1,4
 
   return FRAMETIME;
 }
@@ -1877,7 +1873,7 @@ uint16_t WS2812FX::mode_noise16_1()
 {
   uint16_t scale = 320;                                      // the "zoom factor" for the noise
   CRGB fastled_col;
-  SEGENV.step += (1 + SEGMENT.speed/16);
+  SEGENV.step += timeScaled(1 + SEGMENT.speed/16);
 
   for (uint16_t i = 0; i < SEGLEN; i++) {
 
@@ -1905,7 +1901,7 @@ uint16_t WS2812FX::mode_noise16_2()
 {
   uint16_t scale = 1000;                                       // the "zoom factor" for the noise
   CRGB fastled_col;
-  SEGENV.step += (1 + (SEGMENT.speed >> 1));
+  SEGENV.step += timeScaled(1 + (SEGMENT.speed >> 1));
 
   for (uint16_t i = 0; i < SEGLEN; i++) {
 
@@ -1930,7 +1926,7 @@ uint16_t WS2812FX::mode_noise16_3()
 {
   uint16_t scale = 800;                                       // the "zoom factor" for the noise
   CRGB fastled_col;
-  SEGENV.step += (1 + SEGMENT.speed);
+  SEGENV.step += timeScaled(1 + SEGMENT.speed);
 
   for (uint16_t i = 0; i < SEGLEN; i++) {
 
@@ -2113,7 +2109,7 @@ uint16_t WS2812FX::mode_meteor_smooth() {
     trail[index] = 240;
   }
 
-  SEGENV.step += SEGMENT.speed +1;
+  SEGENV.step += timeScaled(SEGMENT.speed +1);
   return FRAMETIME;
 }
 
@@ -2144,7 +2140,7 @@ uint16_t WS2812FX::mode_railway()
       setPixelColor(i + 1, color_from_palette(pos, false, false, 255));
     }
   }
-  SEGENV.step += FRAMETIME;
+  SEGENV.step += FRAMEDELTA;
   return FRAMETIME;
 }
 
@@ -2307,6 +2303,24 @@ CRGB WS2812FX::twinklefox_one_twinkle(uint32_t ms, uint8_t salt, bool cat)
   return c;
 }
 
+//  The clock offset, speed and salt of a pixel only depend on its
+//  position, so they are worked out once into the segment data.
+typedef struct TwinkleParams { // 4 bytes
+  uint16_t clockOffset;
+  uint8_t speedMultiplier; // in 8ths, 8/8ths to 23/8ths, less 8
+  uint8_t salt;
+} twinkle_params;
+
+static inline void twinklefox_params(uint16_t &PRNG16, twinkle_params &p)
+{
+  PRNG16 = (uint16_t)(PRNG16 * 2053) + 1384; // next 'random' number
+  p.clockOffset = PRNG16; // use that number as clock offset
+  PRNG16 = (uint16_t)(PRNG16 * 2053) + 1384; // next 'random' number
+  // use that number as clock speed adjustment factor (in 8ths, from 8/8ths to 23/8ths)
+  p.speedMultiplier = (((PRNG16 & 0xFF)>>4) + (PRNG16 & 0x0F)) & 0x0F;
+  p.salt = PRNG16 >> 8; // get 'salt' value for this pixel
+}
+
 //  This function loops over each pixel, calculates the
 //  adjusted 'clock' that this pixel should use, and calls
 //  "CalculateOneTwinkle" on each pixel.  It then displays
@@ -2316,14 +2330,24 @@ uint16_t WS2812FX::twinklefox_base(bool cat)
 {
   // "PRNG16" is the pseudorandom number generator
   // It MUST be reset to the same starting value each time
-  // this function is called, so that the sequence of 'random'
+  // the parameters are generated, so that the sequence of 'random'
   // numbers that it generates is (paradoxically) stable.
   uint16_t PRNG16 = 11337;
 
+  bool fill;
+  twinkle_params* params = (twinkle_params*)pixelTable(0, sizeof(twinkle_params), 0, fill);
+  if (params && fill) {
+    for (uint16_t i = 0; i < SEGLEN; i++) twinklefox_params(PRNG16, params[i]);
+  }
+
   // Calculate speed
   if (SEGMENT.speed > 100) SEGENV.aux0 = 3 + ((255 - SEGMENT.speed) >> 3);
   else SEGENV.aux0 = 22 + ((100 - SEGMENT.speed) >> 1);
 
+  // the clock at each of the 16 speeds
+  uint32_t clocks[16];
+  for (uint8_t m = 0; m < 16; m++) clocks[m] = (uint32_t)((now * (m + 8)) >> 3);
+
   // Set up the background color, "bg".
   CRGB bg;
   bg = col_to_crgb(SEGCOLOR(1));
@@ -2340,18 +2364,15 @@ uint16_t WS2812FX::twinklefox_base(bool cat)
 
   for (uint16_t i = 0; i < SEGLEN; i++) {
   
-    PRNG16 = (uint16_t)(PRNG16 * 2053) + 1384; // next 'random' number
-    uint16_t myclockoffset16= PRNG16; // use that number as clock offset
-    PRNG16 = (uint16_t)(PRNG16 * 2053) + 1384; // next 'random' number
-    // use that number as clock speed adjustment factor (in 8ths, from 8/8ths to 23/8ths)
-    uint8_t myspeedmultiplierQ5_3 =  ((((PRNG16 & 0xFF)>>4) + (PRNG16 & 0x0F)) & 0x0F) + 0x08;
-    uint32_t myclock30 = (uint32_t)((now * myspeedmultiplierQ5_3) >> 3) + myclockoffset16;
-    uint8_t  myunique8 = PRNG16 >> 8; // get 'salt' value for this pixel
+    twinkle_params p;
+    if (params) p = params[i];
+    else twinklefox_params(PRNG16, p); // no room for the table
+    uint32_t myclock30 = clocks[p.speedMultiplier] + p.clockOffset;
 
     // We now have the adjusted 'clock' for this pixel, now we call
     // the function that computes what color the pixel should be based
     // on the "brightness = f( time )" idea.
-    CRGB c = twinklefox_one_twinkle(myclock30, myunique8, cat);
+    CRGB c = twinklefox_one_twinkle(myclock30, p.salt, cat);
 
     uint8_t cbright = c.getAverageLight();
     int16_t deltabright = cbright - backgroundBrightness;
@@ -2556,7 +2577,7 @@ uint16_t WS2812FX::mode_bouncing_balls(void) {
   float gravity                           = -9.81; // standard value of gravity
   float impactVelocityStart               = sqrt( -2 * gravity);
 
-  unsigned long time = millis();
+  unsigned long time = nowMillis();
 
   if (SEGENV.call == 0) {
     for (uint8_t i = 0; i < maxNumBalls; i++) balls[i].lastBounceTime = time;
@@ -2732,10 +2753,21 @@ uint16_t WS2812FX::mode_popcorn(void) {
 uint16_t WS2812FX::candle(bool multi)
 {
   
+  CRGB* colors = nullptr; //palette color of each candle, kept while the palette stays the same
   if (multi) {
     //allocate segment data
     uint16_t dataSize = (SEGLEN -1) *3;
-    if (!SEGENV.allocateData(dataSize)) return candle(false); //allocation failed
+    uint32_t key = SEGCOLOR(0);
+    if (SEGMENT.palette) {
+      key = paletteBlend;
+      for (uint8_t k = 0; k < 16; k++) key = (key * 16777619) ^ crgb_to_col(currentPalette[k]);
+    }
+    bool fill;
+    colors = (CRGB*)pixelTable(dataSize, sizeof(CRGB), key, fill);
+    if (SEGENV.dataLen() < dataSize || (dataSize && !SEGENV.data)) return candle(false); //allocation failed
+    if (colors && fill) {
+      for (uint16_t j = 0; j < SEGLEN; j++) colors[j] = col_to_crgb(color_from_palette(j, true, PALETTE_SOLID_WRAP, 0));
+    }
   }
 
   //max. flicker range controlled by intensity
@@ -2789,12 +2821,15 @@ uint16_t WS2812FX::candle(bool multi)
     }
 
      if (i > 0) {
-      setPixelColor(i, color_blend(SEGCOLOR(1), color_from_palette(i, true, PALETTE_SOLID_WRAP, 0), s));
+      uint32_t c = colors ? crgb_to_col(colors[i]) : color_from_palette(i, true, PALETTE_SOLID_WRAP, 0);
+      setPixelColor(i, color_blend(SEGCOLOR(1), c, s));
 
       SEGENV.data[d] = s; SEGENV.data[d+1] = s_target; SEGENV.data[d+2] = fadeStep;
     } else {
-      for (uint16_t j = 0; j < SEGLEN; j++) {
-        setPixelColor(j, color_blend(SEGCOLOR(1), color_from_palette(j, true, PALETTE_SOLID_WRAP, 0), s));
+      //with multiple candles, the others paint over all but the first pixel
+      for (uint16_t j = 0; j < (multi ? 1 : SEGLEN); j++) {
+        uint32_t c = colors ? crgb_to_col(colors[j]) : color_from_palette(j, true, PALETTE_SOLID_WRAP, 0);
+        setPixelColor(j, color_blend(SEGCOLOR(1), c, s));
       }
 
       SEGENV.aux0 = s; SEGENV.aux1 = s_target; SEGENV.step = fadeStep;
@@ -2840,7 +2875,7 @@ uint16_t WS2812FX::mode_starburst(void) {
 
   if (!SEGENV.allocateData(dataSize)) return mode_static(); //allocation failed
   
-  uint32_t it = millis();
+  uint32_t it = nowMillis();
   
   star* stars = reinterpret_cast<star*>(SEGENV.data);
   
@@ -2995,10 +3030,11 @@ uint16_t WS2812FX::mode_exploding_fireworks(void)
      */
     int nSparks = flare->pos;
     nSparks = ArduinoConstrain(nSparks, 0, numSparks);
-    static float dying_gravity;
+    float &dying_gravity = flare->vel; //the flare is done, its velocity keeps this per segment
   
     // initialize sparks
     if (SEGENV.aux0 == 2) {
+      dying_gravity = gravity/2;
       for (int i = 1; i < nSparks; i++) { 
         sparks[i].pos = flare->pos; 
         sparks[i].vel = (float(random16(0, 20000)) / 10000.0) - 0.9; // from -0.9 to 1.1
@@ -3009,7 +3045,6 @@ uint16_t WS2812FX::mode_exploding_fireworks(void)
         sparks[i].vel *= -gravity *50;
       } 
       //sparks[1].col = 345; // this will be our known spark 
-      dying_gravity = gravity/2; 
       SEGENV.aux0 = 3;
     }
   
@@ -3203,7 +3238,7 @@ uint16_t WS2812FX::mode_heartbeat(void) {
   bri_lower = bri_lower * 2042 / (2048 + SEGMENT.intensity);
   SEGENV.aux1 = bri_lower;
 
-  unsigned long beatTimer = millis() - SEGENV.step;
+  unsigned long beatTimer = nowMillis() - SEGENV.step;
   if((beatTimer > secondBeat) && !SEGENV.aux0) { // time for the second beat?
     SEGENV.aux1 = UINT16_MAX; //full bri
     SEGENV.aux0 = 1;
@@ -3211,7 +3246,7 @@ uint16_t WS2812FX::mode_heartbeat(void) {
   if(beatTimer > msPerBeat) { // time to reset the beat timer?
     SEGENV.aux1 = UINT16_MAX; //full bri
     SEGENV.aux0 = 0;
-    SEGENV.step = millis();
+    SEGENV.step = nowMillis();
   }
 
   for (uint16_t i = 0; i < SEGLEN; i++) {
@@ -3271,7 +3306,7 @@ uint16_t WS2812FX::mode_pacifica()
   uint16_t sCIStart1 = SEGENV.aux0, sCIStart2 = SEGENV.aux1, sCIStart3 = SEGENV.step, sCIStart4 = SEGENV.step >> 16;
   //static uint16_t sCIStart1, sCIStart2, sCIStart3, sCIStart4;
   //uint32_t deltams = 26 + (SEGMENT.speed >> 3);
-  uint32_t deltams = (FRAMETIME >> 2) + ((FRAMETIME * SEGMENT.speed) >> 7);
+  uint32_t deltams = (FRAMEDELTA >> 2) + ((FRAMEDELTA * SEGMENT.speed) >> 7);
   uint64_t deltat = (now >> 2) + ((now * SEGMENT.speed) >> 7);
   now = deltat;
 
@@ -3361,14 +3396,14 @@ uint16_t WS2812FX::mode_sunrise() {
   //speed 60 - 120 : sunset time in minutes - 60;
   //speed above: "breathing" rise and set
   if (SEGENV.call == 0 || SEGMENT.speed != SEGENV.aux0) {
-	  SEGENV.step = millis(); //save starting time, millis() because now can change from sync
+	  SEGENV.step = nowMillis(); //save starting time, millis() because now can change from sync
     SEGENV.aux0 = SEGMENT.speed;
   }
   
   fill(0);
   uint16_t stage = 0xFFFF;
   
-  uint32_t s10SinceStart = (millis() - SEGENV.step) /100; //tenths of seconds
+  uint32_t s10SinceStart = (nowMillis() - SEGENV.step) /100; //tenths of seconds
   
   if (SEGMENT.speed > 120) { //quick sunrise and sunset
 	  uint16_t counter = (now >> 1) * (((SEGMENT.speed -120) >> 1) +1);
@@ -3409,15 +3444,14 @@ uint16_t WS2812FX::mode_sunrise() {
  */
 uint16_t WS2812FX::phased_base(uint8_t moder) {                  // We're making sine waves here. By Andrew Tuline.
 
+  if (!SEGENV.allocateData(sizeof(float))) return mode_static(); //allocation failed
   uint8_t allfreq = 16;                                          // Base frequency.
-  //float* phasePtr = reinterpret_cast<float*>(SEGENV.step);       // Phase change value gets calculated.
-  static float phase = 0;//phasePtr[0];
+  float &phase = *reinterpret_cast<float*>(SEGENV.data);         // Phase change value gets calculated, kept per segment.
   uint8_t cutOff = (255-SEGMENT.intensity);                      // You can change the number of pixels.  AKA INTENSITY (was 192).
   uint8_t modVal = 5;//SEGMENT.fft1/8+1;                         // You can change the modulus. AKA FFT1 (was 5).
 
   uint8_t index = now/64;                                    // Set color rotation speed
   phase += SEGMENT.speed/32.0;                                   // You can change the speed of the wave. AKA SPEED (was .4)
-  //phasePtr[0] = phase; 
 
   for (int i = 0; i < SEGLEN; i++) {
     if (moder == 1) modVal = (inoise8(i*10 + i*10) /16);         // Let's randomize our mod length with some Perlin noise.
@@ -3472,9 +3506,9 @@ uint16_t WS2812FX::mode_noisepal(void) {                                    // S
   CRGBPalette16* palettes = reinterpret_cast<CRGBPalette16*>(SEGENV.data);
 
   uint16_t changePaletteMs = 4000 + SEGMENT.speed *10; //between 4 - 6.5sec
-  if (millis() - SEGENV.step > changePaletteMs)
+  if (nowMillis() - SEGENV.step > changePaletteMs)
   {
-    SEGENV.step = millis();
+    SEGENV.step = nowMillis();
 
     uint8_t baseI = random8();
     palettes[1] = CRGBPalette16(CHSV(baseI+random8(64), 255, random8(128,255)), CHSV(baseI+128, 255, random8(128,255)), CHSV(baseI+random8(92), 192, random8(128,255)), CHSV(baseI+random8(92), 255, random8(128,255)));
@@ -3493,7 +3527,7 @@ uint16_t WS2812FX::mode_noisepal(void) {                                    // S
     setPixelColor(i, color.red, color.green, color.blue);
   }
 
-  SEGENV.aux0 += beatsin8(10,1,4);                                        // Moving along the distance. Vary it a bit with a sine wave.
+  SEGENV.aux0 += timeScaled(beatsin8(10,1,4));                                        // Moving along the distance. Vary it a bit with a sine wave.
 
   return FRAMETIME;
 }
@@ -3507,7 +3541,7 @@ uint16_t WS2812FX::mode_sinewave(void) {             // Adjustable sinewave. By
 
   uint16_t colorIndex = now /32;//(256 - SEGMENT.fft1);  // Amount of colour change.
 
-  SEGENV.step += SEGMENT.speed/16;                   // Speed of animation.
+  SEGENV.step += timeScaled(SEGMENT.speed/16);       // Speed of animation.
   uint16_t freq = SEGMENT.intensity/4;//SEGMENT.fft2/8;                       // Frequency of the signal.
 
   for (int i=0; i<SEGLEN; i++) {                   // For each of the LED's in the strand, set a brightness based on a wave as follows:
@@ -3616,7 +3650,7 @@ uint16_t WS2812FX::mode_dancing_shadows(void)
 
   fill(BLACK);
 
-  unsigned long time = millis();
+  unsigned long time = nowMillis();
   bool respawn = false;
 
   for (uint8_t i = 0; i < numSpotlights; i++) {
@@ -3720,3 +3754,139 @@ uint16_t WS2812FX::mode_dancing_shadows(void)
 
   return FRAMETIME;
 }
+
+
+/*
+ * Effect registry, indexed by FX_MODE_.
+ * Default palettes: 35 heat, 26 landscape 33, 9 ocean, 20 drywet, 43 blue cyan yellow,
+ * 11 rainbow, 6 party, 4 primary + secondary + tertiary, 0 party colors.
+ * function, mode, default palette, flags, cost, SEGENV.data bytes (cap), SEGENV.data bits per LED,
+ * SEGENV.data bytes on top of the per-LED part (pixelTable() keys, the first of a count of 1 + len/n)
+ */
+constexpr WS2812FX::EffectInfo WS2812FX::_effects[] = {
+  { &WS2812FX::mode_static,                FX_MODE_STATIC,                 0, FX_FLAG_STATIC,                   FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_blink,                 FX_MODE_BLINK,                  0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_breath,                FX_MODE_BREATH,                 0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_color_wipe,            FX_MODE_COLOR_WIPE,             0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_color_wipe_random,     FX_MODE_COLOR_WIPE_RANDOM,      0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_random_color,          FX_MODE_RANDOM_COLOR,           0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_color_sweep,           FX_MODE_COLOR_SWEEP,            0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_dynamic,               FX_MODE_DYNAMIC,                0, 0,                                FX_COST_LOW,    MAX_SEGMENT_DATA,          8 },
+  { &WS2812FX::mode_rainbow,               FX_MODE_RAINBOW,                0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_rainbow_cycle,         FX_MODE_RAINBOW_CYCLE,          0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_scan,                  FX_MODE_SCAN,                   0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_dual_scan,             FX_MODE_DUAL_SCAN,              0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_fade,                  FX_MODE_FADE,                   0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_theater_chase,         FX_MODE_THEATER_CHASE,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_theater_chase_rainbow, FX_MODE_THEATER_CHASE_RAINBOW,  0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_running_lights,        FX_MODE_RUNNING_LIGHTS,         0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_saw,                   FX_MODE_SAW,                    0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_twinkle,               FX_MODE_TWINKLE,                0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_dissolve,              FX_MODE_DISSOLVE,               0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_dissolve_random,       FX_MODE_DISSOLVE_RANDOM,        0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_sparkle,               FX_MODE_SPARKLE,                0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_flash_sparkle,         FX_MODE_FLASH_SPARKLE,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_hyper_sparkle,         FX_MODE_HYPER_SPARKLE,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_strobe,                FX_MODE_STROBE,                 0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_strobe_rainbow,        FX_MODE_STROBE_RAINBOW,         0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_multi_strobe,          FX_MODE_MULTI_STROBE,           0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_blink_rainbow,         FX_MODE_BLINK_RAINBOW,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_android,               FX_MODE_ANDROID,                0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_chase_color,           FX_MODE_CHASE_COLOR,            0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_chase_random,          FX_MODE_CHASE_RANDOM,           0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_chase_rainbow,         FX_MODE_CHASE_RAINBOW,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_chase_flash,           FX_MODE_CHASE_FLASH,            0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_chase_flash_random,    FX_MODE_CHASE_FLASH_RANDOM,     0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_chase_rainbow_white,   FX_MODE_CHASE_RAINBOW_WHITE,    0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_colorful,              FX_MODE_COLORFUL,               0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_traffic_light,         FX_MODE_TRAFFIC_LIGHT,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_color_sweep_random,    FX_MODE_COLOR_SWEEP_RANDOM,     0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_running_color,         FX_MODE_RUNNING_COLOR,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_running_red_blue,      FX_MODE_RUNNING_RED_BLUE,       0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_running_random,        FX_MODE_RUNNING_RANDOM,         0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_larson_scanner,        FX_MODE_LARSON_SCANNER,         0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_comet,                 FX_MODE_COMET,                  0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_fireworks,             FX_MODE_FIREWORKS,              0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_rain,                  FX_MODE_RAIN,                   0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_merry_christmas,       FX_MODE_MERRY_CHRISTMAS,        0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_fire_flicker,          FX_MODE_FIRE_FLICKER,           0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_gradient,              FX_MODE_GRADIENT,               0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_loading,               FX_MODE_LOADING,                0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_police,                FX_MODE_POLICE,                 0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_police_all,            FX_MODE_POLICE_ALL,             0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_two_dots,              FX_MODE_TWO_DOTS,               0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_two_areas,             FX_MODE_TWO_AREAS,              0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_circus_combustus,      FX_MODE_CIRCUS_COMBUSTUS,       0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_halloween,             FX_MODE_HALLOWEEN,              0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_tricolor_chase,        FX_MODE_TRICOLOR_CHASE,         0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_tricolor_wipe,         FX_MODE_TRICOLOR_WIPE,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_tricolor_fade,         FX_MODE_TRICOLOR_FADE,          0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_lightning,             FX_MODE_LIGHTNING,              0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_icu,                   FX_MODE_ICU,                    0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_multi_comet,           FX_MODE_MULTI_COMET,            0, FX_FLAG_PALETTE,                  FX_COST_LOW,    sizeof(uint16_t) * 8,      0 },
+  { &WS2812FX::mode_dual_larson_scanner,   FX_MODE_DUAL_LARSON_SCANNER,    0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_random_chase,          FX_MODE_RANDOM_CHASE,           0, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_oscillate,             FX_MODE_OSCILLATE,              0, 0,                                FX_COST_LOW,    sizeof(oscillator) * 3,    0 },
+  { &WS2812FX::mode_pride_2015,            FX_MODE_PRIDE_2015,             0, 0,                                FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_juggle,                FX_MODE_JUGGLE,                 0, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_palette,               FX_MODE_PALETTE,                0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_fire_2012,             FX_MODE_FIRE_2012,             35, FX_FLAG_PALETTE,                  FX_COST_HIGH,   MAX_SEGMENT_DATA,          8 },
+  { &WS2812FX::mode_colorwaves,            FX_MODE_COLORWAVES,            26, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_bpm,                   FX_MODE_BPM,                    0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_fillnoise8,            FX_MODE_FILLNOISE8,             9, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_noise16_1,             FX_MODE_NOISE16_1,             20, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_noise16_2,             FX_MODE_NOISE16_2,             43, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_noise16_3,             FX_MODE_NOISE16_3,             35, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_noise16_4,             FX_MODE_NOISE16_4,             26, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_colortwinkle,          FX_MODE_COLORTWINKLE,           0, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, MAX_SEGMENT_DATA,          1 },
+  { &WS2812FX::mode_lake,                  FX_MODE_LAKE,                   0, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_meteor,                FX_MODE_METEOR,                 4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, MAX_SEGMENT_DATA,          8 },
+  { &WS2812FX::mode_meteor_smooth,         FX_MODE_METEOR_SMOOTH,          4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, MAX_SEGMENT_DATA,          8 },
+  { &WS2812FX::mode_railway,               FX_MODE_RAILWAY,                4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_ripple,                FX_MODE_RIPPLE,                 4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, sizeof(ripple) * 100,      sizeof(ripple) * 2, sizeof(ripple) },
+  { &WS2812FX::mode_twinklefox,            FX_MODE_TWINKLEFOX,             4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, MAX_SEGMENT_DATA,          32, sizeof(uint32_t) },
+  { &WS2812FX::mode_twinklecat,            FX_MODE_TWINKLECAT,             4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, MAX_SEGMENT_DATA,          32, sizeof(uint32_t) },
+  { &WS2812FX::mode_halloween_eyes,        FX_MODE_HALLOWEEN_EYES,         4, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_static_pattern,        FX_MODE_STATIC_PATTERN,         4, FX_FLAG_PALETTE | FX_FLAG_STATIC, FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_tri_static_pattern,    FX_MODE_TRI_STATIC_PATTERN,     4, FX_FLAG_STATIC,                   FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_spots,                 FX_MODE_SPOTS,                  4, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_spots_fade,            FX_MODE_SPOTS_FADE,             4, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_glitter,               FX_MODE_GLITTER,               11, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_candle,                FX_MODE_CANDLE,                 4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_starburst,             FX_MODE_STARBURST,              4, 0,                                FX_COST_MEDIUM, sizeof(star) * 15,         sizeof(star), sizeof(star) },
+  { &WS2812FX::mode_exploding_fireworks,   FX_MODE_EXPLODING_FIREWORKS,    4, 0,                                FX_COST_MEDIUM, sizeof(spark) * 80,        sizeof(spark) * 4, sizeof(spark) * 2 },
+  { &WS2812FX::mode_bouncing_balls,        FX_MODE_BOUNCINGBALLS,          4, 0,                                FX_COST_LOW,    sizeof(ball) * 16,         0 },
+  { &WS2812FX::mode_sinelon,               FX_MODE_SINELON,                4, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_sinelon_dual,          FX_MODE_SINELON_DUAL,           4, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_sinelon_rainbow,       FX_MODE_SINELON_RAINBOW,        4, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_popcorn,               FX_MODE_POPCORN,                4, 0,                                FX_COST_LOW,    sizeof(spark) * 24,        0 },
+  { &WS2812FX::mode_drip,                  FX_MODE_DRIP,                   4, 0,                                FX_COST_LOW,    sizeof(spark) * 4,         0 },
+  { &WS2812FX::mode_plasma,                FX_MODE_PLASMA,                 4, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_percent,               FX_MODE_PERCENT,                4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_ripple_rainbow,        FX_MODE_RIPPLE_RAINBOW,         4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, sizeof(ripple) * 100,      sizeof(ripple) * 2, sizeof(ripple) },
+  { &WS2812FX::mode_heartbeat,             FX_MODE_HEARTBEAT,              4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_pacifica,              FX_MODE_PACIFICA,               4, FX_FLAG_PALETTE,                  FX_COST_HIGH,   0,                         0 },
+  { &WS2812FX::mode_candle_multi,          FX_MODE_CANDLE_MULTI,           4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, MAX_SEGMENT_DATA,          48, sizeof(uint32_t) },
+  { &WS2812FX::mode_solid_glitter,         FX_MODE_SOLID_GLITTER,          4, 0,                                FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_sunrise,               FX_MODE_SUNRISE,               35, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_phased,                FX_MODE_PHASED,                 4, FX_FLAG_PALETTE,                  FX_COST_HIGH,   sizeof(float),             0 },
+  { &WS2812FX::mode_twinkleup,             FX_MODE_TWINKLEUP,              4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_noisepal,              FX_MODE_NOISEPAL,               4, FX_FLAG_PALETTE,                  FX_COST_HIGH,   sizeof(CRGBPalette16) * 2, 0 },
+  { &WS2812FX::mode_sinewave,              FX_MODE_SINEWAVE,               4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_phased_noise,          FX_MODE_PHASEDNOISE,            4, FX_FLAG_PALETTE,                  FX_COST_HIGH,   sizeof(float),             0 },
+  { &WS2812FX::mode_flow,                  FX_MODE_FLOW,                   6, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, 0,                         0 },
+  { &WS2812FX::mode_chunchun,              FX_MODE_CHUNCHUN,               4, FX_FLAG_PALETTE,                  FX_COST_LOW,    0,                         0 },
+  { &WS2812FX::mode_dancing_shadows,       FX_MODE_DANCING_SHADOWS,        4, FX_FLAG_PALETTE,                  FX_COST_MEDIUM, sizeof(spotlight) * 50,    0 },
+};
+
+constexpr bool WS2812FX::effectsInOrder(uint8_t i)
+{
+  return (i == MODE_COUNT) || (_effects[i].id == i && effectsInOrder(i + 1));
+}
+
+const WS2812FX::EffectInfo& WS2812FX::getEffect(uint8_t m) {
+  static_assert(sizeof(_effects) / sizeof(_effects[0]) == MODE_COUNT, "one registry entry per mode");
+  static_assert(effectsInOrder(0), "registry entries must be in FX_MODE_ order");
+  if (m >= MODE_COUNT) m = MODE_COUNT - 1;
+  return _effects[m];
+}
@@ -60,12 +60,18 @@ typedef uint8_t byte;
 
 uint32_t getColorCode(const CRGB &c);
 
-/* Not used in all effects yet */
+/* Default segment frame rate; effect speeds are tuned for this rate */
 #define FX_FPS         42
-#define FRAMETIME        (1000/FX_FPS)
-
-/* each segment uses 52 bytes of SRAM memory, so if you're application fails because of
-  insufficient memory, decreasing MAX_NUM_SEGMENTS may help */
+#define FRAMETIME_FIXED  (1000/FX_FPS)
+/* Frame time of the segment being serviced, see Segment::fps */
+#define FRAMETIME        _frameTime
+/* Milliseconds elapsed since the segment being serviced last ran its effect */
+#define FRAMEDELTA       _frameDelta
+/* Upper bound for FRAMEDELTA, so a frozen or starved segment does not jump ahead */
+#define MAX_FRAME_DELTA  250
+
+/* each segment uses 60 bytes of SRAM memory, plus 32 per cached effect state, so if you're
+  application fails because of insufficient memory, decreasing MAX_NUM_SEGMENTS may help */
 #define MAX_NUM_SEGMENTS 10
 
 /* How much data bytes all segments combined may allocate */
@@ -75,6 +81,13 @@ uint32_t getColorCode(const CRGB &c);
 #define MAX_SEGMENT_DATA 8192
 #endif
 
+/* How many suspended effect states each segment keeps, so switching back to a recent mode
+  resumes it instead of starting over. Their data counts against MAX_SEGMENT_DATA, the least
+  recently used state is dropped when an effect needs the room. 0 disables the cache */
+#ifndef MAX_CACHED_EFFECTS
+#define MAX_CACHED_EFFECTS 2
+#endif
+
 #define LED_SKIP_AMOUNT  1
 #define MIN_SHOW_DELAY  15
 
@@ -103,13 +116,15 @@ uint32_t getColorCode(const CRGB &c);
 
 // options
 // bit    7: segment is in transition mode
-// bits 4-6: TBD
+// bit    6: rows of a 2D segment run back and forth
+// bits 4-5: TBD
 // bit    3: mirror effect within segment
 // bit    2: segment is on
 // bit    1: reverse segment
 // bit    0: segment is selected
 #define NO_OPTIONS   (uint8_t)0x00
 #define TRANSITIONAL (uint8_t)0x80
+#define SERPENTINE   (uint8_t)0x40
 #define MIRROR       (uint8_t)0x08
 #define SEGMENT_ON   (uint8_t)0x04
 #define REVERSE      (uint8_t)0x02
@@ -119,6 +134,7 @@ uint32_t getColorCode(const CRGB &c);
 #define IS_SEGMENT_ON   ((SEGMENT.options & SEGMENT_ON  ) == SEGMENT_ON  )
 #define IS_REVERSE      ((SEGMENT.options & REVERSE     ) == REVERSE     )
 #define IS_SELECTED     ((SEGMENT.options & SELECTED    ) == SELECTED    )
+#define IS_SERPENTINE   ((SEGMENT.options & SERPENTINE  ) == SERPENTINE  )
 
 #define MODE_COUNT  113
 
@@ -236,6 +252,15 @@ uint32_t getColorCode(const CRGB &c);
 #define FX_MODE_CHUNCHUN               111
 #define FX_MODE_DANCING_SHADOWS        112
 
+// effect registry flags
+#define FX_FLAG_PALETTE   0x01 //effect colors come from the segment palette
+#define FX_FLAG_STATIC    0x02 //output only changes when the segment settings change
+
+// effect registry cost classes, rough per-frame CPU time per LED
+#define FX_COST_LOW       0 //fills and a few pixels per frame
+#define FX_COST_MEDIUM    1 //palette lookup or blend for every LED
+#define FX_COST_HIGH      2 //noise, trig or float math for every LED
+
 class WS2812FX {
   typedef uint16_t (WS2812FX::*mode_ptr)(void);
 
@@ -244,7 +269,7 @@ class WS2812FX {
   
   // segment parameters
   public:
-    typedef struct Segment { // 24 bytes
+    typedef struct Segment { // 28 bytes
       uint16_t start;
       uint16_t stop; //segment invalid if stop == 0
       uint8_t speed;
@@ -254,6 +279,8 @@ class WS2812FX {
       uint8_t options; //bit pattern: msb first: transitional needspixelstate tbd tbd (paused) on reverse selected
       uint8_t grouping, spacing;
       uint8_t opacity;
+      uint8_t fps; //target frame rate of the effect, 0 = FX_FPS
+      uint8_t width, height; //matrix of a 2D segment, rows laid out from start; 0 for 1D, see setSegment2D()
       uint32_t colors[NUM_COLORS];
       void setOption(uint8_t n, bool val)
       {
@@ -284,8 +311,25 @@ class WS2812FX {
       {
         return grouping + spacing;
       }
+      uint16_t frameTime()
+      {
+        return 1000 / (fps ? fps : FX_FPS);
+      }
+      bool is2D()
+      {
+        return width && height;
+      }
+      uint16_t virtualWidth()
+      {
+        return is2D() ? width : virtualLength();
+      }
+      uint16_t virtualHeight()
+      {
+        return is2D() ? height : 1;
+      }
       uint16_t virtualLength()
       {
+        if (is2D()) return width * height;
         uint16_t groupLen = groupLength();
         uint16_t vLength = (length() + groupLen - 1) / groupLen;
         if (options & MIRROR)
@@ -294,13 +338,31 @@ class WS2812FX {
       }
     } segment;
 
+  // runtime of an effect suspended by setMode(), see MAX_CACHED_EFFECTS
+    typedef struct Effect_state { // 32 bytes
+      uint32_t used = 0; // last use, for evicting the least recently used state; 0 when the slot is free
+      unsigned long last_time;
+      uint32_t step;
+      uint32_t call;
+      uint16_t aux0;
+      uint16_t aux1;
+      uint16_t rotation;
+      uint16_t substep;
+      uint8_t * data = nullptr; // still counted in _usedSegmentData
+      uint16_t dataLen = 0;
+      uint8_t mode;
+    } effect_state;
+
   // segment runtime parameters
-    typedef struct Segment_runtime { // 28 bytes
+    typedef struct Segment_runtime { // 32 bytes
       unsigned long next_time;
+      unsigned long last_time; // when the effect last ran, for FRAMEDELTA
       uint32_t step;
       uint32_t call;
       uint16_t aux0;
       uint16_t aux1;
+      uint16_t rotation; // pending scroll of the segment content, see WS2812FX::scroll()
+      uint16_t substep; // sub-step remainder carried by WS2812FX::timeScaled()
        // what is data? patterns often want a byte of per-pixel data, although they don't need it
       uint8_t * data = nullptr;
       bool allocateData(uint16_t len){
@@ -309,139 +371,61 @@ class WS2812FX {
         if (WS2812FX::_usedSegmentData + len > MAX_SEGMENT_DATA) return false; //not enough memory
         data = (uint8_t *) malloc((size_t)len); // don't need nothrow, really
         if (!data) return false; //allocation failed
+        FASTLED_ALLOC_NOTE("segment data", len);
         WS2812FX::_usedSegmentData += len;
         _dataLen = len;
         memset(data, 0, len);
         return true;
       }
       void deallocateData(){
-        delete[] data;
+        free(data);
         data = nullptr;
         WS2812FX::_usedSegmentData -= _dataLen;
         _dataLen = 0;
       }
-      void reset(){next_time = 0; step = 0; call = 0; aux0 = 0; aux1 = 0; deallocateData();}
+      void reset(){next_time = 0; last_time = 0; step = 0; call = 0; aux0 = 0; aux1 = 0; rotation = 0; substep = 0; deallocateData();}
+      // hand the effect's state and data block over to s, and start afresh
+      void suspend(effect_state &s){
+        s.last_time = last_time; s.step = step; s.call = call; s.aux0 = aux0; s.aux1 = aux1;
+        s.rotation = rotation; s.substep = substep; s.data = data; s.dataLen = _dataLen;
+        data = nullptr; _dataLen = 0;
+        reset();
+      }
+      // take a suspended state back, without allocating
+      void resume(effect_state &s){
+        reset();
+        last_time = s.last_time; step = s.step; call = s.call; aux0 = s.aux0; aux1 = s.aux1;
+        rotation = s.rotation; substep = s.substep; data = s.data; _dataLen = s.dataLen;
+        s.data = nullptr; s.dataLen = 0;
+      }
+
+      uint16_t dataLen() const { return _dataLen; }
 
       private:
         uint16_t _dataLen = 0;
     } segment_runtime;
 
-    WS2812FX() {
-      //assign each member of the _mode[] array to its respective function reference 
-      _mode[FX_MODE_STATIC]                  = &WS2812FX::mode_static;
-      _mode[FX_MODE_BLINK]                   = &WS2812FX::mode_blink;
-      _mode[FX_MODE_COLOR_WIPE]              = &WS2812FX::mode_color_wipe;
-      _mode[FX_MODE_COLOR_WIPE_RANDOM]       = &WS2812FX::mode_color_wipe_random;
-      _mode[FX_MODE_RANDOM_COLOR]            = &WS2812FX::mode_random_color;
-      _mode[FX_MODE_COLOR_SWEEP]             = &WS2812FX::mode_color_sweep;
-      _mode[FX_MODE_DYNAMIC]                 = &WS2812FX::mode_dynamic;
-      _mode[FX_MODE_RAINBOW]                 = &WS2812FX::mode_rainbow;
-      _mode[FX_MODE_RAINBOW_CYCLE]           = &WS2812FX::mode_rainbow_cycle;
-      _mode[FX_MODE_SCAN]                    = &WS2812FX::mode_scan;
-      _mode[FX_MODE_DUAL_SCAN]               = &WS2812FX::mode_dual_scan;
-      _mode[FX_MODE_FADE]                    = &WS2812FX::mode_fade;
-      _mode[FX_MODE_THEATER_CHASE]           = &WS2812FX::mode_theater_chase;
-      _mode[FX_MODE_THEATER_CHASE_RAINBOW]   = &WS2812FX::mode_theater_chase_rainbow;
-      _mode[FX_MODE_SAW]                     = &WS2812FX::mode_saw;
-      _mode[FX_MODE_TWINKLE]                 = &WS2812FX::mode_twinkle;
-      _mode[FX_MODE_DISSOLVE]                = &WS2812FX::mode_dissolve;
-      _mode[FX_MODE_DISSOLVE_RANDOM]         = &WS2812FX::mode_dissolve_random;
-      _mode[FX_MODE_SPARKLE]                 = &WS2812FX::mode_sparkle;
-      _mode[FX_MODE_FLASH_SPARKLE]           = &WS2812FX::mode_flash_sparkle;
-      _mode[FX_MODE_HYPER_SPARKLE]           = &WS2812FX::mode_hyper_sparkle;
-      _mode[FX_MODE_STROBE]                  = &WS2812FX::mode_strobe;
-      _mode[FX_MODE_STROBE_RAINBOW]          = &WS2812FX::mode_strobe_rainbow;
-      _mode[FX_MODE_MULTI_STROBE]            = &WS2812FX::mode_multi_strobe;
-      _mode[FX_MODE_BLINK_RAINBOW]           = &WS2812FX::mode_blink_rainbow;
-      _mode[FX_MODE_ANDROID]                 = &WS2812FX::mode_android;
-      _mode[FX_MODE_CHASE_COLOR]             = &WS2812FX::mode_chase_color;
-      _mode[FX_MODE_CHASE_RANDOM]            = &WS2812FX::mode_chase_random;
-      _mode[FX_MODE_CHASE_RAINBOW]           = &WS2812FX::mode_chase_rainbow;
-      _mode[FX_MODE_CHASE_FLASH]             = &WS2812FX::mode_chase_flash;
-      _mode[FX_MODE_CHASE_FLASH_RANDOM]      = &WS2812FX::mode_chase_flash_random;
-      _mode[FX_MODE_CHASE_RAINBOW_WHITE]     = &WS2812FX::mode_chase_rainbow_white;
-      _mode[FX_MODE_COLORFUL]                = &WS2812FX::mode_colorful;
-      _mode[FX_MODE_TRAFFIC_LIGHT]           = &WS2812FX::mode_traffic_light;
-      _mode[FX_MODE_COLOR_SWEEP_RANDOM]      = &WS2812FX::mode_color_sweep_random;
-      _mode[FX_MODE_RUNNING_COLOR]           = &WS2812FX::mode_running_color;
-      _mode[FX_MODE_RUNNING_RED_BLUE]        = &WS2812FX::mode_running_red_blue;
-      _mode[FX_MODE_RUNNING_RANDOM]          = &WS2812FX::mode_running_random;
-      _mode[FX_MODE_LARSON_SCANNER]          = &WS2812FX::mode_larson_scanner;
-      _mode[FX_MODE_COMET]                   = &WS2812FX::mode_comet;
-      _mode[FX_MODE_FIREWORKS]               = &WS2812FX::mode_fireworks;
-      _mode[FX_MODE_RAIN]                    = &WS2812FX::mode_rain;
-      _mode[FX_MODE_MERRY_CHRISTMAS]         = &WS2812FX::mode_merry_christmas;
-      _mode[FX_MODE_FIRE_FLICKER]            = &WS2812FX::mode_fire_flicker;
-      _mode[FX_MODE_GRADIENT]                = &WS2812FX::mode_gradient;
-      _mode[FX_MODE_LOADING]                 = &WS2812FX::mode_loading;
-      _mode[FX_MODE_POLICE]                  = &WS2812FX::mode_police;
-      _mode[FX_MODE_POLICE_ALL]              = &WS2812FX::mode_police_all;
-      _mode[FX_MODE_TWO_DOTS]                = &WS2812FX::mode_two_dots;
-      _mode[FX_MODE_TWO_AREAS]               = &WS2812FX::mode_two_areas;
-      _mode[FX_MODE_CIRCUS_COMBUSTUS]        = &WS2812FX::mode_circus_combustus;
-      _mode[FX_MODE_HALLOWEEN]               = &WS2812FX::mode_halloween;
-      _mode[FX_MODE_TRICOLOR_CHASE]          = &WS2812FX::mode_tricolor_chase;
-      _mode[FX_MODE_TRICOLOR_WIPE]           = &WS2812FX::mode_tricolor_wipe;
-      _mode[FX_MODE_TRICOLOR_FADE]           = &WS2812FX::mode_tricolor_fade;
-      _mode[FX_MODE_BREATH]                  = &WS2812FX::mode_breath;
-      _mode[FX_MODE_RUNNING_LIGHTS]          = &WS2812FX::mode_running_lights;
-      _mode[FX_MODE_LIGHTNING]               = &WS2812FX::mode_lightning;
-      _mode[FX_MODE_ICU]                     = &WS2812FX::mode_icu;
-      _mode[FX_MODE_MULTI_COMET]             = &WS2812FX::mode_multi_comet;
-      _mode[FX_MODE_DUAL_LARSON_SCANNER]     = &WS2812FX::mode_dual_larson_scanner;
-      _mode[FX_MODE_RANDOM_CHASE]            = &WS2812FX::mode_random_chase;
-      _mode[FX_MODE_OSCILLATE]               = &WS2812FX::mode_oscillate;
-      _mode[FX_MODE_FIRE_2012]               = &WS2812FX::mode_fire_2012;
-      _mode[FX_MODE_PRIDE_2015]              = &WS2812FX::mode_pride_2015;
-      _mode[FX_MODE_BPM]                     = &WS2812FX::mode_bpm;
-      _mode[FX_MODE_JUGGLE]                  = &WS2812FX::mode_juggle;
-      _mode[FX_MODE_PALETTE]                 = &WS2812FX::mode_palette;
-      _mode[FX_MODE_COLORWAVES]              = &WS2812FX::mode_colorwaves;
-      _mode[FX_MODE_FILLNOISE8]              = &WS2812FX::mode_fillnoise8;
-      _mode[FX_MODE_NOISE16_1]               = &WS2812FX::mode_noise16_1;
-      _mode[FX_MODE_NOISE16_2]               = &WS2812FX::mode_noise16_2;
-      _mode[FX_MODE_NOISE16_3]               = &WS2812FX::mode_noise16_3;
-      _mode[FX_MODE_NOISE16_4]               = &WS2812FX::mode_noise16_4;
-      _mode[FX_MODE_COLORTWINKLE]            = &WS2812FX::mode_colortwinkle;
-      _mode[FX_MODE_LAKE]                    = &WS2812FX::mode_lake;
-      _mode[FX_MODE_METEOR]                  = &WS2812FX::mode_meteor;
-      _mode[FX_MODE_METEOR_SMOOTH]           = &WS2812FX::mode_meteor_smooth;
-      _mode[FX_MODE_RAILWAY]                 = &WS2812FX::mode_railway;
-      _mode[FX_MODE_RIPPLE]                  = &WS2812FX::mode_ripple;
-      _mode[FX_MODE_TWINKLEFOX]              = &WS2812FX::mode_twinklefox;
-      _mode[FX_MODE_TWINKLECAT]              = &WS2812FX::mode_twinklecat;
-      _mode[FX_MODE_HALLOWEEN_EYES]          = &WS2812FX::mode_halloween_eyes;
-      _mode[FX_MODE_STATIC_PATTERN]          = &WS2812FX::mode_static_pattern;
-      _mode[FX_MODE_TRI_STATIC_PATTERN]      = &WS2812FX::mode_tri_static_pattern;
-      _mode[FX_MODE_SPOTS]                   = &WS2812FX::mode_spots;
-      _mode[FX_MODE_SPOTS_FADE]              = &WS2812FX::mode_spots_fade;
-      _mode[FX_MODE_GLITTER]                 = &WS2812FX::mode_glitter;
-      _mode[FX_MODE_CANDLE]                  = &WS2812FX::mode_candle;
-      _mode[FX_MODE_STARBURST]               = &WS2812FX::mode_starburst;
-      _mode[FX_MODE_EXPLODING_FIREWORKS]     = &WS2812FX::mode_exploding_fireworks;
-      _mode[FX_MODE_BOUNCINGBALLS]           = &WS2812FX::mode_bouncing_balls;
-      _mode[FX_MODE_SINELON]                 = &WS2812FX::mode_sinelon;
-      _mode[FX_MODE_SINELON_DUAL]            = &WS2812FX::mode_sinelon_dual;
-      _mode[FX_MODE_SINELON_RAINBOW]         = &WS2812FX::mode_sinelon_rainbow;
-      _mode[FX_MODE_POPCORN]                 = &WS2812FX::mode_popcorn;
-      _mode[FX_MODE_DRIP]                    = &WS2812FX::mode_drip;
-      _mode[FX_MODE_PLASMA]                  = &WS2812FX::mode_plasma;
-      _mode[FX_MODE_PERCENT]                 = &WS2812FX::mode_percent;
-      _mode[FX_MODE_RIPPLE_RAINBOW]          = &WS2812FX::mode_ripple_rainbow;
-      _mode[FX_MODE_HEARTBEAT]               = &WS2812FX::mode_heartbeat;
-      _mode[FX_MODE_PACIFICA]                = &WS2812FX::mode_pacifica;
-      _mode[FX_MODE_CANDLE_MULTI]            = &WS2812FX::mode_candle_multi;
-      _mode[FX_MODE_SOLID_GLITTER]           = &WS2812FX::mode_solid_glitter;
-      _mode[FX_MODE_SUNRISE]                 = &WS2812FX::mode_sunrise;
-      _mode[FX_MODE_PHASED]                  = &WS2812FX::mode_phased;
-      _mode[FX_MODE_TWINKLEUP]               = &WS2812FX::mode_twinkleup;
-      _mode[FX_MODE_NOISEPAL]                = &WS2812FX::mode_noisepal;
-      _mode[FX_MODE_SINEWAVE]                = &WS2812FX::mode_sinewave;
-      _mode[FX_MODE_PHASEDNOISE]             = &WS2812FX::mode_phased_noise;
-      _mode[FX_MODE_FLOW]                    = &WS2812FX::mode_flow;
-      _mode[FX_MODE_CHUNCHUN]                = &WS2812FX::mode_chunchun;
-      _mode[FX_MODE_DANCING_SHADOWS]         = &WS2812FX::mode_dancing_shadows;
+  // effect registry entry, constant for each mode
+    typedef struct EffectInfo {
+      mode_ptr fn;
+      uint16_t dataSize; //bytes of SEGENV.data the effect allocates, the cap if dataBitsPerLed is set
+      uint8_t id; //FX_MODE_ index, the table order is checked at compile time
+      uint8_t palette; //palette used while the segment palette is 0 (default)
+      uint8_t flags; //FX_FLAG_ bit pattern
+      uint8_t cost; //FX_COST_ class
+      uint8_t dataBitsPerLed; //SEGENV.data that scales with the segment length
+      uint16_t dataBase; //bytes on top of the per-led part, whatever the length
+      constexpr EffectInfo(mode_ptr f, uint8_t i, uint8_t pal, uint8_t fl, uint8_t c, uint16_t size, uint8_t bits, uint16_t base = 0)
+        : fn(f), dataSize(size), id(i), palette(pal), flags(fl), cost(c), dataBitsPerLed(bits), dataBase(base) {}
+      uint16_t dataFor(uint16_t len) const
+      {
+        if (!dataBitsPerLed) return dataSize;
+        uint32_t bytes = dataBase + (((uint32_t)len * dataBitsPerLed + 7) >> 3);
+        return (bytes < dataSize) ? bytes : dataSize;
+      }
+    } effect_info;
 
+    WS2812FX() {
       _brightness = DEFAULT_BRIGHTNESS;
       currentPalette = CRGBPalette16(CRGB::Black);
       targetPalette = CloudColors_p;
@@ -452,11 +436,19 @@ class WS2812FX {
       resetSegments();
     }
 
+    ~WS2812FX() { //hand the segment data back, instances rendering offline come and go
+      for (uint8_t i = 0; i < MAX_NUM_SEGMENTS; i++) {
+        _segment_runtimes[i].reset();
+        flushEffectCache(i);
+      }
+    }
+
     void
       init(uint16_t countPixels, CRGB *leds, bool skipFirst),
       service(void),
       blur(uint8_t),
       fill(uint32_t),
+      scroll(uint16_t steps),
       fade_out(uint8_t r),
       setMode(uint8_t segid, uint8_t m),
       setColor(uint8_t slot, uint8_t r, uint8_t g, uint8_t b),
@@ -467,18 +459,25 @@ class WS2812FX {
       setTransitionMode(bool t),
       trigger(void),
       setSegment(uint8_t n, uint16_t start, uint16_t stop, uint8_t grouping = 0, uint8_t spacing = 0),
+      setSegment2D(uint8_t n, uint16_t start, uint8_t width, uint8_t height, bool serpentine = false),
       resetSegments(),
       setPixelColor(uint16_t n, uint32_t c),
       setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b),
+      setPixelColorXY(uint16_t x, uint16_t y, uint32_t c),
+      setPixelColorXY(uint16_t x, uint16_t y, uint8_t r, uint8_t g, uint8_t b),
       show(void),
       setRgbwPwm(void),
-      setPixelSegment(uint8_t n);
+      setPixelSegment(uint8_t n),
+      setVirtualClock(uint32_t ms, uint16_t seed = 1337),
+      advanceClock(uint32_t ms),
+      useRealClock(void);
 
     bool
       reverseMode = false,      //is the entire LED strip reversed?
       gammaCorrectBri = false,
       gammaCorrectCol = true,
       applyToAllSelected = true,
+      renderShared = true,      //run the effect once for identical segments, see copySegment()
       segmentsAreIdentical(Segment* a, Segment* b),
       setEffectConfig(uint8_t m, uint8_t s, uint8_t i, uint8_t p);
 
@@ -489,6 +488,7 @@ class WS2812FX {
       colorOrder = 0,
       milliampsPerLed = 55,
       getBrightness(void),
+      getShowBrightness(void),
       getMode(void),
       getSpeed(void),
       getModeCount(void),
@@ -513,13 +513,18 @@ class WS2812FX {
       gamma32(uint32_t),
       getLastShow(void),
       getPixelColor(uint16_t),
+      getPixelColorXY(uint16_t x, uint16_t y),
       getColor(void);
 
     WS2812FX::Segment&
       getSegment(uint8_t n);
 
+    static const WS2812FX::EffectInfo&
+      getEffect(uint8_t m);
+
     WS2812FX::Segment_runtime
-      getSegmentRuntime(void);
+      getSegmentRuntime(void),
+      getSegmentRuntime(uint8_t n);
 
     WS2812FX::Segment*
       getSegments(void);
@@ -650,18 +655,20 @@ class WS2812FX {
 
     CRGB     *_leds;
     uint16_t _length, _lengthRaw, _virtualSegmentLength;
+    uint16_t _frameTime = FRAMETIME_FIXED, _frameDelta = FRAMETIME_FIXED;
     uint16_t _rand16seed;
     uint8_t _brightness;
-    static uint16_t _usedSegmentData;
+    static FASTLED_THREAD_LOCAL uint16_t _usedSegmentData;
 
     void load_gradient_palette(uint8_t);
     void handle_palette(void);
 
     bool
-      _skipFirstMode,
-      _triggered;
+      _skipFirstMode = false,
+      _triggered = false;
 
-    mode_ptr _mode[MODE_COUNT]; // SRAM footprint: 4 bytes per element
+    static const effect_info _effects[]; // in flash, one entry per mode, see FX.cpp
+    static constexpr bool effectsInOrder(uint8_t i);
 
     show_callback _callback = nullptr;
 
@@ -693,18 +700,43 @@ class WS2812FX {
     
     uint32_t _lastPaletteChange = 0;
     uint32_t _lastShow = 0;
+
+    // virtual clock, lets this instance render frames faster than real time and
+    // reproducibly, see setVirtualClock()
+    bool _virtualClock = false;
+    uint32_t _virtualNow = 0;
+    uint8_t _showBrightness = 0; //brightness of the last frame, after the current limit
+    inline uint32_t nowMillis(void) { return _virtualClock ? _virtualNow : millis(); }
     
     uint8_t _segment_index = 0;
     uint8_t _segment_index_palette_last = 99;
     segment _segments[MAX_NUM_SEGMENTS] = { 
-      // SRAM footprint: 24 bytes per element
-      // start, stop, speed, intensity, palette, mode, options, grouping, spacing, opacity (unused), color[]
-      { 0, 7, DEFAULT_SPEED, 128, 0, DEFAULT_MODE, NO_OPTIONS, 1, 0, 255, {DEFAULT_COLOR}}
+      // SRAM footprint: 28 bytes per element
+      // start, stop, speed, intensity, palette, mode, options, grouping, spacing, opacity (unused), fps, width, height, color[]
+      { 0, 7, DEFAULT_SPEED, 128, 0, DEFAULT_MODE, NO_OPTIONS, 1, 0, 255, 0, 0, 0, {DEFAULT_COLOR}}
     };
-    segment_runtime _segment_runtimes[MAX_NUM_SEGMENTS]; // SRAM footprint: 28 bytes per element
+    segment_runtime _segment_runtimes[MAX_NUM_SEGMENTS]; // SRAM footprint: 32 bytes per element
     friend class Segment_runtime;
 
+#if MAX_CACHED_EFFECTS
+    effect_state _effectCache[MAX_NUM_SEGMENTS][MAX_CACHED_EFFECTS]; // SRAM footprint: 32 bytes per element
+    uint32_t _effectCacheClock = 0;
+
+    void suspendEffect(uint8_t segid);
+    bool resumeEffect(uint8_t segid, uint8_t m);
+    void dropEffectState(effect_state& s);
+    void makeRoomForData(uint16_t len);
+#endif
+    void flushEffectCache(uint8_t segid);
+
     uint16_t realPixelIndex(uint16_t i);
+    uint16_t virtualIndexXY(uint16_t x, uint16_t y);
+    void setPixelGroup(uint16_t i, CRGB col);
+    uint8_t sharedSource(uint8_t n);
+    void copySegment(uint8_t src, uint8_t dst);
+    void applyScroll(void);
+    uint32_t timeScaled(uint32_t perFrame);
+    uint8_t* pixelTable(uint16_t stateBytes, uint8_t bytesPerLed, uint32_t key, bool &fill);
 };
 
 //10 names per line
@@ -740,6 +772,7 @@ const char JSON_palette_names[]  = R"=====([
 #define SEG_OPTION_MIRROR         3            //Indicates that the effect will be mirrored within the segment
 #define SEG_OPTION_NONUNITY       4            //Indicates that the effect does not use FRAMETIME or needs getPixelColor
 #define SEG_OPTION_FREEZE         5            //Segment contents will not be refreshed
+#define SEG_OPTION_SERPENTINE     6            //Odd rows of a 2D segment run right to left
 #define SEG_OPTION_TRANSITIONAL   7
 
 
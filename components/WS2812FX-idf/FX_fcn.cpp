@@ -44,6 +44,20 @@ const uint16_t customMappingTable[] = {
 const uint16_t customMappingSize = sizeof(customMappingTable)/sizeof(uint16_t); //30 in example
 #endif
 
+//the virtual clock of the instance this task is servicing, if it runs on one (see service())
+static FASTLED_THREAD_LOCAL const uint32_t *_servicedClock = nullptr;
+
+/*
+ * The millisecond timer of FastLED's beat and EVERY_N_MILLIS helpers (FX.h sets
+ * USE_GET_MILLISECOND_TIMER), so effects using them follow the instance's virtual clock.
+ */
+FASTLED_NAMESPACE_BEGIN
+uint32_t get_millisecond_timer()
+{
+  return _servicedClock ? *_servicedClock : millis();
+}
+FASTLED_NAMESPACE_END
+
 void WS2812FX::init( uint16_t countPixels, CRGB *leds, bool skipFirst)
 {
   if ( countPixels == _length && _skipFirstMode == skipFirst) return;
@@ -64,26 +78,46 @@ void WS2812FX::init( uint16_t countPixels, CRGB *leds, bool skipFirst)
 }
 
 void WS2812FX::service() {
-  uint32_t nowUp = millis(); // Be aware, millis() rolls over every 49 days
+  uint32_t nowUp = nowMillis(); // Be aware, millis() rolls over every 49 days
   now = nowUp + timebase;
   if (nowUp - _lastShow < MIN_SHOW_DELAY) return;
   bool doShow = false;
+  const uint32_t *servicedBefore = _servicedClock;
+  if (_virtualClock) {
+    random16_set_seed(_rand16seed); //every instance keeps its own random sequence
+    _servicedClock = &_virtualNow;
+  }
 
   for(uint8_t i=0; i < MAX_NUM_SEGMENTS; i++)
   {
     _segment_index = i;
     if (SEGMENT.isActive())
     {
+      if (SEGMENT.grouping == 0) SEGMENT.grouping = 1; //sanity check
+      if (renderShared && sharedSource(i) != i) continue; //drawn by the segment it is identical to
       if(nowUp > SEGENV.next_time || _triggered || (doShow && SEGMENT.mode == 0)) //last is temporary
       {
-        if (SEGMENT.grouping == 0) SEGMENT.grouping = 1; //sanity check
         doShow = true;
+        _frameTime = SEGMENT.frameTime();
         uint16_t delay = FRAMETIME;
 
         if (!SEGMENT.getOption(SEG_OPTION_FREEZE)) { //only run effect function if not frozen
           _virtualSegmentLength = SEGMENT.virtualLength();
+          //time since the last frame of this segment, so effects advance by time rather than per call
+          uint32_t maxDelta = (_frameTime > MAX_FRAME_DELTA) ? _frameTime : MAX_FRAME_DELTA;
+          uint32_t delta = SEGENV.call ? nowUp - SEGENV.last_time : _frameTime;
+          _frameDelta = (delta > maxDelta) ? maxDelta : delta;
+          SEGENV.last_time = nowUp;
           handle_palette();
-          delay = (this->*_mode[SEGMENT.mode])(); //effect function
+          delay = (this->*_effects[SEGMENT.mode].fn)(); //effect function
+          if (SEGENV.rotation) applyScroll(); //effect scrolled, move the pixels once for this frame
+          if (renderShared) {
+            for (uint8_t j = i +1; j < MAX_NUM_SEGMENTS; j++) {
+              if (_segments[j].isActive() && sharedSource(j) == i) copySegment(i, j);
+            }
+            _segment_index = i;
+            _virtualSegmentLength = SEGMENT.virtualLength();
+          }
           if (SEGMENT.mode != FX_MODE_HALLOWEEN_EYES) SEGENV.call++;
         }
 
@@ -96,9 +130,90 @@ void WS2812FX::service() {
     yield();
     show();
   }
+  if (_virtualClock) _rand16seed = random16_get_seed();
+  _servicedClock = servicedBefore;
   _triggered = false;
 }
 
+/*
+ * The segment whose frames segment n can show instead of running its own effect: the first
+ * one that is identical to it, draws the same number of pixels the same way and isn't frozen.
+ * Returns n itself when there is none.
+ */
+uint8_t WS2812FX::sharedSource(uint8_t n)
+{
+  Segment* b = &_segments[n];
+  if (b->getOption(SEG_OPTION_FREEZE) || b->grouping == 0) return n;
+  for (uint8_t i = 0; i < n; i++)
+  {
+    Segment* a = &_segments[i];
+    if (!a->isActive() || a->getOption(SEG_OPTION_FREEZE)) continue;
+    if (!segmentsAreIdentical(a, b)) continue;
+    if (a->virtualLength() != b->virtualLength() || a->fps != b->fps) continue;
+    if (a->width != b->width || a->getOption(SEG_OPTION_SERPENTINE) != b->getOption(SEG_OPTION_SERPENTINE)) continue;
+    if (a->opacity != b->opacity || a->getOption(SEG_OPTION_ON) != b->getOption(SEG_OPTION_ON)) continue;
+    return i;
+  }
+  return n;
+}
+
+/*
+ * Copies the frame segment src just rendered into segment dst, pixel by pixel through each
+ * segment's own mapping, so reverse, mirror, grouping and spacing still apply. Colors are
+ * copied as shown (after opacity), which sharedSource() made sure is the same for both.
+ * dst keeps no effect state of its own meanwhile; it starts afresh once it differs again.
+ */
+void WS2812FX::copySegment(uint8_t src, uint8_t dst)
+{
+  _segment_runtimes[dst].reset();
+  _virtualSegmentLength = _segments[src].virtualLength();
+  for (uint16_t i = 0; i < _virtualSegmentLength; i++)
+  {
+    _segment_index = src;
+    uint32_t c = getPixelColor(i);
+    _segment_index = dst;
+    setPixelGroup(i, CRGB(c >> 16, c >> 8, c));
+  }
+}
+
+/*
+ * Scales a per-frame increment, tuned for FX_FPS, to the time that elapsed since the
+ * segment last ran. The remainder is kept in the segment runtime, so slow increments
+ * still advance at high frame rates. Call at most once per effect frame.
+ */
+uint32_t WS2812FX::timeScaled(uint32_t perFrame) {
+  uint32_t units = perFrame * FRAMEDELTA * FX_FPS + SEGENV.substep;
+  SEGENV.substep = units % 1000;
+  return units / 1000;
+}
+
+/*
+ * Table of per-pixel parameters that stay the same from frame to frame, kept in SEGENV.data
+ * after stateBytes of effect state, so frames only compute what changes with time.
+ * key sums up whatever else the parameters depend on (palette, colors...); fill is set when
+ * the table is new or key changed, and the effect then has to fill it in.
+ * Whether the table fits is decided when the effect starts: if it doesn't, stateBytes are
+ * allocated alone and nullptr is returned, and the effect works the parameters out per frame.
+ */
+uint8_t* WS2812FX::pixelTable(uint16_t stateBytes, uint8_t bytesPerLed, uint32_t key, bool &fill) {
+  uint16_t keyAt = (stateBytes + 3) & ~3; //keep the key and the table word aligned
+  uint32_t len = (uint32_t)keyAt + sizeof(uint32_t) + (uint32_t)SEGLEN * bytesPerLed;
+  fill = false;
+  if (SEGENV.call == 0) {
+    SEGENV.deallocateData();
+    if (len > 0xFFFF || !SEGENV.allocateData(len)) {
+      if (stateBytes) SEGENV.allocateData(stateBytes);
+      return nullptr;
+    }
+    fill = true;
+  }
+  if (!SEGENV.data || SEGENV.dataLen() != len) return nullptr;
+  uint32_t* stored = (uint32_t*)(SEGENV.data + keyAt);
+  if (*stored != key) fill = true;
+  *stored = key;
+  return (uint8_t*)(stored + 1);
+}
+
 void WS2812FX::setPixelColor(uint16_t n, uint32_t c) {
   uint8_t r = (c >> 16);
   uint8_t g = (c >>  8);
@@ -110,6 +225,10 @@ void WS2812FX::setPixelColor(uint16_t n, uint32_t c) {
 
 //used to map from segment index to physical pixel, taking into account grouping, offsets, reverse and mirroring
 uint16_t WS2812FX::realPixelIndex(uint16_t i) {
+  if (SEGENV.rotation && i < SEGLEN) { //content scrolled by the effect but not yet moved, see scroll()
+    uint32_t iRot = (uint32_t)i + SEGLEN - SEGENV.rotation;
+    i = (iRot >= SEGLEN) ? iRot - SEGLEN : iRot;
+  }
   int16_t iGroup = i * SEGMENT.groupLength();
 
   /* reverse just an individual segment */
@@ -151,28 +270,7 @@ void WS2812FX::setPixelColor(uint16_t i, uint8_t r, uint8_t g, uint8_t b)
       col = BLACK;
     }
 
-    /* Set all the pixels in the group, ensuring _skipFirstMode is honored */
-    bool reversed = reverseMode ^ IS_REVERSE;
-    uint16_t realIndex = realPixelIndex(i);
-
-    for (uint16_t j = 0; j < SEGMENT.grouping; j++) {
-      int16_t indexSet = realIndex + (reversed ? -j : j);
-      int16_t indexSetRev = indexSet;
-      if (reverseMode) indexSetRev = REV(indexSet);
-#ifdef WLED_CUSTOM_LED_MAPPING
-      if (indexSet < customMappingSize) indexSet = customMappingTable[indexSet];
-#endif
-      if (indexSetRev >= SEGMENT.start && indexSetRev < SEGMENT.stop) {
-        _leds[indexSet+skip] = col;
-        if (IS_MIRROR) { //set the corresponding mirrored pixel
-          if (reverseMode) {
-            _leds[REV(SEGMENT.start) - indexSet + skip + REV(SEGMENT.stop) + 1] = col;
-          } else {
-            _leds[SEGMENT.stop - indexSet + skip + SEGMENT.start - 1]  = col;
-          }
-        }
-      }
-    }
+    setPixelGroup(i, col);
   } else { //live data, etc.
 
     if (reverseMode) i = REV(i);
@@ -193,6 +291,85 @@ void WS2812FX::setPixelColor(uint16_t i, uint8_t r, uint8_t g, uint8_t b)
 
 }
 
+/*
+ * Segment pixel index of column x, row y of the current segment, or 0xFFFF when that is outside
+ * of it. A 1D segment is a single row.
+ */
+uint16_t WS2812FX::virtualIndexXY(uint16_t x, uint16_t y)
+{
+  uint16_t width = SEGMENT.virtualWidth();
+  if (x >= width || y >= SEGMENT.virtualHeight()) return 0xFFFF;
+  if (IS_SERPENTINE && (y & 1)) x = width - 1 - x;
+  return y * width + x;
+}
+
+void WS2812FX::setPixelColorXY(uint16_t x, uint16_t y, uint32_t c)
+{
+  setPixelColorXY(x, y, c >> 16, c >> 8, c);
+}
+
+/*
+ * Sets column x, row y of the current segment, so matrix effects don't have to work their
+ * coordinates out of a pixel index. 2D segments have no groups or mirror, so the pixel is
+ * written directly rather than through setPixelGroup().
+ */
+void WS2812FX::setPixelColorXY(uint16_t x, uint16_t y, uint8_t r, uint8_t g, uint8_t b)
+{
+  uint16_t i = virtualIndexXY(x, y);
+  if (i == 0xFFFF) return;
+  if (!SEGMENT.is2D()) {
+    setPixelColor(i, r, g, b);
+    return;
+  }
+
+  CRGB col(r, g, b);
+  if (!IS_SEGMENT_ON) {
+    col = BLACK;
+  } else if (SEGMENT.opacity < 255) {
+    col.nscale8(SEGMENT.opacity);
+  }
+
+  uint16_t skip = _skipFirstMode ? LED_SKIP_AMOUNT : 0;
+  uint16_t realIndex = realPixelIndex(i);
+#ifdef WLED_CUSTOM_LED_MAPPING
+  if (realIndex < customMappingSize) realIndex = customMappingTable[realIndex];
+#endif
+  _leds[realIndex + skip] = col;
+}
+
+uint32_t WS2812FX::getPixelColorXY(uint16_t x, uint16_t y)
+{
+  uint16_t i = virtualIndexXY(x, y);
+  if (i == 0xFFFF) return 0;
+  return getPixelColor(i);
+}
+
+/* Set all the pixels in the group of segment pixel i, ensuring _skipFirstMode is honored */
+void WS2812FX::setPixelGroup(uint16_t i, CRGB col)
+{
+  uint16_t skip = _skipFirstMode ? LED_SKIP_AMOUNT : 0;
+  bool reversed = reverseMode ^ IS_REVERSE;
+  uint16_t realIndex = realPixelIndex(i);
+
+  for (uint16_t j = 0; j < SEGMENT.grouping; j++) {
+    int16_t indexSet = realIndex + (reversed ? -j : j);
+    int16_t indexSetRev = indexSet;
+    if (reverseMode) indexSetRev = REV(indexSet);
+#ifdef WLED_CUSTOM_LED_MAPPING
+    if (indexSet < customMappingSize) indexSet = customMappingTable[indexSet];
+#endif
+    if (indexSetRev >= SEGMENT.start && indexSetRev < SEGMENT.stop) {
+      _leds[indexSet+skip] = col;
+      if (IS_MIRROR) { //set the corresponding mirrored pixel
+        if (reverseMode) {
+          _leds[REV(SEGMENT.start) - indexSet + skip + REV(SEGMENT.stop) + 1] = col;
+        } else {
+          _leds[SEGMENT.stop - indexSet + skip + SEGMENT.start - 1]  = col;
+        }
+      }
+    }
+  }
+}
 
 //DISCLAIMER
 //The following function attemps to calculate the current LED power usage,
@@ -259,22 +436,61 @@ void WS2812FX::show(void) {
       uint16_t scaleI = scale * 255;
       uint8_t scaleB = (scaleI > 255) ? 255 : scaleI;
       uint8_t newBri = scale8(_brightness, scaleB);
-      FastLED.setBrightness(newBri);
+      _showBrightness = newBri;
       currentMilliamps = (powerSum0 * newBri) / puPerMilliamp;
     } else
     {
       currentMilliamps = powerSum / puPerMilliamp;
-      FastLED.setBrightness(_brightness);
+      _showBrightness = _brightness;
     }
     currentMilliamps += MA_FOR_ESP; //add power of ESP back to estimate
     currentMilliamps += _length; //add standby power back to estimate
   } else {
     currentMilliamps = 0;
-    FastLED.setBrightness(_brightness);
+    _showBrightness = _brightness;
   }
   
-  FastLED.show();
-  _lastShow = millis();
+  if (!_virtualClock) { //offline frames are taken by the show callback, FastLED is left alone
+    FastLED.setBrightness(_showBrightness);
+    FastLED.show();
+  }
+  _lastShow = nowMillis();
+}
+
+/*
+ * Runs this instance on a virtual clock starting at ms instead of millis(), so frames can
+ * be rendered faster than real time, e.g. to preview a show offline. The effects draw
+ * from their own random sequence starting at seed, and FastLED's beat functions follow
+ * the virtual clock while service() runs, so the same clock steps render the same frames.
+ * The effects restart, frames are handed to the show callback instead of FastLED.show()
+ * and FastLED's brightness is left alone (see getShowBrightness()). With
+ * FASTLED_THREAD_LOCAL set, instances on different tasks can be serviced at once.
+ */
+void WS2812FX::setVirtualClock(uint32_t ms, uint16_t seed)
+{
+  for (uint8_t i = 0; i < MAX_NUM_SEGMENTS; i++)
+  {
+    _segment_runtimes[i].reset();
+    flushEffectCache(i);
+  }
+  _virtualClock = true;
+  _virtualNow = ms;
+  _rand16seed = seed;
+  _lastShow = ms - MIN_SHOW_DELAY;
+  _lastPaletteChange = ms;
+}
+
+/*
+ * Moves the virtual clock on by ms, call service() after each step.
+ */
+void WS2812FX::advanceClock(uint32_t ms)
+{
+  _virtualNow += ms;
+}
+
+void WS2812FX::useRealClock()
+{
+  _virtualClock = false;
 }
 
 void WS2812FX::trigger() {
@@ -288,9 +504,102 @@ void WS2812FX::setMode(uint8_t segid, uint8_t m) {
 
   if (_segments[segid].mode != m) 
   {
+#if MAX_CACHED_EFFECTS
+    suspendEffect(segid);
+    _segments[segid].mode = m;
+    if (!resumeEffect(segid, m)) makeRoomForData(_effects[m].dataFor(_segments[segid].virtualLength()));
+#else
     _segment_runtimes[segid].reset();
     _segments[segid].mode = m;
+#endif
+  }
+}
+
+#if MAX_CACHED_EFFECTS
+/*
+ * Keeps the state of the segment's current effect, so setMode() can resume it later.
+ * Takes the segment's least recently used slot when all are taken.
+ */
+void WS2812FX::suspendEffect(uint8_t segid)
+{
+  Segment_runtime& env = _segment_runtimes[segid];
+  uint8_t mode = _segments[segid].mode;
+  if (!env.call || (_effects[mode].flags & FX_FLAG_STATIC)) //nothing worth keeping
+  {
+    env.reset();
+    return;
+  }
+
+  effect_state* slot = &_effectCache[segid][0];
+  for (uint8_t i = 0; i < MAX_CACHED_EFFECTS; i++)
+  {
+    effect_state* s = &_effectCache[segid][i];
+    if (!s->used) { slot = s; break; }
+    if (s->used < slot->used) slot = s;
+  }
+  dropEffectState(*slot);
+  env.suspend(*slot);
+  slot->mode = mode;
+  slot->used = ++_effectCacheClock;
+}
+
+bool WS2812FX::resumeEffect(uint8_t segid, uint8_t m)
+{
+  for (uint8_t i = 0; i < MAX_CACHED_EFFECTS; i++)
+  {
+    effect_state& s = _effectCache[segid][i];
+    if (s.used && s.mode == m)
+    {
+      _segment_runtimes[segid].resume(s);
+      s.used = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WS2812FX::dropEffectState(effect_state& s)
+{
+  if (s.data)
+  {
+    free(s.data);
+    _usedSegmentData -= s.dataLen;
   }
+  s.data = nullptr;
+  s.dataLen = 0;
+  s.used = 0;
+}
+
+/*
+ * Drops the least recently used effect states until len more bytes of segment data fit.
+ */
+void WS2812FX::makeRoomForData(uint16_t len)
+{
+  while (_usedSegmentData + len > MAX_SEGMENT_DATA)
+  {
+    effect_state* lru = nullptr;
+    for (uint8_t n = 0; n < MAX_NUM_SEGMENTS; n++)
+    {
+      for (uint8_t i = 0; i < MAX_CACHED_EFFECTS; i++)
+      {
+        effect_state* s = &_effectCache[n][i];
+        if (s->used && s->data && (!lru || s->used < lru->used)) lru = s;
+      }
+    }
+    if (!lru) return;
+    dropEffectState(*lru);
+  }
+}
+#endif
+
+/*
+ * Forgets the suspended effects of a segment, when its geometry changes they no longer fit.
+ */
+void WS2812FX::flushEffectCache(uint8_t segid)
+{
+#if MAX_CACHED_EFFECTS
+  for (uint8_t i = 0; i < MAX_CACHED_EFFECTS; i++) dropEffectState(_effectCache[segid][i]);
+#endif
 }
 
 uint8_t WS2812FX::getModeCount()
@@ -379,7 +688,7 @@ void WS2812FX::setBrightness(uint8_t b) {
       _segments[i].setOption(SEG_OPTION_FREEZE, false);
     }
   }
-  if (SEGENV.next_time > millis() + 22 && millis() - _lastShow > MIN_SHOW_DELAY) show();//apply brightness change immediately if no refresh soon
+  if (SEGENV.next_time > nowMillis() + 22 && nowMillis() - _lastShow > MIN_SHOW_DELAY) show();//apply brightness change immediately if no refresh soon
 }
 
 uint8_t WS2812FX::getMode(void) {
@@ -394,6 +703,15 @@ uint8_t WS2812FX::getBrightness(void) {
   return _brightness;
 }
 
+/*
+ * Brightness the last frame was shown at, lowered from getBrightness() by the current
+ * limit. On a virtual clock FastLED's brightness is not set, whoever takes the frames
+ * applies it after service().
+ */
+uint8_t WS2812FX::getShowBrightness(void) {
+  return _showBrightness;
+}
+
 uint8_t WS2812FX::getMaxSegments(void) {
   return MAX_NUM_SEGMENTS;
 }
@@ -437,7 +755,7 @@ uint32_t WS2812FX::getPixelColor(uint16_t i)
   
   if (i >= _lengthRaw) return 0;
 
-  return( (_leds[i].r << 24) | (_leds[i].g << 16) | _leds[i].b );
+  return( ((uint32_t)_leds[i].r << 16) | ((uint32_t)_leds[i].g << 8) | _leds[i].b );
 
 }
 
@@ -450,6 +768,11 @@ WS2812FX::Segment_runtime WS2812FX::getSegmentRuntime(void) {
   return SEGENV;
 }
 
+WS2812FX::Segment_runtime WS2812FX::getSegmentRuntime(uint8_t n) {
+  if (n >= MAX_NUM_SEGMENTS) return _segment_runtimes[0];
+  return _segment_runtimes[n];
+}
+
 WS2812FX::Segment* WS2812FX::getSegments(void) {
   return _segments;
 }
@@ -495,7 +818,39 @@ void WS2812FX::setSegment(uint8_t n, uint16_t i1, uint16_t i2, uint8_t grouping,
     seg.grouping = grouping;
     seg.spacing = spacing;
   }
+  seg.width = 0; //back to 1D, setSegment2D() sets the matrix after this
+  seg.height = 0;
   _segment_runtimes[n].reset();
+  flushEffectCache(n);
+}
+
+/*
+ * Makes segment n a width x height matrix starting at LED start, its rows laid out one after
+ * another, or back and forth when serpentine. Grouping, spacing and mirror don't apply to 2D
+ * segments. Effects see SEGLEN = width * height, allocate SEGENV.data as for a 1D segment
+ * of that length, and can address pixels with setPixelColorXY() / getPixelColorXY().
+ */
+void WS2812FX::setSegment2D(uint8_t n, uint16_t start, uint8_t width, uint8_t height, bool serpentine)
+{
+  if (n >= MAX_NUM_SEGMENTS) return;
+  Segment& seg = _segments[n];
+  uint32_t stop = (uint32_t)start + width * height;
+  if (stop > _length) stop = _length;
+  uint8_t rows = (width && stop > start) ? (stop - start) / width : 0;
+  stop = start + width * rows; //whole rows only, none disables the segment
+
+  //return if nothing has changed
+  if (seg.start == start && seg.stop == stop && seg.width == width && seg.height == rows
+      && seg.getOption(SEG_OPTION_SERPENTINE) == serpentine) return;
+
+  setSegment(n, start, stop, 1, 0);
+  if (!seg.isActive()) return;
+  seg.width = width;
+  seg.height = rows;
+  seg.setOption(SEG_OPTION_MIRROR, false);
+  seg.setOption(SEG_OPTION_SERPENTINE, serpentine);
+  _segment_runtimes[n].reset();
+  flushEffectCache(n);
 }
 
 void WS2812FX::resetSegments() {
@@ -520,8 +875,10 @@ void WS2812FX::resetSegments() {
     _segments[i].setOption(SEG_OPTION_ON, 1);
     _segments[i].opacity = 255;
     _segment_runtimes[i].reset();
+    flushEffectCache(i);
   }
   _segment_runtimes[0].reset();
+  flushEffectCache(0);
 }
 
 //After this function is called, setPixelColor() will use that segment (offsets, grouping, ... will apply)
@@ -554,7 +911,7 @@ void WS2812FX::setShowCallback(show_callback cb)
 
 void WS2812FX::setTransitionMode(bool t)
 {
-  unsigned long waitMax = millis() + 20; //refresh after 20 ms if transition enabled
+  unsigned long waitMax = nowMillis() + 20; //refresh after 20 ms if transition enabled
   for (uint16_t i = 0; i < MAX_NUM_SEGMENTS; i++)
   {
     _segment_index = i;
@@ -598,6 +955,86 @@ void WS2812FX::fill(uint32_t c) {
   }
 }
 
+/*
+ * Scrolls the segment content towards its end by the given number of pixels, wrapping around.
+ * Only the logical->physical mapping is changed here, so an effect just has to write the pixels
+ * that became exposed at the start. The LED buffer is brought in line once per frame by applyScroll().
+ * Use this for any marquee or running-text style effect instead of copying pixel by pixel.
+ */
+void WS2812FX::scroll(uint16_t steps) {
+  if (SEGLEN < 2) return;
+  SEGENV.rotation = ((uint32_t)SEGENV.rotation + steps) % SEGLEN;
+}
+
+static void reverseLeds(CRGB *leds, uint16_t len)
+{
+  CRGB *a = leds;
+  CRGB *b = leds + len - 1;
+  while (a < b) {
+    CRGB t = *a; *a++ = *b; *b-- = t;
+  }
+}
+
+//rotates len pixels towards the end by 'by' (new[i] = old[i - by])
+static void rotateLeds(CRGB *leds, uint16_t len, uint16_t by)
+{
+  if (by == 0 || by >= len) return;
+  if (by <= 4) {
+    CRGB tmp[4];
+    memcpy((void*)tmp, leds + len - by, by * sizeof(CRGB));
+    memmove((void*)(leds + by), leds, (len - by) * sizeof(CRGB));
+    memcpy((void*)leds, tmp, by * sizeof(CRGB));
+  } else {
+    reverseLeds(leds, len);
+    reverseLeds(leds, by);
+    reverseLeds(leds + by, len - by);
+  }
+}
+
+static uint16_t gcd16(uint16_t a, uint16_t b)
+{
+  while (b) { uint16_t t = a % b; a = b; b = t; }
+  return a;
+}
+
+/*
+ * Moves the pixels of the current segment by the pending SEGENV.rotation, then clears it.
+ * Plain segments are a contiguous run in the LED buffer and get a single block rotate.
+ * Grouped, spaced or mirrored segments go through the pixel mapping, one cycle at a time.
+ */
+void WS2812FX::applyScroll(void)
+{
+  uint16_t rot = SEGENV.rotation;
+  SEGENV.rotation = 0;
+  uint16_t len = SEGLEN;
+  if (rot == 0 || rot >= len) return;
+
+#ifndef WLED_CUSTOM_LED_MAPPING
+  if (SEGMENT.grouping == 1 && SEGMENT.spacing == 0 && !IS_MIRROR) {
+    uint16_t first = reverseMode ? REV(SEGMENT.stop - 1) : SEGMENT.start;
+    if (_skipFirstMode) first += LED_SKIP_AMOUNT;
+    bool reversed = reverseMode ^ IS_REVERSE;
+    rotateLeds(&_leds[first], len, reversed ? len - rot : rot);
+    return;
+  }
+#endif
+
+  //new[i] = old[i - rot], walked as gcd(len, rot) independent cycles
+  //colors are moved as shown, so opacity is not applied again and an off segment stays as it is
+  uint16_t cycles = gcd16(len, rot);
+  for (uint16_t c = 0; c < cycles; c++) {
+    CRGB tmp = col_to_crgb(getPixelColor(c));
+    uint16_t j = c;
+    while (true) {
+      uint16_t k = (j >= rot) ? j - rot : j + len - rot;
+      if (k == c) break;
+      setPixelGroup(j, col_to_crgb(getPixelColor(k)));
+      j = k;
+    }
+    setPixelGroup(j, tmp);
+  }
+}
+
 /*
  * Blends the specified color with the existing pixel color.
  */
@@ -729,10 +1166,8 @@ CRGB WS2812FX::col_to_crgb(uint32_t color)
 
 void WS2812FX::load_gradient_palette(uint8_t index)
 {
-  uint8_t i = index > (GRADIENT_PALETTE_COUNT - 1) ? index : (GRADIENT_PALETTE_COUNT - 1);
-  uint8_t tcp[72]; //support gradient palettes with up to 18 entries
-  memcpy(tcp, &(gGradientPalettes[i]), 72);
-  targetPalette.loadDynamicGradientPalette(tcp);
+  uint8_t i = index < GRADIENT_PALETTE_COUNT ? index : (GRADIENT_PALETTE_COUNT - 1);
+  targetPalette.loadDynamicGradientPalette(gGradientPalettes[i]); //flash is addressable on the ESP32, no copy needed
 }
 
 
@@ -745,23 +1180,7 @@ void WS2812FX::handle_palette(void)
   _segment_index_palette_last = _segment_index;
 
   uint8_t paletteIndex = SEGMENT.palette;
-  if (paletteIndex == 0) //default palette. Differs depending on effect
-  {
-    switch (SEGMENT.mode)
-    {
-      case FX_MODE_FIRE_2012  : paletteIndex = 35; break; //heat palette
-      case FX_MODE_COLORWAVES : paletteIndex = 26; break; //landscape 33
-      case FX_MODE_FILLNOISE8 : paletteIndex =  9; break; //ocean colors
-      case FX_MODE_NOISE16_1  : paletteIndex = 20; break; //Drywet
-      case FX_MODE_NOISE16_2  : paletteIndex = 43; break; //Blue cyan yellow
-      case FX_MODE_NOISE16_3  : paletteIndex = 35; break; //heat palette
-      case FX_MODE_NOISE16_4  : paletteIndex = 26; break; //landscape 33
-      case FX_MODE_GLITTER    : paletteIndex = 11; break; //rainbow colors
-      case FX_MODE_SUNRISE    : paletteIndex = 35; break; //heat palette
-      case FX_MODE_FLOW       : paletteIndex =  6; break; //party
-    }
-  }
-  if (SEGMENT.mode >= FX_MODE_METEOR && paletteIndex == 0) paletteIndex = 4;
+  if (paletteIndex == 0) paletteIndex = _effects[SEGMENT.mode].palette; //default palette. Differs depending on effect
   
   switch (paletteIndex)
   {
@@ -772,14 +1191,14 @@ void WS2812FX::handle_palette(void)
       {
         targetPalette = PartyColors_p; break; //fallback
       }
-      if (millis() - _lastPaletteChange > 1000 + ((uint32_t)(255-SEGMENT.intensity))*100)
+      if (nowMillis() - _lastPaletteChange > 1000 + ((uint32_t)(255-SEGMENT.intensity))*100)
       {
         targetPalette = CRGBPalette16(
                         CHSV(random8(), 255, random8(128, 255)),
                         CHSV(random8(), 255, random8(128, 255)),
                         CHSV(random8(), 192, random8(128, 255)),
                         CHSV(random8(), 255, random8(128, 255)));
-        _lastPaletteChange = millis();
+        _lastPaletteChange = nowMillis();
       } break;}
     case 2: {//primary color only
       CRGB prim = col_to_crgb(SEGCOLOR(0));
@@ -905,4 +1324,4 @@ uint32_t WS2812FX::gamma32(uint32_t color)
   return ((r << 16) | (g << 8) | (b));
 }
 
-uint16_t WS2812FX::_usedSegmentData = 0;
+FASTLED_THREAD_LOCAL uint16_t WS2812FX::_usedSegmentData = 0;
@@ -0,0 +1,218 @@
+// Steady-state allocation test: runs every effect, on a 1D, a 2D and a shared segment,
+// and the show() path of the library (power limiting, correction, color matrix,
+// dithering, output ramps) into a controller that converts the pixels the way the
+// ESP32 drivers do, and into the I2S driver itself: two lanes of different chipsets,
+// sent by the DMA engine of i2s_host.h, so its controller, pulse grid and DMA buffer
+// allocations run as on the ESP32. Every malloc/calloc/realloc and operator new is
+// counted, not only the ones FASTLED_ALLOC_NOTE marks; after WARMUP_FRAMES frames of
+// an effect, the next TEST_FRAMES must not allocate at all. Each effect runs in a task
+// of its own, so its peak stack use is reported too.
+//
+// The RMT driver is only built for rmt_test (FastLED.h selects I2S), so its allocations
+// are not covered here: the pixel controller copy on its first show, and the pulse
+// buffer of initPulseBuffer() with FASTLED_RMT_BUILTIN_DRIVER.
+//
+// Exits with 1 and the callers of the allocations if any effect allocates.
+
+#include "FX.h"
+#include "i2s_host.h"
+
+#include <atomic>
+#include <execinfo.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WARMUP_FRAMES 64
+#define TEST_FRAMES 256
+#define FRAME_MS (1000 / FX_FPS)
+#define TASK_STACK (64 * 1024)
+
+#define SEG_1D 150
+#define SEG_2D_W 16
+#define SEG_2D_H 8
+#define NUM_LEDS (2 * SEG_1D + SEG_2D_W * SEG_2D_H)
+
+// -- The allocator shim, linked in with --wrap
+
+static std::atomic<bool> gCounting(false);
+static std::atomic<uint32_t> gAllocs(0);
+
+#define MAX_CALLERS 32
+static void * gCallers[MAX_CALLERS];
+static std::atomic<int> gNumCallers(0);
+
+extern "C" {
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t n, size_t size);
+void * __real_realloc(void * ptr, size_t size);
+void __real_free(void * ptr);
+}
+
+static inline void countAllocation(void * caller) {
+    if (!gCounting) return;
+    gAllocs++;
+    int i = gNumCallers++;
+    if (i < MAX_CALLERS) gCallers[i] = caller;
+}
+
+extern "C" {
+void * __wrap_malloc(size_t size) { countAllocation(__builtin_return_address(0)); return __real_malloc(size); }
+void * __wrap_calloc(size_t n, size_t size) { countAllocation(__builtin_return_address(0)); return __real_calloc(n, size); }
+void * __wrap_realloc(void * ptr, size_t size) { countAllocation(__builtin_return_address(0)); return __real_realloc(ptr, size); }
+void __wrap_free(void * ptr) { __real_free(ptr); }
+}
+
+void * operator new(size_t size) {
+    countAllocation(__builtin_return_address(0));
+    void * p = __real_malloc(size ? size : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+void * operator new[](size_t size) { return operator new(size); }
+void * operator new(size_t size, const std::nothrow_t &) noexcept {
+    countAllocation(__builtin_return_address(0));
+    return __real_malloc(size ? size : 1);
+}
+void * operator new[](size_t size, const std::nothrow_t &) noexcept { return operator new(size, std::nothrow); }
+void operator delete(void * ptr) noexcept { __real_free(ptr); }
+void operator delete[](void * ptr) noexcept { __real_free(ptr); }
+void operator delete(void * ptr, size_t) noexcept { __real_free(ptr); }
+void operator delete[](void * ptr, size_t) noexcept { __real_free(ptr); }
+
+// -- Converts the pixels to wire order the way the ESP32 drivers do, into a buffer
+
+class HostController : public CPixelLEDController<GRB> {
+    uint8_t mWire[NUM_LEDS * 3];
+public:
+    virtual void init() { }
+protected:
+    virtual void showPixels(PixelController<GRB> & pixels) {
+        uint8_t * p = mWire;
+        while (pixels.has(1)) {
+            *p++ = pixels.loadAndScale0();
+            *p++ = pixels.loadAndScale1();
+            *p++ = pixels.loadAndScale2();
+            pixels.advanceData();
+            pixels.stepDithering();
+        }
+    }
+};
+
+// -- The I2S engine only needs to take the buffers
+static void drain(void * arg, int frame, int index, const uint32_t * words, int count) { }
+
+static CRGB leds[NUM_LEDS];
+static HostController controller;
+static WS2812FX fx;
+static SemaphoreHandle_t gDone;
+
+struct ModeRun {
+    uint8_t mode;
+    uint32_t allocs;
+    uint32_t stack;
+};
+
+static void frame(int n) {
+    fx.advanceClock(FRAME_MS);
+    fx.service();
+    if (n % 64 == 63) {
+        FastLED.showColor(CRGB::Black);
+    } else {
+        FastLED.show();
+    }
+}
+
+static void runMode(void * arg) {
+    ModeRun & r = *(ModeRun *)arg;
+    if (r.mode < MODE_COUNT) {
+        for (uint8_t s = 0; s < 3; s++) fx.setMode(s, r.mode);
+        FastLED.fadeTo(r.mode & 1 ? 96 : 255, (WARMUP_FRAMES + TEST_FRAMES) * FRAME_MS, FADE_EASE_IN_OUT_CUBIC);
+        for (int i = 0; i < WARMUP_FRAMES; i++) frame(i);
+
+        uint32_t before = gAllocs;
+        gCounting = true;
+        for (int i = 0; i < TEST_FRAMES; i++) frame(i);
+        gCounting = false;
+        r.allocs = gAllocs - before;
+    }
+    r.stack = TASK_STACK - alloc_check_stack_left(NULL);
+    xSemaphoreGive(gDone);
+}
+
+static void runInTask(ModeRun & r) {
+    xTaskCreatePinnedToCore(runMode, "fx_mode", TASK_STACK, &r, 1, NULL, tskNO_AFFINITY);
+    xSemaphoreTake(gDone, portMAX_DELAY);
+}
+
+int main(int argc, char ** argv) {
+    gDone = xSemaphoreCreateBinary();
+
+    FastLED.addLeds(&controller, leds, NUM_LEDS);
+    FastLED.addLeds<WS2812, 12, GRB>(leds, SEG_1D);
+    FastLED.addLeds<SK6812, 13, GRB>(leds + SEG_1D, SEG_2D_W * SEG_2D_H);
+    I2SHost engine(drain, NULL);
+    // -- The effects run on a virtual clock: no need to hold show() to the I2S 400Hz
+    FastLED.setMaxRefreshRate(0);
+    FastLED.setCorrection(TypicalLEDStrip);
+    FastLED.setTemperature(Tungsten100W);
+    FastLED.setColorMatrix(CRGBMatrix::hueRotation(8192) * CRGBMatrix::saturation(192));
+    FastLED.setDither(BINARY_DITHER);
+    FastLED.setMaxPowerInVoltsAndMilliamps(5, 1500);
+
+    fx.init(NUM_LEDS, leds, false);
+    fx.setSegment(0, 0, SEG_1D);
+    fx.setSegment2D(1, SEG_1D, SEG_2D_W, SEG_2D_H, true);
+    fx.setSegment(2, SEG_1D + SEG_2D_W * SEG_2D_H, NUM_LEDS);   // identical to segment 0, rendered once
+    for (uint8_t s = 0; s < 3; s++) {
+        WS2812FX::Segment & seg = fx.getSegment(s);
+        seg.colors[0] = 0xFF5500;
+        seg.colors[1] = 0x0040FF;
+        seg.colors[2] = 0x00FF20;
+        seg.speed = 160;
+        seg.intensity = 160;
+    }
+    fx.setVirtualClock(0);
+
+    // -- What a task costs before it renders anything
+    ModeRun idle = { MODE_COUNT, 0, 0 };
+    runInTask(idle);
+
+    int failed = 0;
+    uint32_t peak = 0;
+    uint8_t peakMode = 0;
+    for (int m = 0; m < MODE_COUNT; m++) {
+        ModeRun r = { (uint8_t)m, 0, 0 };
+        runInTask(r);
+        uint32_t stack = r.stack - idle.stack;
+        if (stack > peak) { peak = stack; peakMode = m; }
+        if (r.allocs) {
+            printf("mode %3d: %u allocations in %d frames after warm-up\n", m, (unsigned)r.allocs, TEST_FRAMES);
+            failed++;
+        }
+    }
+
+    int shows = MODE_COUNT * (WARMUP_FRAMES + TEST_FRAMES);
+    if (engine.frames() != shows) {
+        printf("I2S: %d frames sent through the DMA buffers, %d shown\n", engine.frames(), shows);
+        failed++;
+    }
+
+    printf("%d effects, %d frames each after %d of warm-up: %d allocated\n", MODE_COUNT, TEST_FRAMES, WARMUP_FRAMES, failed);
+    printf("peak stack: %u bytes, mode %d (host build, x86 frames are larger than Xtensa ones)\n", (unsigned)peak, peakMode);
+    if (failed) {
+        // -- Each caller once, for addr2line -e alloc_test
+        int n = gNumCallers < MAX_CALLERS ? (int)gNumCallers : MAX_CALLERS;
+        int unique = 0;
+        for (int i = 0; i < n; i++) {
+            int j = 0;
+            while (j < unique && gCallers[j] != gCallers[i]) j++;
+            if (j == unique) gCallers[unique++] = gCallers[i];
+        }
+        printf("allocated from:\n");
+        fflush(stdout);
+        backtrace_symbols_fd(gCallers, unique, 1);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+// Prints the clockless profiles that chipsets.h checks against their chipset limits,
+// as each driver quantizes them: the high and low times the strip sees and how far
+// each is inside the limits (the margins of ClocklessTimingCheck), in ns. A negative
+// margin does not get here: that profile fails to compile.
+//
+//   clocktiming
+
+#include "FastLED.h"
+#include "clocktiming.h"
+
+void printRMTProfiles();
+
+int main() {
+    printf("%-25s %-4s %5s %5s %5s %5s %7s %7s %7s\n", "profile", "", "T0H", "T1H", "T0L", "T1L",
+           "T0H +-", "T1H +-", "TL +");
+    printProfiles("I2S");
+    printRMTProfiles();
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef __INC_CLOCKTIMING_H
+#define __INC_CLOCKTIMING_H
+
+// The clockless profiles clocktiming prints, for the file that includes it after
+// FastLED.h: clocktiming.cpp with the I2S driver, clocktiming_rmt.cpp with RMT.
+// The timings and limits come from the controllers in chipsets.h, through their
+// ClocklessTimingCheck base.
+
+#include <stdio.h>
+
+template <int T1, int T2, int T3, class LIMITS>
+ClocklessTimingCheck<T1, T2, T3, LIMITS> clocklessCheckOf(const ClocklessTimingCheck<T1, T2, T3, LIMITS> *);
+
+// -- One line: the quantized times, then the margins to the chipset limits, in ns
+template <class CONTROLLER>
+static void printProfile(const char * name, const char * driver) {
+    typedef decltype(clocklessCheckOf((CONTROLLER *)0)) C;
+    printf("%-25s %-4s %5d %5d %5d %5d %7d %7d %7d\n", name, driver,
+           (int)C::T::T0H, (int)C::T::T1H, (int)C::T::T0L, (int)C::T::T1L,
+           (int)C::T0H_MARGIN, (int)C::T1H_MARGIN, (int)C::TL_MARGIN);
+}
+
+static void printProfiles(const char * driver) {
+    printProfile<WS2812Controller800Khz<12> >("WS2812Controller800Khz", driver);
+    printProfile<SK6812Controller<12> >("SK6812Controller", driver);
+    printProfile<WS2812Controller1000Khz<12> >("WS2812Controller1000Khz", driver);
+    printProfile<WS2812Controller1200Khz<12> >("WS2812Controller1200Khz", driver);
+    printProfile<SK6812Controller1000Khz<12> >("SK6812Controller1000Khz", driver);
+}
+
+#endif
@@ -0,0 +1,9 @@
+// The profiles of clocktiming.cpp, quantized by the RMT driver
+
+// -- Built with FASTLED_ESP32_RMT (see CMakeLists.txt)
+#include "FastLED.h"
+#include "clocktiming.h"
+
+void printRMTProfiles() {
+    printProfiles("RMT");
+}
@@ -0,0 +1,304 @@
+// The ESP-IDF services FastLED and the effects use, for the host build; see
+// include/esp_host.h
+
+#include "esp_host.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -- Painted into task stacks, to find how deep they went
+#define STACK_PAINT 0xA5
+
+// -- Smallest stack a host task gets: x86 frames are bigger than Xtensa ones, and
+//    the C library wants more besides
+#define MIN_HOST_STACK (64 * 1024)
+
+struct HostTask {
+    char name[16];
+    TaskFunction_t code;
+    void * arg;
+    uint8_t * stack;        // NULL for threads not created as tasks
+    size_t stackSize;
+    pthread_t thread;
+    volatile bool done;     // the task function returned
+    std::mutex lock;
+    std::condition_variable wake;
+    uint32_t notified;
+};
+
+struct HostSemaphore {
+    std::mutex lock;
+    std::condition_variable wake;
+    int count;
+};
+
+// -- An interrupt source: its handler runs in the thread that raises it, one at a time
+#define HOST_INTR_SOURCES 8
+struct HostInterrupt {
+    intr_handler_t handler;
+    void * arg;
+    std::atomic<bool> enabled;
+    std::atomic<uint32_t> enables;
+    std::mutex lock;
+};
+static HostInterrupt gInterrupts[HOST_INTR_SOURCES];
+
+static const auto gStart = std::chrono::steady_clock::now();
+static thread_local HostTask * tCurrent = NULL;
+
+// -- Tasks created so far; those whose function returned are cleaned up when the
+//    next one is created, so their handles must not be used after that
+static std::mutex gTasksLock;
+static HostTask * gTasks[64];
+static int gNumTasks = 0;
+
+static void reapTasks() {
+    std::lock_guard<std::mutex> l(gTasksLock);
+    for (int i = 0; i < gNumTasks; ) {
+        HostTask * t = gTasks[i];
+        if (!t->done) { i++; continue; }
+        pthread_join(t->thread, NULL);
+        free(t->stack);
+        delete t;
+        gTasks[i] = gTasks[--gNumTasks];
+    }
+}
+
+extern "C" {
+
+// -- Clock
+
+int64_t esp_timer_get_time(void) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - gStart).count();
+}
+
+unsigned long micros(void) { return (unsigned long)esp_timer_get_time(); }
+unsigned long millis(void) { return (unsigned long)(esp_timer_get_time() / 1000); }
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+void yield(void) { std::this_thread::yield(); }
+void esp_restart(void) { abort(); }
+
+// -- Tasks
+
+static void * taskMain(void * arg) {
+    HostTask * t = (HostTask *)arg;
+    tCurrent = t;
+    t->code(t->arg);
+    t->done = true;
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char * name, uint32_t stackDepth,
+                                   void * arg, UBaseType_t priority, TaskHandle_t * created, BaseType_t core) {
+    reapTasks();
+    if (gNumTasks == sizeof(gTasks) / sizeof(gTasks[0])) return pdFALSE;
+    HostTask * t = new HostTask();
+    strncpy(t->name, name, sizeof(t->name) - 1);
+    t->code = code;
+    t->arg = arg;
+    t->stackSize = ((stackDepth < MIN_HOST_STACK ? MIN_HOST_STACK : stackDepth) + 4095) & ~4095;
+    t->stack = (uint8_t *)aligned_alloc(4096, t->stackSize);
+    memset(t->stack, STACK_PAINT, t->stackSize);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, t->stack, t->stackSize);
+    int err = pthread_create(&t->thread, &attr, taskMain, t);
+    pthread_attr_destroy(&attr);
+    if (err) {
+        free(t->stack);
+        delete t;
+        return pdFALSE;
+    }
+    {
+        std::lock_guard<std::mutex> l(gTasksLock);
+        gTasks[gNumTasks++] = t;
+    }
+    if (created) *created = t;
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (tCurrent == NULL) {
+        // -- A thread that was not created as a task, such as main()
+        tCurrent = new HostTask();
+        strncpy(tCurrent->name, "main", sizeof(tCurrent->name) - 1);
+    }
+    return tCurrent;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // -- Only a task deleting itself is supported
+    if (task == NULL || task == tCurrent) {
+        if (tCurrent) tCurrent->done = true;
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) { return 1; }
+BaseType_t xPortGetCoreID(void) { return 0; }
+
+char * pcTaskGetTaskName(TaskHandle_t task) {
+    return (task ? task : xTaskGetCurrentTaskHandle())->name;
+}
+
+// -- Bytes at the far end of the stack never written, as ESP-IDF reports it;
+//    0 for threads not created as tasks
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    HostTask * t = task ? task : xTaskGetCurrentTaskHandle();
+    if (t->stack == NULL) return 0;
+    size_t n = 0;
+    while (n < t->stackSize && t->stack[n] == STACK_PAINT) n++;
+    return n;
+}
+
+// -- Task notifications
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    HostTask * t = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> l(t->lock);
+    if (ticks == portMAX_DELAY) {
+        t->wake.wait(l, [t] { return t->notified != 0; });
+    } else {
+        t->wake.wait_for(l, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), [t] { return t->notified != 0; });
+    }
+    uint32_t n = t->notified;
+    if (n) t->notified = clear ? 0 : n - 1;
+    return n;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> l(task->lock);
+    task->notified++;
+    task->wake.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdFALSE;
+}
+
+// -- Semaphores; a mutex is a binary semaphore that starts out given
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    HostSemaphore * s = new HostSemaphore();
+    s->count = 0;
+    return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    HostSemaphore * s = new HostSemaphore();
+    s->count = 1;
+    return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+    std::unique_lock<std::mutex> l(s->lock);
+    if (ticks == portMAX_DELAY) {
+        s->wake.wait(l, [s] { return s->count > 0; });
+    } else if (!s->wake.wait_for(l, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), [s] { return s->count > 0; })) {
+        return pdFALSE;
+    }
+    s->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    std::lock_guard<std::mutex> l(s->lock);
+    if (s->count) return pdFALSE;
+    s->count = 1;
+    s->wake.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t s, BaseType_t * woken) {
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreGive(s);
+}
+
+void ets_intr_lock(void) { }
+void ets_intr_unlock(void) { }
+
+// -- Heap
+
+void * heap_caps_malloc(size_t size, uint32_t caps) { return malloc(size); }
+void heap_caps_free(void * ptr) { free(ptr); }
+size_t heap_caps_get_free_size(uint32_t caps) { return 320 * 1024; }
+size_t heap_caps_get_minimum_free_size(uint32_t caps) { return 320 * 1024; }
+
+// -- Peripherals: the registers are plain memory, the pin setup does nothing
+
+volatile gpio_dev_t GPIO;
+const uint32_t GPIO_PIN_MUX_REG[40] = { 0 };
+i2s_dev_t I2S0, I2S1;
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) { return ESP_OK; }
+void gpio_matrix_out(uint32_t gpio, uint32_t signal, bool out_inv, bool oen_inv) { }
+void periph_module_enable(int module) { }
+void pinMode(uint8_t pin, uint8_t mode) { }
+
+volatile rmt_dev_t RMT;
+volatile rmt_mem_t RMTMEM;
+
+esp_err_t rmt_config(const rmt_config_t * config) { return ESP_OK; }
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags) { return ESP_OK; }
+esp_err_t rmt_set_tx_thr_intr_en(rmt_channel_t channel, bool en, uint16_t evt_thresh) { return ESP_OK; }
+esp_err_t rmt_set_tx_intr_en(rmt_channel_t channel, bool en) { return ESP_OK; }
+esp_err_t rmt_set_pin(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t gpio_num) { return ESP_OK; }
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t * items, int item_num, bool wait_tx_done) { return ESP_OK; }
+void rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void * arg) { }
+
+esp_err_t rmt_tx_start(rmt_channel_t channel, bool tx_idx_rst) {
+    RMT.conf_ch[channel].conf1.tx_start = 1;
+    return ESP_OK;
+}
+
+// -- Interrupts: the handlers are kept for host_intr_raise(); the source is the handle
+
+esp_err_t esp_intr_alloc(int source, int flags, intr_handler_t handler, void * arg, intr_handle_t * handle) {
+    if (source < 0 || source >= HOST_INTR_SOURCES) return ESP_FAIL;
+    HostInterrupt & i = gInterrupts[source];
+    i.handler = handler;
+    i.arg = arg;
+    i.enabled = false;
+    if (handle) *handle = &i;
+    return ESP_OK;
+}
+
+esp_err_t esp_intr_enable(intr_handle_t handle) {
+    HostInterrupt * i = (HostInterrupt *)handle;
+    i->enabled = true;
+    i->enables++;
+    return ESP_OK;
+}
+
+esp_err_t esp_intr_disable(intr_handle_t handle) {
+    ((HostInterrupt *)handle)->enabled = false;
+    return ESP_OK;
+}
+
+uint32_t host_intr_enables(int source) {
+    return gInterrupts[source].enables;
+}
+
+bool host_intr_raise(int source) {
+    HostInterrupt & i = gInterrupts[source];
+    std::lock_guard<std::mutex> l(i.lock);
+    if (!i.enabled || i.handler == NULL) return false;
+    i.handler(i.arg);
+    return true;
+}
+
+}
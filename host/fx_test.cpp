@@ -0,0 +1,112 @@
+// WS2812FX checks that need no controller:
+//
+// - scrolled segments keep their brightness: the same segments run on two instances
+//   with the same virtual clock, at opacity 255 and 128, and every led of the second
+//   must stay the first one scaled by 128. A scroll that applied the opacity again
+//   would darken the second on every step.
+// - every effect allocates no more SEGENV.data than its registry entry declares, which
+//   is what setMode() makes room for, on 1D segments of a few lengths and a 2D one.
+
+#include "FX.h"
+
+#include <stdio.h>
+
+#define NUM_LEDS 240
+#define FRAMES 400
+#define FRAME_MS (1000 / FX_FPS)
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+// -- Grouped, mirrored and grouped with spacing and reversed: the paths of applyScroll()
+//    that go through the pixel mapping
+static void setup(WS2812FX & fx, CRGB * leds, uint8_t opacity) {
+    fx.init(NUM_LEDS, leds, false);
+    fx.setSegment(0, 0, 120, 2);
+    fx.setSegment(1, 120, 180);
+    fx.setSegment(2, 180, NUM_LEDS, 2, 1);
+    fx.getSegment(1).setOption(SEG_OPTION_MIRROR, true);
+    fx.getSegment(2).setOption(SEG_OPTION_REVERSED, true);
+    for (uint8_t s = 0; s < 3; s++) {
+        WS2812FX::Segment & seg = fx.getSegment(s);
+        seg.speed = 255;
+        seg.intensity = 0;
+        seg.opacity = opacity;
+        fx.setMode(s, FX_MODE_RUNNING_RANDOM);
+    }
+    fx.setVirtualClock(0);
+}
+
+static void scrollKeepsOpacity() {
+    static CRGB full[NUM_LEDS], half[NUM_LEDS];
+    static WS2812FX a, b;
+    setup(a, full, 255);
+    setup(b, half, 128);
+
+    int bad = -1;
+    uint32_t lit = 0;
+    for (int f = 0; f < FRAMES && bad < 0; f++) {
+        a.advanceClock(FRAME_MS);
+        b.advanceClock(FRAME_MS);
+        a.service();
+        b.service();
+        for (int i = 0; i < NUM_LEDS; i++) {
+            CRGB expect = full[i];
+            expect.nscale8(128);
+            if (half[i] != expect) { bad = f; break; }
+            if (half[i]) lit++;
+        }
+    }
+    CHECK(bad < 0, "scroll: frame %d lost brightness at opacity 128", bad);
+    CHECK(bad >= 0 || lit > 0, "scroll: nothing was drawn");
+    if (bad < 0) printf("scroll: %d frames at opacity 128 kept their brightness\n", FRAMES);
+}
+
+static void dataSizesDeclared() {
+    static CRGB leds[NUM_LEDS];
+    static WS2812FX fx;
+    // -- Lengths on both sides of the caps of the per-led entries
+    const uint16_t lengths[] = { 1, 30, 150, NUM_LEDS };
+    fx.init(NUM_LEDS, leds, false);
+    int checked = 0, before = failures;
+    for (int m = 0; m < MODE_COUNT; m++) {
+        const WS2812FX::EffectInfo & info = WS2812FX::getEffect(m);
+        for (int l = 0; l <= 4; l++) {
+            uint16_t len;
+            if (l < 4) {
+                len = lengths[l];
+                fx.setSegment(0, 0, len);
+            } else {
+                len = 16 * 8;
+                fx.setSegment2D(0, 0, 16, 8, true);
+            }
+            WS2812FX::Segment & seg = fx.getSegment(0);
+            seg.speed = 200;
+            seg.intensity = 200;
+            fx.setMode(0, m);
+            fx.setVirtualClock(0);
+            uint16_t peak = 0;
+            for (int f = 0; f < 64; f++) {
+                fx.advanceClock(FRAME_MS);
+                fx.service();
+                uint16_t used = fx.getSegmentRuntime(0).dataLen();
+                if (used > peak) peak = used;
+            }
+            uint16_t declared = info.dataFor(seg.virtualLength());
+            CHECK(peak <= declared, "mode %d, %u leds%s: allocated %u bytes, the registry declares %u",
+                  m, (unsigned)len, l < 4 ? "" : " (2D)", (unsigned)peak, (unsigned)declared);
+            checked++;
+        }
+    }
+    if (failures == before) printf("data: %d effects on %d segments allocated within their registry entries\n", MODE_COUNT, checked / MODE_COUNT);
+}
+
+int main() {
+    scrollKeepsOpacity();
+    dataSizesDeclared();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
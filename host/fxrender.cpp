@@ -0,0 +1,391 @@
+// Offline renderer for WS2812FX shows: runs the configured segments and effects on a
+// virtual clock, faster than real time, and writes the frames as raw rgb, a PPM or a PNG
+// strip (one row of pixels per frame).
+//
+// The show is cut into time windows, each rendered by its own WS2812FX instance on a
+// thread of its own. A window starts PREROLL_MS early so the effects settle; the frames
+// of that pre-roll must match the end of the window before, or the show does not only
+// depend on the time (random effects, effects that accumulate state) and is rendered
+// again from the start on one thread.
+//
+// With -b it benchmarks instead: every effect on the configured strip, a mode per
+// thread, reporting the frames each renders per second of CPU time.
+//
+//   fxrender -n 300 -s 0:150:9 -s 150:300:66:200:128:11 -d 60 -o show.png
+//   fxrender -n 300 -d 10 -b
+
+#include "FX.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PREROLL_MS 2000
+
+struct SegmentConfig {
+    uint16_t start, stop;
+    uint8_t mode, speed, intensity, palette;
+};
+
+struct Show {
+    uint16_t leds = 300;
+    std::vector<SegmentConfig> segments;
+    uint32_t colors[NUM_COLORS] = { DEFAULT_COLOR, 0x000000, 0x000000 };
+    uint8_t brightness = 255;
+    uint16_t milliamps = 0;         // current limit, 0 for none
+    uint16_t fps = FX_FPS;
+    uint16_t seed = 1337;
+
+    uint32_t frameMs(uint32_t frame) const { return (uint64_t)frame * 1000 / fps; }
+    size_t frameSize() const { return leds * 3; }
+};
+
+// -- Effect frames the instance serviced on this thread has shown
+static __thread uint32_t tShown;
+static void countShown() { tShown++; }
+
+// -- One WS2812FX instance rendering the show from a given frame on
+class Renderer {
+    WS2812FX mFx;
+    std::vector<CRGB> mLeds;
+    const Show & mShow;
+    uint32_t mFrame;
+    uint32_t mMs;
+public:
+    Renderer(const Show & show, uint32_t first) : mLeds(show.leds), mShow(show), mFrame(first), mMs(show.frameMs(first)) {
+        mFx.init(show.leds, mLeds.data(), false);
+        mFx.setVirtualClock(mMs, show.seed);   // -- before anything can show a frame, which must not reach FastLED
+        mFx.setShowCallback(countShown);
+        mFx.setBrightness(show.brightness);
+        mFx.ablMilliampsMax = show.milliamps;
+        for (size_t i = 0; i < show.segments.size(); i++) {
+            const SegmentConfig & c = show.segments[i];
+            mFx.setSegment(i, c.start, c.stop);
+            mFx.setMode(i, c.mode);
+            WS2812FX::Segment & seg = mFx.getSegment(i);
+            seg.speed = c.speed;
+            seg.intensity = c.intensity;
+            seg.palette = c.palette;
+            memcpy(seg.colors, show.colors, sizeof(seg.colors));
+        }
+        mFx.setVirtualClock(mMs, show.seed);   // -- the effects start at the first frame
+    }
+
+    // -- Render the next frame into out, at the brightness it would be shown at
+    void render(uint8_t * out) {
+        uint32_t ms = mShow.frameMs(mFrame++);
+        mFx.advanceClock(ms - mMs);
+        mMs = ms;
+        mFx.service();
+        uint8_t bri = mFx.getShowBrightness();
+        for (size_t i = 0; i < mLeds.size(); i++) {
+            *out++ = scale8(mLeds[i].r, bri);
+            *out++ = scale8(mLeds[i].g, bri);
+            *out++ = scale8(mLeds[i].b, bri);
+        }
+    }
+
+    void skip(uint32_t frames, uint8_t * scratch) {
+        while (frames--) render(scratch);
+    }
+};
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double wallSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -- Run work(i) for i in [0, count) on threads threads
+template <class Work>
+static void parallel(int threads, uint32_t count, Work work) {
+    std::atomic<uint32_t> next(0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.push_back(std::thread([&]() {
+            for (uint32_t i; (i = next++) < count; ) work(i);
+        }));
+    }
+    for (size_t t = 0; t < pool.size(); t++) pool[t].join();
+}
+
+// -- Renders frames [0, frames) into out; false if the windows did not line up
+static bool renderWindows(const Show & show, uint32_t frames, int threads, uint8_t * out, uint32_t * windowsUsed) {
+    size_t size = show.frameSize();
+    uint32_t preroll = show.fps * PREROLL_MS / 1000;
+    uint32_t window = (frames + threads - 1) / threads;
+    if (window < preroll) window = preroll;
+    if (window == 0) window = 1;
+    uint32_t windows = (frames + window - 1) / window;
+    *windowsUsed = windows;
+    // -- The second half of each pre-roll is kept, to compare with the window before
+    uint32_t check = preroll - preroll / 2;
+    std::vector<uint8_t> tails((size_t)windows * check * size);
+
+    parallel(threads, windows, [&](uint32_t w) {
+        uint32_t first = w * window;
+        uint32_t last = first + window < frames ? first + window : frames;
+        uint32_t start = w ? first - preroll : first;
+        std::unique_ptr<Renderer> r(new Renderer(show, start));
+        if (w) {
+            std::vector<uint8_t> scratch(size);
+            r->skip(preroll - check, scratch.data());
+            for (uint32_t f = 0; f < check; f++) r->render(&tails[((size_t)w * check + f) * size]);
+        }
+        for (uint32_t f = first; f < last; f++) r->render(out + (size_t)f * size);
+    });
+
+    for (uint32_t w = 1; w < windows; w++) {
+        const uint8_t * shown = out + (size_t)(w * window - check) * size;
+        if (memcmp(shown, &tails[(size_t)w * check * size], (size_t)check * size) != 0) {
+            fprintf(stderr, "frames differ where window %u starts, at %.1f s: the show is not only a function of time,"
+                    " rendering it on one thread\n", w, show.frameMs(w * window) / 1000.0);
+            return false;
+        }
+    }
+    return true;
+}
+
+// -- Output
+
+static void put32be(std::vector<uint8_t> & v, uint32_t x) {
+    v.push_back(x >> 24); v.push_back(x >> 16); v.push_back(x >> 8); v.push_back(x);
+}
+
+static uint32_t crc32(const uint8_t * p, size_t n, uint32_t crc = 0) {
+    static uint32_t table[256];
+    if (!table[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    crc = ~crc;
+    while (n--) crc = table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void writeChunk(FILE * f, const char * type, const std::vector<uint8_t> & data) {
+    std::vector<uint8_t> c;
+    put32be(c, data.size());
+    c.insert(c.end(), type, type + 4);
+    c.insert(c.end(), data.begin(), data.end());
+    put32be(c, crc32(&c[4], c.size() - 4));
+    fwrite(c.data(), 1, c.size(), f);
+}
+
+// -- A PNG with the image data in stored (uncompressed) deflate blocks, no zlib needed
+static void writePng(FILE * f, const uint8_t * rgb, uint32_t width, uint32_t height) {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    fwrite(signature, 1, sizeof(signature), f);
+
+    std::vector<uint8_t> ihdr;
+    put32be(ihdr, width);
+    put32be(ihdr, height);
+    ihdr.push_back(8);      // bits per channel
+    ihdr.push_back(2);      // rgb
+    ihdr.push_back(0); ihdr.push_back(0); ihdr.push_back(0);
+    writeChunk(f, "IHDR", ihdr);
+
+    // -- Rows with filter type 0 in front
+    std::vector<uint8_t> raw;
+    raw.reserve((size_t)height * (width * 3 + 1));
+    for (uint32_t y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + (size_t)y * width * 3, rgb + (size_t)(y + 1) * width * 3);
+    }
+
+    std::vector<uint8_t> z;
+    z.push_back(0x78);
+    z.push_back(0x01);
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < raw.size(); i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    size_t pos = 0;
+    do {
+        size_t n = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+        z.push_back(pos + n == raw.size());
+        z.push_back(n & 0xFF); z.push_back(n >> 8);
+        z.push_back(~n & 0xFF); z.push_back((~n >> 8) & 0xFF);
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+        pos += n;
+    } while (pos < raw.size());
+    put32be(z, (b << 16) | a);
+
+    // -- In IDAT chunks of at most 1 MB
+    for (size_t p = 0; p < z.size(); p += 1 << 20) {
+        size_t n = z.size() - p < (1 << 20) ? z.size() - p : (1 << 20);
+        writeChunk(f, "IDAT", std::vector<uint8_t>(z.begin() + p, z.begin() + p + n));
+    }
+    writeChunk(f, "IEND", std::vector<uint8_t>());
+}
+
+static bool endsWith(const std::string & s, const char * suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static bool writeFrames(const std::string & path, const Show & show, const uint8_t * frames, uint32_t count) {
+    FILE * f = path == "-" ? stdout : fopen(path.c_str(), "wb");
+    if (!f) {
+        perror(path.c_str());
+        return false;
+    }
+    if (endsWith(path, ".png")) {
+        writePng(f, frames, show.leds, count);
+    } else {
+        if (endsWith(path, ".ppm")) fprintf(f, "P6\n%u %u\n255\n", show.leds, count);
+        fwrite(frames, show.frameSize(), count, f);
+    }
+    bool ok = !ferror(f);
+    if (f != stdout) ok = fclose(f) == 0 && ok;
+    return ok;
+}
+
+// -- The name of mode m, from the list the web UI gets
+static std::string modeName(uint8_t m) {
+    const char * p = JSON_mode_names;
+    for (int i = 0; (p = strchr(p, '"')) != NULL; i++) {
+        const char * end = strchr(p + 1, '"');
+        if (i == m) return std::string(p + 1, end);
+        p = end + 1;
+    }
+    return "?";
+}
+
+static void bench(const Show & show, uint32_t frames, int threads) {
+    struct Result { uint32_t shown; double seconds; };
+    std::vector<Result> results(MODE_COUNT);
+    double wall = wallSeconds();
+    parallel(threads, MODE_COUNT, [&](uint32_t m) {
+        Show s = show;
+        for (size_t i = 0; i < s.segments.size(); i++) s.segments[i].mode = m;
+        std::vector<uint8_t> frame(s.frameSize());
+        tShown = 0;
+        double t = cpuSeconds();
+        std::unique_ptr<Renderer> r(new Renderer(s, 0));
+        r->skip(frames, frame.data());
+        results[m].seconds = cpuSeconds() - t;
+        results[m].shown = tShown;
+    });
+    wall = wallSeconds() - wall;
+
+    uint64_t shown = 0;
+    printf("mode name                  frames   us/frame    frames/s\n");
+    for (int m = 0; m < MODE_COUNT; m++) {
+        const Result & r = results[m];
+        double us = r.shown ? r.seconds * 1e6 / r.shown : 0;
+        printf("%4d %-20s %8u %10.1f %11.0f\n", m, modeName(m).c_str(), (unsigned)r.shown, us, us ? 1e6 / us : 0);
+        shown += r.shown;
+    }
+    printf("%d effects, %u leds, %u frames each on %d threads: %.2f s, %.0f frames/s\n",
+           MODE_COUNT, show.leds, (unsigned)frames, threads, wall, shown / wall);
+}
+
+static void usage() {
+    fprintf(stderr,
+        "usage: fxrender [options] -o out.png|out.ppm|out.raw|-\n"
+        "       fxrender [options] -b\n"
+        "  -n LEDS          strip length (300)\n"
+        "  -s START:STOP:MODE[:SPEED[:INTENSITY[:PALETTE]]]\n"
+        "                   a segment, up to %d; the whole strip in mode 0 if none\n"
+        "  -c RRGGBB[,RRGGBB[,RRGGBB]]  segment colors\n"
+        "  -B BRIGHTNESS    (255)\n"
+        "  -a MILLIAMPS     current limit, 0 for none (0)\n"
+        "  -d SECONDS       length of the show (10)\n"
+        "  -f FPS           frames a second (%d)\n"
+        "  -r SEED          random seed of the effects (1337)\n"
+        "  -j THREADS       (all cores)\n"
+        "  -o FILE          frames as a PNG or PPM, one row a frame, or raw rgb\n"
+        "  -b               frames per second of every effect instead\n",
+        MAX_NUM_SEGMENTS, FX_FPS);
+}
+
+int main(int argc, char ** argv) {
+    Show show;
+    double seconds = 10;
+    int threads = std::thread::hardware_concurrency();
+    std::string out;
+    bool benchmark = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:s:c:B:a:d:f:r:j:o:bh")) != -1) {
+        switch (opt) {
+        case 'n': show.leds = atoi(optarg); break;
+        case 's': {
+            unsigned v[6] = { 0, 0, 0, DEFAULT_SPEED, 128, 0 };
+            int n = sscanf(optarg, "%u:%u:%u:%u:%u:%u", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]);
+            if (n < 3 || v[2] >= MODE_COUNT || show.segments.size() == MAX_NUM_SEGMENTS) {
+                usage();
+                return 2;
+            }
+            SegmentConfig c = { (uint16_t)v[0], (uint16_t)v[1], (uint8_t)v[2], (uint8_t)v[3], (uint8_t)v[4], (uint8_t)v[5] };
+            show.segments.push_back(c);
+            break;
+        }
+        case 'c': {
+            char * p = optarg;
+            for (int i = 0; i < NUM_COLORS && *p; i++) {
+                show.colors[i] = strtoul(p, &p, 16);
+                if (*p == ',') p++;
+            }
+            break;
+        }
+        case 'B': show.brightness = atoi(optarg); break;
+        case 'a': show.milliamps = atoi(optarg); break;
+        case 'd': seconds = atof(optarg); break;
+        case 'f': show.fps = atoi(optarg); break;
+        case 'r': show.seed = atoi(optarg); break;
+        case 'j': threads = atoi(optarg); break;
+        case 'o': out = optarg; break;
+        case 'b': benchmark = true; break;
+        default: usage(); return 2;
+        }
+    }
+    if (show.leds == 0 || show.fps == 0 || seconds <= 0 || (out.empty() && !benchmark)) {
+        usage();
+        return 2;
+    }
+    if (threads < 1) threads = 1;
+    if (show.segments.empty()) {
+        SegmentConfig c = { 0, show.leds, 0, DEFAULT_SPEED, 128, 0 };
+        show.segments.push_back(c);
+    }
+    uint32_t frames = seconds * show.fps;
+    if (frames == 0) frames = 1;
+
+    if (benchmark) {
+        bench(show, frames, threads);
+        return 0;
+    }
+
+    std::vector<uint8_t> rendered((size_t)frames * show.frameSize());
+    double wall = wallSeconds();
+    uint32_t windows = 1;
+    if (threads == 1 || !renderWindows(show, frames, threads, rendered.data(), &windows)) {
+        windows = 1;
+        Renderer r(show, 0);
+        for (uint32_t f = 0; f < frames; f++) r.render(&rendered[(size_t)f * show.frameSize()]);
+    }
+    wall = wallSeconds() - wall;
+    fprintf(stderr, "%u frames of %u leds in %u windows on %d threads: %.2f s, %.0f frames/s, %.0fx real time\n",
+            (unsigned)frames, show.leds, (unsigned)windows, windows > 1 ? threads : 1, wall, frames / wall, seconds / wall);
+
+    return writeFrames(out, show, rendered.data(), frames) ? 0 : 1;
+}
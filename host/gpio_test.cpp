@@ -0,0 +1,169 @@
+// Pin group checks, against a recorder that stands in for the GPIO registers and logs
+// every store to the set and clear registers of both banks, in order:
+//
+// - FastPinGroup: the masks each bank gets for the whole group and for some lanes,
+//   and a store per bank per edge, none to a bank without pins of the group.
+// - the block clockless output on FASTLED_ESP32_BLOCK_PINS (this test is built once
+//   with the default pins 12-15 and once with 12, 32, 13, 33): every bit slot is a
+//   rising edge for all lanes, then the lanes sending a 0 fall, then all of them,
+//   each edge a store per bank, and the bits read back from the falling edges are
+//   the pixels of each lane.
+
+#include "esp_host.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+enum { W1TS0, W1TC0, W1TS1, W1TC1 };
+
+struct Write {
+    int reg;
+    uint32_t value;
+};
+static std::vector<Write> gWrites;
+
+// -- A set or clear register: the store is logged rather than kept. Its address (sport(),
+//    cport()) is of a word nothing reads
+struct RecordedReg {
+    int reg;
+    uint32_t unused;
+    void operator=(uint32_t value) { gWrites.push_back(Write{ reg, value }); }
+    volatile uint32_t * operator&() { return &unused; }
+};
+
+// -- What fastpin_esp32.h uses of gpio_dev_t
+struct GpioRecorder {
+    uint32_t out;
+    RecordedReg out_w1ts, out_w1tc;
+    struct { uint32_t val; } out1;
+    struct { RecordedReg val; } out1_w1ts, out1_w1tc;
+};
+static GpioRecorder gRecorder = { 0, { W1TS0, 0 }, { W1TC0, 0 }, { 0 }, { { W1TS1, 0 } }, { { W1TC1, 0 } } };
+#define GPIO gRecorder
+
+#include "FastLED.h"
+#include "platforms/esp/32/clockless_block_esp32.h"
+
+#define LANES 4
+#define LEDS_PER_LANE 5
+#define T1 C_NS(250)
+#define T2 C_NS(625)
+#define T3 C_NS(375)
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static bool wrote(size_t i, int reg, uint32_t value) {
+    return i < gWrites.size() && gWrites[i].reg == reg && gWrites[i].value == value;
+}
+
+static void groups() {
+    int before = failures;
+    typedef FastPinGroup<12, 13, 32, 33> Both;
+    gWrites.clear();
+    Both::hi();
+    Both::lo();
+    CHECK(gWrites.size() == 4 && wrote(0, W1TS0, 0x3000) && wrote(1, W1TS1, 0x3) && wrote(2, W1TC0, 0x3000) &&
+          wrote(3, W1TC1, 0x3), "12,13,32,33: hi() and lo() should store 0x3000 and 0x3 in each bank");
+
+    // -- Lane i is the i-th pin: lanes 0 and 2 are GPIO 12 and 32
+    gWrites.clear();
+    Both::hi(0x5);
+    Both::lo(0xA);
+    CHECK(gWrites.size() == 4 && wrote(0, W1TS0, 0x1000) && wrote(1, W1TS1, 0x1) && wrote(2, W1TC0, 0x2000) &&
+          wrote(3, W1TC1, 0x2), "12,13,32,33: lanes 0,2 high, 1,3 low should be 0x1000/0x1, 0x2000/0x2");
+    gWrites.clear();
+    Both::lo(0);
+    CHECK(gWrites.size() == 2 && wrote(0, W1TC0, 0) && wrote(1, W1TC1, 0), "12,13,32,33: lo(0) should store 0 in each bank");
+
+    typedef FastPinGroup<15, 4, 21> Low;
+    gWrites.clear();
+    Low::hi();
+    Low::lo(0x2);
+    CHECK(gWrites.size() == 2 && wrote(0, W1TS0, 0x208010) && wrote(1, W1TC0, 0x10),
+          "15,4,21: one store per edge on bank 0 only");
+
+    typedef FastPinGroup<33, 32> High;
+    gWrites.clear();
+    High::hi(0x1);
+    High::lo();
+    CHECK(gWrites.size() == 2 && wrote(0, W1TS1, 0x2) && wrote(1, W1TC1, 0x3), "33,32: one store per edge on bank 1 only");
+    CHECK(Both::mask0() == 0x3000 && Both::mask1() == 0x3 && Low::mask1() == 0 && High::mask0() == 0,
+          "compile time masks");
+    if (failures == before) printf("groups: masks per bank, one store per bank per edge\n");
+}
+
+typedef InlineBlockClocklessController<LANES, 12, T1, T2, T3, GRB> Block;
+typedef FastPinGroup<FASTLED_ESP32_BLOCK_PINS> BlockPins;
+
+static void block() {
+    static CRGB leds[LANES * LEDS_PER_LANE];
+    for (int i = 0; i < LANES * LEDS_PER_LANE; i++) leds[i] = CRGB(i * 37 + 11, 255 - i * 13, i * 71);
+    CRGB scale(255, 255, 255);
+
+    // -- Without interrupts to hold off, the host can still be scheduled away in the
+    //    middle: the frame is then punted, as on the ESP32, and sent again
+    for (int attempt = 0; ; attempt++) {
+        gWrites.clear();
+        PixelController<GRB, LANES, (1 << LANES) - 1> pixels(leds, LEDS_PER_LANE, scale, DISABLE_DITHER);
+        if (Block::showRGBInternal(pixels)) break;
+        if (attempt == 100) {
+            CHECK(false, "block: punted 100 times");
+            return;
+        }
+    }
+
+    int before = failures;
+    uint32_t all0 = BlockPins::mask0(), all1 = BlockPins::mask1();
+    int banks = (all0 != 0) + (all1 != 0);
+    int slots = LEDS_PER_LANE * 24;
+    CHECK((int)gWrites.size() == slots * 3 * banks, "block: %d stores, expected %d bit slots of %d", (int)gWrites.size(),
+          slots, 3 * banks);
+    if (failures != before) return;
+
+    uint8_t bytes[LANES][LEDS_PER_LANE * 3];
+    memset(bytes, 0, sizeof(bytes));
+    for (int s = 0; s < slots; s++) {
+        const Write * w = &gWrites[s * 3 * banks];
+        // -- Per edge, bank 0 then bank 1, as far as the group has pins on them
+        int k = 0;
+        if (all0) CHECK(wrote(s * 3 * banks + k++, W1TS0, all0), "block: slot %d does not rise on bank 0", s);
+        if (all1) CHECK(wrote(s * 3 * banks + k++, W1TS1, all1), "block: slot %d does not rise on bank 1", s);
+        uint32_t zeros0 = 0, zeros1 = 0;
+        if (all0) { CHECK(w[k].reg == W1TC0 && !(w[k].value & ~all0), "block: slot %d, zeros not on bank 0", s); zeros0 = w[k++].value; }
+        if (all1) { CHECK(w[k].reg == W1TC1 && !(w[k].value & ~all1), "block: slot %d, zeros not on bank 1", s); zeros1 = w[k++].value; }
+        if (all0) CHECK(wrote(s * 3 * banks + k++, W1TC0, all0), "block: slot %d does not fall on bank 0", s);
+        if (all1) CHECK(wrote(s * 3 * banks + k++, W1TC1, all1), "block: slot %d does not fall on bank 1", s);
+        if (failures != before) return;
+
+        for (int lane = 0; lane < LANES; lane++) {
+            bool zeroBit = (BlockPins::mask0(1 << lane) & zeros0) || (BlockPins::mask1(1 << lane) & zeros1);
+            if (!zeroBit) bytes[lane][s / 8] |= 0x80 >> (s % 8);
+        }
+    }
+
+    int bad = 0;
+    for (int lane = 0; lane < LANES; lane++) {
+        for (int p = 0; p < LEDS_PER_LANE; p++) {
+            const CRGB & c = leds[lane * LEDS_PER_LANE + p];
+            // -- GRB
+            if (bytes[lane][p * 3] != c.g || bytes[lane][p * 3 + 1] != c.r || bytes[lane][p * 3 + 2] != c.b) bad++;
+        }
+    }
+    CHECK(bad == 0, "block: %d leds read back unlike the pixels", bad);
+    if (failures == before) {
+        printf("block on %d bank%s: %d bit slots of %d stores, every lane reads back its pixels\n", banks,
+               banks > 1 ? "s" : "", slots, 3 * banks);
+    }
+}
+
+int main() {
+    groups();
+    block();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
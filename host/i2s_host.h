@@ -0,0 +1,73 @@
+#ifndef __INC_I2S_HOST_H
+#define __INC_I2S_HOST_H
+
+// The I2S DMA engine, for host programs that run the I2S driver (clockless_i2s_esp32.h).
+// Include it after FastLED.h in the file that adds the controllers: it reads the
+// driver's buffers, which are statics of that file.
+//
+// A thread plays the engine. When show() enables the interrupt, it sends the buffers
+// from dmaBuffers[0] along the descriptor chain, hands each one to the program and
+// raises the end-of-frame interrupt, so the driver refills it. It stops after the
+// buffer sent once fillBuffer() found nothing left, where the hardware goes on with
+// a stale buffer until i2sStop(). bufferUs makes every buffer take that long, as it
+// does on the wire.
+
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+
+// -- A buffer as it was sent: the frame, the buffer's place in it, and its words, one
+//    pulse of every lane each (lane i at bit i + 8)
+typedef void (*I2SHostSink)(void * arg, int frame, int index, const uint32_t * words, int count);
+
+class I2SHost {
+    I2SHostSink mSink;
+    void * mArg;
+    uint32_t mBufferUs;
+    std::atomic<bool> mStop;
+    std::atomic<int> mFrames;
+    std::thread mThread;
+
+    void run() {
+        while (!mStop) {
+            if (host_intr_enables(ETS_I2S0_INTR_SOURCE) <= (uint32_t)mFrames) {
+                usleep(20);
+                continue;
+            }
+            DMABuffer * b = dmaBuffers[0];
+            for (int index = 0; ; index++) {
+                bool last = gDoneFilling;
+                mSink(mArg, mFrames, index, (const uint32_t *)b->descriptor.buf, b->descriptor.length / 4);
+                if (mBufferUs) usleep(mBufferUs);
+                // -- Counted before the interrupt that lets show() return
+                if (last) mFrames++;
+                I2S0.int_st.out_eof = 1;
+                host_intr_raise(ETS_I2S0_INTR_SOURCE);
+                if (last) break;
+                b = (DMABuffer *)b->descriptor.qe.stqe_next;
+            }
+        }
+    }
+
+public:
+    I2SHost(I2SHostSink sink, void * arg, uint32_t bufferUs = 0)
+        : mSink(sink), mArg(arg), mBufferUs(bufferUs), mStop(false), mFrames(0) {
+        mThread = std::thread(&I2SHost::run, this);
+    }
+
+    ~I2SHost() {
+        mStop = true;
+        mThread.join();
+    }
+
+    int frames() const { return mFrames; }
+
+    // -- Length of a pulse as the driver set up the clock, in ns
+    static double pulseNs() {
+        double div = I2S0.clkm_conf.clkm_div_num;
+        if (I2S0.clkm_conf.clkm_div_a) div += (double)I2S0.clkm_conf.clkm_div_b / I2S0.clkm_conf.clkm_div_a;
+        return 1e9 / I2S_BASE_CLK * div;
+    }
+};
+
+#endif
@@ -0,0 +1,296 @@
+// I2S driver checks, against the DMA engine in i2s_host.h:
+//
+// - mixed chipsets: every mix shows random frames in a child process of its own (the
+//   driver keeps its controllers for good). Each lane is decoded from the pulses sent
+//   and must give back its pixels in its color order, zeros past its end, with high
+//   and low times inside the window of its chipset: the datasheet limits for WS2812
+//   and SK6812, else FASTLED_I2S_MIXED_TOLERANCE_NS around its own times. One mix has
+//   a single chipset, which takes the initBitPatterns() path.
+// - a mix that no grid keeps inside its windows is refused by i2sMixedGrid(), naming
+//   the lane, and the same mix with a wider window is not.
+// - a pixel producer, with the engine held back until the producer has the row the
+//   interrupt handler fills next: no underruns and every row of the frame, except
+//   one chunk whose producer call waits for the handler to fill it first, which must
+//   count as 16 underruns (and add up in totalUnderruns) and go out as the previous
+//   frame. The latency hook gets every frame.
+
+#include "FastLED.h"
+#include "i2s_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_LANES 4
+#define MAX_ROWS 64
+#define FRAMES 3
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+// -- A chipset: its timing in ESP32 cycles and its windows in ns, 0 for the tolerance
+struct Chip {
+    const char * name;
+    int T1, T2, T3;
+    int t0hMin, t0hMax, t1hMin, t1hMax, tlMin;
+};
+
+static const Chip ws2812 = { "WS2812", C_NS(250), C_NS(625), C_NS(375), WS2812Limits::T0H_MIN, WS2812Limits::T0H_MAX,
+                             WS2812Limits::T1H_MIN, WS2812Limits::T1H_MAX, WS2812Limits::TL_MIN };
+static const Chip sk6812 = { "SK6812", C_NS(300), C_NS(300), C_NS(600), SK6812Limits::T0H_MIN, SK6812Limits::T0H_MAX,
+                             SK6812Limits::T1H_MIN, SK6812Limits::T1H_MAX, SK6812Limits::TL_MIN };
+static const Chip ws2811 = { "WS2811", C_NS(320), C_NS(320), C_NS(640) };
+static const Chip ws2811_400 = { "WS2811_400", C_NS(800), C_NS(800), C_NS(900) };
+static const Chip tm1809 = { "TM1809", C_NS(350), C_NS(350), C_NS(450) };
+static const Chip ucs1903 = { "UCS1903", C_NS(500), C_NS(1500), C_NS(500) };
+
+template <template <uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t PIN, EOrder ORDER>
+static void add(CRGB * leds, int n) { FastLED.addLeds<CHIPSET, PIN, ORDER>(leds, n); }
+
+struct Lane {
+    void (*add)(CRGB * leds, int n);
+    const Chip * chip;
+    EOrder order;
+    int length;
+};
+
+struct Mix {
+    const char * name;
+    Lane lanes[MAX_LANES];
+};
+
+static const Mix mixes[] = {
+    { "WS2812 x3", { { add<WS2812, 12, GRB>, &ws2812, GRB, 40 }, { add<WS2812, 13, GRB>, &ws2812, GRB, 64 },
+                     { add<WS2812, 14, RGB>, &ws2812, RGB, 7 } } },
+    { "WS2812+WS2811", { { add<WS2812, 12, GRB>, &ws2812, GRB, 50 }, { add<WS2811, 13, RGB>, &ws2811, RGB, 37 } } },
+    { "WS2812+SK6812", { { add<WS2812, 12, GRB>, &ws2812, GRB, 23 }, { add<SK6812, 13, GRB>, &sk6812, GRB, 64 } } },
+    { "WS2812+WS2811+SK6812+TM1809", { { add<WS2812, 12, GRB>, &ws2812, GRB, 64 }, { add<WS2811, 13, RGB>, &ws2811, RGB, 50 },
+                                       { add<SK6812, 14, GRB>, &sk6812, GRB, 1 }, { add<TM1809, 15, RBG>, &tm1809, RBG, 33 } } },
+    { "WS2812+WS2811_400", { { add<WS2812, 12, GRB>, &ws2812, GRB, 30 }, { add<WS2811_400, 13, RGB>, &ws2811_400, RGB, 45 } } },
+    { "WS2811+WS2811_400+UCS1903", { { add<WS2811, 12, RGB>, &ws2811, RGB, 64 }, { add<WS2811_400, 13, BRG>, &ws2811_400, BRG, 20 },
+                                     { add<UCS1903, 14, RGB>, &ucs1903, RGB, 48 } } },
+};
+
+// -- The window a lane must stay in
+static Chip window(const Chip & c) {
+    Chip w = c;
+    if (w.t0hMax == 0) {
+        int t0h = ESPCLKS_TO_NS(c.T1), t1h = ESPCLKS_TO_NS(c.T1 + c.T2);
+        w.t0hMin = t0h - FASTLED_I2S_MIXED_TOLERANCE_NS;
+        w.t0hMax = t0h + FASTLED_I2S_MIXED_TOLERANCE_NS;
+        w.t1hMin = t1h - FASTLED_I2S_MIXED_TOLERANCE_NS;
+        w.t1hMax = t1h + FASTLED_I2S_MIXED_TOLERANCE_NS;
+        w.tlMin = ESPCLKS_TO_NS(c.T3) - FASTLED_I2S_MIXED_TOLERANCE_NS;
+    }
+    return w;
+}
+
+// -- What the engine sent in a frame, decoded: one buffer is one row of every lane
+static const Mix * gMix;
+static int gNumLanes;
+static CRGB gLeds[MAX_LANES][MAX_ROWS];
+static uint8_t gGot[MAX_LANES][MAX_ROWS][3];
+static int gRows;
+static int gBadTimes;
+static double gWorstMargin;
+
+static void decode(void * arg, int frame, int index, const uint32_t * words, int count)
+{
+    int pulses = count / (8 * NUM_COLOR_CHANNELS);
+    double pulse = I2SHost::pulseNs();
+    gRows = index + 1;
+    if (index >= MAX_ROWS) return;
+    for (int l = 0; l < gNumLanes; l++) {
+        Chip w = window(*gMix->lanes[l].chip);
+        uint32_t mask = 1 << (l + 8);
+        for (int c = 0; c < NUM_COLOR_CHANNELS; c++) {
+            uint8_t byte = 0;
+            for (int b = 0; b < 8; b++) {
+                const uint32_t * bit = &words[(c * 8 + b) * pulses];
+                int high = 0;
+                while (high < pulses && (bit[high] & mask)) high++;
+                bool clean = high > 0;
+                for (int p = high; p < pulses; p++) {
+                    if (bit[p] & mask) clean = false;
+                }
+                double h = high * pulse, low = (pulses - high) * pulse;
+                bool one = h > (w.t0hMax + w.t1hMin) / 2.0;
+                double m = one ? (h - w.t1hMin < w.t1hMax - h ? h - w.t1hMin : w.t1hMax - h)
+                               : (h - w.t0hMin < w.t0hMax - h ? h - w.t0hMin : w.t0hMax - h);
+                if (low - w.tlMin < m) m = low - w.tlMin;
+                if (m < gWorstMargin) gWorstMargin = m;
+                if (!clean || m < 0) gBadTimes++;
+                byte = (byte << 1) | one;
+            }
+            gGot[l][index][c] = byte;
+        }
+    }
+}
+
+static int runMix(const void * arg)
+{
+    const Mix & mix = *(const Mix *)arg;
+    gMix = &mix;
+    gNumLanes = 0;
+    int rows = 0;
+    while (gNumLanes < MAX_LANES && mix.lanes[gNumLanes].add) {
+        const Lane & lane = mix.lanes[gNumLanes];
+        lane.add(gLeds[gNumLanes], lane.length);
+        if (lane.length > rows) rows = lane.length;
+        gNumLanes++;
+    }
+    FastLED.setDither(DISABLE_DITHER);
+    I2SHost engine(decode, NULL);
+
+    srand(116);
+    gWorstMargin = 1e9;
+    for (int f = 0; f < FRAMES; f++) {
+        for (int l = 0; l < gNumLanes; l++) {
+            for (int i = 0; i < MAX_ROWS; i++) gLeds[l][i] = CRGB(rand() & 0xFF, rand() & 0xFF, rand() & 0xFF);
+        }
+        gBadTimes = 0;
+        FastLED.show();
+        CHECK(gRows == rows, "%s, frame %d: %d rows sent for %d", mix.name, f, gRows, rows);
+        CHECK(gBadTimes == 0, "%s, frame %d: %d bits outside their chipset's window", mix.name, f, gBadTimes);
+        for (int l = 0; l < gNumLanes; l++) {
+            const Lane & lane = mix.lanes[l];
+            int bad = -1;
+            for (int i = 0; i < rows && i < MAX_ROWS && bad < 0; i++) {
+                for (int c = 0; c < NUM_COLOR_CHANNELS; c++) {
+                    int k = (lane.order >> (3 * (2 - c))) & 0x3;
+                    uint8_t expect = i < lane.length ? gLeds[l][i].raw[k] : 0;
+                    if (gGot[l][i][c] != expect) bad = i;
+                }
+            }
+            CHECK(bad < 0, "%s, frame %d: lane %d (%s) decodes wrong at row %d", mix.name, f, l, lane.chip->name, bad);
+        }
+    }
+    CHECK(engine.frames() == FRAMES, "%s: the engine sent %d frames for %d", mix.name, engine.frames(), FRAMES);
+    if (!failures) {
+        printf("%s: %d pulses of %.1f ns a bit, %d ns to spare on the tightest lane\n", mix.name, gPulsesPerBit,
+               I2SHost::pulseNs(), (int)gWorstMargin);
+    }
+    return failures;
+}
+
+// -- Producer: rows [gStallFrom, gStallUntil) are rendered only after the interrupt
+//    handler has filled them
+#define PRODUCER_ROWS 64
+#define PRODUCER_CHUNK 16
+
+static const Mix producerMix = { "producer", { { add<WS2812, 12, GRB>, &ws2812, GRB, PRODUCER_ROWS } } };
+static int gFrame;
+static int gStallFrom, gStallUntil;
+static int gHookCalls;
+static I2SStreamStats gHookStats;
+
+static CRGB producerPixel(int frame, int row) { return CRGB(0x80 | frame, row, 0xA5); }
+
+static void renderRows(void * arg, int start, int count)
+{
+    if (start >= gStallFrom && start < gStallUntil) {
+        while (gRowsFilled < gStallUntil) usleep(20);
+    }
+    for (int i = start; i < start + count; i++) gLeds[0][i] = producerPixel(gFrame, i);
+}
+
+static void latency(void * arg, const I2SStreamStats & stats)
+{
+    gHookCalls++;
+    gHookStats = stats;
+}
+
+// -- After a buffer is sent, the handler fills the row NUM_DMA_BUFFERS ahead: wait
+//    for the producer to have it, except in the stalled chunk
+static void decodeHeld(void * arg, int frame, int index, const uint32_t * words, int count)
+{
+    decode(arg, frame, index, words, count);
+    int next = index + NUM_DMA_BUFFERS;
+    if (next >= gStallFrom && next < gStallUntil) return;
+    while (gRowsReady <= next && gRowsReady < PRODUCER_ROWS) usleep(20);
+}
+
+static int runProducer(const void * arg)
+{
+    const Mix & mix = producerMix;
+    gMix = &mix;
+    gNumLanes = 1;
+    mix.lanes[0].add(gLeds[0], PRODUCER_ROWS);
+    FastLED.setDither(DISABLE_DITHER);
+    i2sSetPixelProducer(renderRows, NULL, PRODUCER_CHUNK);
+    i2sSetLatencyHook(latency, NULL);
+    I2SHost engine(decodeHeld, NULL);
+
+    uint32_t total = 0;
+    for (gFrame = 0; gFrame < 2 * FRAMES; gFrame++) {
+        // -- Every other frame has its second chunk stalled
+        bool stall = gFrame & 1;
+        gStallFrom = stall ? PRODUCER_CHUNK : 0;
+        gStallUntil = stall ? 2 * PRODUCER_CHUNK : 0;
+        FastLED.show();
+
+        uint32_t underruns = i2sGetStreamStats().underruns;
+        total += underruns;
+        CHECK(gRows == PRODUCER_ROWS, "producer, frame %d: %d rows sent for %d", gFrame, gRows, PRODUCER_ROWS);
+        CHECK(underruns == (stall ? PRODUCER_CHUNK : 0), "producer, frame %d: %u underruns", gFrame, underruns);
+        CHECK(i2sGetStreamStats().totalUnderruns == total, "producer, frame %d: %u underruns in total, %u counted",
+              gFrame, i2sGetStreamStats().totalUnderruns, total);
+        int bad = -1;
+        for (int i = 0; i < PRODUCER_ROWS && bad < 0; i++) {
+            bool stale = i >= gStallFrom && i < gStallUntil;
+            CRGB expect = (stale && gFrame == 0) ? CRGB::Black : producerPixel(stale ? gFrame - 1 : gFrame, i);
+            if (gGot[0][i][0] != expect.g || gGot[0][i][1] != expect.r || gGot[0][i][2] != expect.b) bad = i;
+        }
+        CHECK(bad < 0, "producer, frame %d: row %d is not the %s frame", gFrame, bad,
+              bad >= gStallFrom && bad < gStallUntil ? "previous" : "current");
+        CHECK(gHookCalls == gFrame + 1 && gHookStats.underruns == underruns &&
+              gHookStats.firstPixelCycles <= gHookStats.frameCycles,
+              "producer, frame %d: latency hook called %d times, with %u underruns", gFrame, gHookCalls, gHookStats.underruns);
+    }
+    if (!failures) {
+        printf("producer: %d frames of %d rows in chunks of %d, a stalled chunk is %u underruns\n", 2 * FRAMES,
+               PRODUCER_ROWS, PRODUCER_CHUNK, (unsigned)PRODUCER_CHUNK);
+    }
+    return failures;
+}
+
+// -- A lane whose T0H window falls between the multiples of every pulse long enough
+//    for the slow lane's bit (4us in at most 40 pulses)
+static void refused()
+{
+    I2SLaneTiming lanes[2] = {
+        { C_NS(295), C_NS(500), C_NS(500), 290, 299, 700, 900, 300 },
+        i2sLaneTiming(C_NS(1000), C_NS(1000), C_NS(2000)),
+    };
+    I2SMixedGrid grid;
+    CHECK(!i2sMixedGrid(lanes, 2, grid), "refused: a grid was accepted");
+    CHECK(grid.divider != 0 && grid.lane == 0 && grid.margin < 0, "refused: lane %d, %d ns to spare, divider %d",
+          grid.lane, grid.margin, grid.divider);
+    lanes[0].t0hMax = 310;
+    CHECK(i2sMixedGrid(lanes, 2, grid) && grid.margin >= 0, "refused: the wider window is refused too");
+    if (!failures) printf("refused: a T0H window of 290-299 ns, with a 4 us chipset next to it\n");
+}
+
+// -- The driver keeps its controllers for good: every set of them gets a process
+static void inChild(const char * name, int (*run)(const void * arg), const void * arg)
+{
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) exit(run(arg) ? 1 : 0);
+    int status = 0;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0, "%s: failed", name);
+}
+
+int main()
+{
+    for (unsigned m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) inChild(mixes[m].name, runMix, &mixes[m]);
+    refused();
+    inChild(producerMix.name, runProducer, NULL);
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
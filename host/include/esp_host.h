@@ -0,0 +1,224 @@
+#ifndef __INC_ESP_HOST_H
+#define __INC_ESP_HOST_H
+
+// Stand-ins for the ESP-IDF headers FastLED.h and the effects include, so the library
+// builds on a PC. Every ESP-IDF header in this directory includes this one.
+//
+// - the clock, the FreeRTOS tasks, notifications and semaphores, the heap and the log
+//   work as on the ESP32, on top of the C++ library (see esp_host.cpp); the tasks are
+//   threads, with a stack that is painted so uxTaskGetStackHighWaterMark() works
+// - the peripheral registers are plain memory, and the pin setup does nothing. The
+//   interrupt handlers are kept, so a host program can play a peripheral: it reads
+//   what the driver left in memory and raises the interrupt (host_intr_raise()), as
+//   i2s_host.h does for the I2S DMA. The RMT memory can be read the same way
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -- sdkconfig.h
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ 240
+#define CONFIG_FREERTOS_HZ 1000
+
+// -- esp_attr.h, esp_err.h, esp_idf_version.h
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define BIT(x) (1u << (x))
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERROR_CHECK(x) (void)(x)
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 2, 0)
+
+// -- esp_log.h: errors, warnings and info go to stderr
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) fprintf(stderr, "I %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do { } while (0)
+#define ESP_LOGV(tag, format, ...) do { } while (0)
+
+// -- esp_timer.h, esp_system.h
+int64_t esp_timer_get_time(void);
+void esp_restart(void);
+
+// -- freertos
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef int portBASE_TYPE;
+typedef uint32_t TickType_t;
+typedef struct HostTask * TaskHandle_t;
+typedef struct HostSemaphore * SemaphoreHandle_t;
+typedef SemaphoreHandle_t xSemaphoreHandle;
+typedef void (*TaskFunction_t)(void *);
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define portYIELD_FROM_ISR()
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7fffffff
+
+// Tasks are threads; usStackDepth is in bytes, as on the ESP32
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char * pcName, uint32_t usStackDepth,
+                                   void * pvParameters, UBaseType_t uxPriority, TaskHandle_t * pxCreatedTask,
+                                   BaseType_t xCoreID);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+char * pcTaskGetTaskName(TaskHandle_t task);
+BaseType_t xPortGetCoreID(void);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * woken);
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t * woken);
+
+// -- esp32/rom/ets_sys.h: there are no interrupts to hold off
+void ets_intr_lock(void);
+void ets_intr_unlock(void);
+
+// -- esp_heap_caps.h
+#define MALLOC_CAP_8BIT 4
+#define MALLOC_CAP_DMA 8
+#define MALLOC_CAP_DEFAULT 0x1000
+void * heap_caps_malloc(size_t size, uint32_t caps);
+void heap_caps_free(void * ptr);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+
+// -- esp_intr_alloc.h
+typedef void * intr_handle_t;
+typedef void (*intr_handler_t)(void *);
+#define ESP_INTR_FLAG_IRAM 1
+#define ESP_INTR_FLAG_LEVEL3 1
+esp_err_t esp_intr_alloc(int source, int flags, intr_handler_t handler, void * arg, intr_handle_t * handle);
+esp_err_t esp_intr_enable(intr_handle_t handle);
+esp_err_t esp_intr_disable(intr_handle_t handle);
+// Times esp_intr_enable() was called for the source
+uint32_t host_intr_enables(int source);
+// Runs the handler of the source, in this thread, if it is enabled
+bool host_intr_raise(int source);
+
+// -- driver/gpio.h, driver/periph_ctrl.h, soc/*.h
+typedef enum { GPIO_NUM_0 = 0 } gpio_num_t;
+typedef enum { GPIO_MODE_OUTPUT = 2 } gpio_mode_t;
+#define GPIO_MODE_DEF_OUTPUT 2
+#define PIN_FUNC_GPIO 2
+#define PIN_FUNC_SELECT(reg, func) (void)(reg)
+#define SET_PERI_REG_BITS(reg, bits, value, shift)
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode);
+void gpio_matrix_out(uint32_t gpio, uint32_t signal, bool out_inv, bool oen_inv);
+void periph_module_enable(int module);
+extern const uint32_t GPIO_PIN_MUX_REG[40];
+
+typedef struct {
+    uint32_t out, out_w1ts, out_w1tc, enable, enable_w1ts, enable_w1tc, in;
+    union { struct { uint32_t data:8; }; uint32_t val; } out1, out1_w1ts, out1_w1tc, enable1, enable1_w1ts, enable1_w1tc, in1;
+} gpio_dev_t;
+extern volatile gpio_dev_t GPIO;
+
+typedef struct {
+    uint32_t size:12, length:12, offset:5, sosf:1, eof:1, owner:1;
+    volatile uint8_t * buf;
+    union { struct { void * stqe_next; } qe; };
+    void * empty;
+} lldesc_t;
+
+typedef struct {
+    union { struct { uint32_t tx_msb_right:1, tx_mono:1, tx_short_sync:1, tx_msb_shift:1, tx_right_first:1,
+                              tx_slave_mod:1, rx_fifo_reset:1, tx_fifo_reset:1, rx_start:1, tx_start:1; }; uint32_t val; } conf;
+    union { struct { uint32_t lcd_en:1, lcd_tx_wrx2_en:1, lcd_tx_sdx2_en:1; }; uint32_t val; } conf2;
+    union { struct { uint32_t tx_bits_mod:6, tx_bck_div_num:6; }; uint32_t val; } sample_rate_conf;
+    union { struct { uint32_t clka_en:1, clkm_div_a:6, clkm_div_b:6, clkm_div_num:8; }; uint32_t val; } clkm_conf;
+    union { struct { uint32_t tx_fifo_mod_force_en:1, tx_fifo_mod:3, tx_data_num:6, dscr_en:1; }; uint32_t val; } fifo_conf;
+    union { struct { uint32_t tx_stop_en:1, tx_pcm_bypass:1; }; uint32_t val; } conf1;
+    union { struct { uint32_t tx_chan_mod:3; }; uint32_t val; } conf_chan;
+    union { struct { uint32_t unused:1; }; uint32_t val; } timing;
+    union { struct { uint32_t in_rst:1, out_rst:1; }; uint32_t val; } lc_conf;
+    union { struct { uint32_t addr:20, start:1; }; uint32_t val; } out_link;
+    union { struct { uint32_t out_eof:1, out_dscr_err:1; }; uint32_t val; } int_st, int_clr, int_raw, int_ena;
+} i2s_dev_t;
+extern i2s_dev_t I2S0, I2S1;
+#define PERIPH_I2S0_MODULE 0
+#define PERIPH_I2S1_MODULE 1
+#define ETS_I2S0_INTR_SOURCE 0
+#define ETS_I2S1_INTR_SOURCE 1
+#define I2S0O_DATA_OUT0_IDX 0
+#define I2S1O_DATA_OUT0_IDX 0
+#define I2S_INT_ENA_REG(i) 0
+#define I2S_OUT_EOF_INT_ENA_V 1
+#define I2S_OUT_EOF_INT_ENA_S 1
+#define I2S_OUT_DATA_BURST_EN 1
+#define I2S_OUTDSCR_BURST_EN 1
+#define I2S_IN_RST_M 1
+#define I2S_OUT_RST_M 1
+#define I2S_AHBM_RST_M 1
+#define I2S_AHBM_FIFO_RST_M 1
+#define I2S_RX_RESET_M 1
+#define I2S_RX_FIFO_RESET_M 1
+#define I2S_TX_RESET_M 1
+#define I2S_TX_FIFO_RESET_M 1
+
+// -- driver/rmt.h, soc/rmt_struct.h: the RMT memory is plain memory too, so a host
+//    program can start a channel and call fillNext() as the threshold interrupt would
+typedef enum { RMT_CHANNEL_0, RMT_CHANNEL_1, RMT_CHANNEL_2, RMT_CHANNEL_3,
+               RMT_CHANNEL_4, RMT_CHANNEL_5, RMT_CHANNEL_6, RMT_CHANNEL_7, RMT_CHANNEL_MAX } rmt_channel_t;
+typedef enum { RMT_MODE_TX, RMT_MODE_RX } rmt_mode_t;
+typedef enum { RMT_CARRIER_LEVEL_LOW, RMT_CARRIER_LEVEL_HIGH } rmt_carrier_level_t;
+typedef enum { RMT_IDLE_LEVEL_LOW, RMT_IDLE_LEVEL_HIGH } rmt_idle_level_t;
+typedef struct {
+    union { struct { uint32_t duration0:15, level0:1, duration1:15, level1:1; }; uint32_t val; };
+} rmt_item32_t;
+typedef struct {
+    rmt_mode_t rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t gpio_num;
+    uint8_t clk_div;
+    uint8_t mem_block_num;
+    struct { bool loop_en; rmt_carrier_level_t carrier_level; bool carrier_en;
+             rmt_idle_level_t idle_level; bool idle_output_en; } tx_config;
+} rmt_config_t;
+#define RMT_DEFAULT_CONFIG_TX(gpio, channel_id) \
+    { RMT_MODE_TX, channel_id, gpio, 80, 1, { false, RMT_CARRIER_LEVEL_HIGH, true, RMT_IDLE_LEVEL_LOW, true } }
+typedef void (*rmt_tx_end_fn_t)(rmt_channel_t channel, void * arg);
+esp_err_t rmt_config(const rmt_config_t * config);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags);
+esp_err_t rmt_set_tx_thr_intr_en(rmt_channel_t channel, bool en, uint16_t evt_thresh);
+esp_err_t rmt_set_tx_intr_en(rmt_channel_t channel, bool en);
+esp_err_t rmt_set_pin(rmt_channel_t channel, rmt_mode_t mode, gpio_num_t gpio_num);
+esp_err_t rmt_tx_start(rmt_channel_t channel, bool tx_idx_rst);
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t * items, int item_num, bool wait_tx_done);
+void rmt_register_tx_end_callback(rmt_tx_end_fn_t function, void * arg);
+
+typedef struct {
+    struct {
+        union { struct { uint32_t div_cnt:8, idle_thres:16, mem_size:4; }; uint32_t val; } conf0;
+        union { struct { uint32_t tx_start:1, rx_en:1, mem_wr_rst:1, mem_rd_rst:1, apb_mem_rst:1, mem_owner:1; }; uint32_t val; } conf1;
+    } conf_ch[8];
+    union { uint32_t val; } int_raw, int_st, int_ena, int_clr;
+} rmt_dev_t;
+extern volatile rmt_dev_t RMT;
+typedef struct {
+    struct { rmt_item32_t data32[64]; } chan[8];
+} rmt_mem_t;
+extern volatile rmt_mem_t RMTMEM;
+#define ETS_RMT_INTR_SOURCE 2
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
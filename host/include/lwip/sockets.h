@@ -0,0 +1,10 @@
+#ifndef __INC_ESP_HOST_SOCKETS_H
+#define __INC_ESP_HOST_SOCKETS_H
+
+// lwIP's sockets are the BSD ones
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#endif
@@ -0,0 +1,117 @@
+// 2D segments against the 1D path on a 32x32 matrix: a frame of a matrix pattern drawn
+// with setPixelColorXY() on a 2D segment, and with setPixelColor() on a 1D segment of the
+// same leds, rebuilding x and y from the pixel index with % and / as matrix effects do
+// today. Both are timed with rows left to right and with serpentine rows.
+//
+// As a test it checks that both draw the same leds, also on reversed segments; the times
+// are only printed.
+//
+//   matrixbench [frames] [width]
+
+#include "FX.h"
+
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define RUNS 3
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+// -- Read from the command line, as an effect reads it from its configuration, so the
+//    compiler can't turn % and / into shifts
+static uint16_t gWidth = 32, gHeight = 32;
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -- Cheap, so the cost of addressing the pixels shows
+static inline uint32_t pattern(uint16_t x, uint16_t y, uint8_t t) {
+    return ((uint32_t)(uint8_t)(x * 8 + t) << 16) | ((uint32_t)(uint8_t)(y * 8) << 8) | (uint8_t)((x ^ y) * 8);
+}
+
+static void frame1D(WS2812FX & fx, bool serpentine, uint8_t t) {
+    fx.setPixelSegment(0);
+    uint16_t len = gWidth * gHeight;
+    for (uint16_t i = 0; i < len; i++) {
+        uint16_t x = i % gWidth, y = i / gWidth;
+        if (serpentine && (y & 1)) x = gWidth - 1 - x;
+        fx.setPixelColor(i, pattern(x, y, t));
+    }
+}
+
+static void frame2D(WS2812FX & fx, uint8_t t) {
+    fx.setPixelSegment(0);
+    for (uint16_t y = 0; y < gHeight; y++) {
+        for (uint16_t x = 0; x < gWidth; x++) fx.setPixelColorXY(x, y, pattern(x, y, t));
+    }
+}
+
+struct Matrix {
+    std::vector<CRGB> leds;
+    std::unique_ptr<WS2812FX> fx;
+
+    Matrix(bool is2D, bool serpentine, bool reversed) : leds(gWidth * gHeight), fx(new WS2812FX) {
+        fx->init(leds.size(), leds.data(), false);
+        if (is2D) fx->setSegment2D(0, 0, gWidth, gHeight, serpentine);
+        else fx->setSegment(0, 0, leds.size());
+        fx->getSegment(0).setOption(SEG_OPTION_REVERSED, reversed);
+    }
+};
+
+template <class Frame>
+static double usPerFrame(int frames, Frame frame) {
+    double best = 1e9;
+    for (int run = 0; run < RUNS; run++) {
+        double t = cpuSeconds();
+        for (int f = 0; f < frames; f++) frame(f);
+        t = cpuSeconds() - t;
+        if (t < best) best = t;
+    }
+    return best * 1e6 / frames;
+}
+
+static void compare(const char * name, bool serpentine, bool reversed, int frames) {
+    Matrix flat(false, serpentine, reversed), matrix(true, serpentine, reversed);
+    int differ = -1;
+    for (int f = 0; f < 4 && differ < 0; f++) {
+        frame1D(*flat.fx, serpentine, f * 50);
+        frame2D(*matrix.fx, f * 50);
+        if (memcmp(flat.leds.data(), matrix.leds.data(), flat.leds.size() * sizeof(CRGB))) differ = f;
+    }
+    CHECK(differ < 0, "%s%s: frame %d differs between the 1D and the 2D segment", name, reversed ? ", reversed" : "",
+          differ);
+    if (reversed) return;
+
+    double us1D = usPerFrame(frames, [&](int f) { frame1D(*flat.fx, serpentine, f); });
+    double us2D = usPerFrame(frames, [&](int f) { frame2D(*matrix.fx, f); });
+    printf("%-12s %8.1f %8.1f %8.2fx\n", name, us1D, us2D, us1D / us2D);
+}
+
+int main(int argc, char ** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    if (frames < 1) frames = 1;
+    if (argc > 2) gWidth = gHeight = atoi(argv[2]);
+    if (gWidth < 1 || gWidth > 255) gWidth = gHeight = 32;
+
+    printf("%dx%d, best of %d    us/frame\n", gWidth, gHeight, RUNS);
+    printf("layout             1D       2D  speedup\n");
+    compare("rows", false, false, frames);
+    compare("serpentine", true, false, frames);
+    compare("rows", false, true, frames);
+    compare("serpentine", true, true, frames);
+
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("2D segments: the same leds as the 1D path, rows and serpentine, reversed or not\n");
+    return 0;
+}
@@ -0,0 +1,188 @@
+// Simplex noise against the Perlin noise it can stand in for: the time per sample of
+// snoise16 and inoise16, raw and unsigned, in 2d and 3d, and of the 2d fills the noise
+// effects use, then how the values effects get (snoise16 and inoise16) are distributed,
+// so an effect can be switched over knowing what changes.
+//
+// As a test it checks that snoise16 has the spread of inoise16, that the raw values stay
+// in the ranges noise.h documents and are centered, that samples 1/256 apart stay close,
+// and that the fills spread their bytes alike; the times are only printed.
+//
+//   noisebench [samples]
+
+#include "FastLED.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define RUNS 3
+#define BINS 16
+#define FILL_SIZE 32
+#define FILL_FRAMES 200
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -- 16.16 coordinates, spread over a few hundred lattice cells
+static uint32_t gState = 111;
+static uint32_t coordinate() {
+    gState ^= gState << 13;
+    gState ^= gState >> 17;
+    gState ^= gState << 5;
+    return gState & 0x3FFFFFF;
+}
+
+struct Stats {
+    double rawNs, ns;       // -- time per sample of the raw and the unsigned function
+    double mean, sd;
+    int min, max, maxStep;
+    double bins[BINS];      // -- % of the samples in each 1/16 of the range
+};
+
+template <class Noise>
+static double nsPerSample(Noise noise, const std::vector<uint32_t> & xyz) {
+    size_t n = xyz.size() / 3;
+    double best = 1e9;
+    uint32_t sink = 0;
+    for (int run = 0; run < RUNS; run++) {
+        double t = cpuSeconds();
+        for (size_t i = 0; i < n; i++) sink += noise(&xyz[i * 3]);
+        t = cpuSeconds() - t;
+        if (t < best) best = t;
+    }
+    // -- The sum is used, so the loop is not optimized away
+    return best * 1e9 / n + (sink == 1 ? 1e-9 : 0);
+}
+
+// -- The unsigned values, and the times of both functions
+template <class Raw, class Noise>
+static Stats measure(Raw raw, Noise noise, const std::vector<uint32_t> & xyz) {
+    Stats s;
+    memset(&s, 0, sizeof(s));
+    s.rawNs = nsPerSample(raw, xyz);
+    s.ns = nsPerSample(noise, xyz);
+    s.min = 65535;
+    size_t n = xyz.size() / 3;
+    double sum = 0, sum2 = 0;
+    for (size_t i = 0; i < n; i++) {
+        int v = noise(&xyz[i * 3]);
+        sum += v;
+        sum2 += (double)v * v;
+        if (v < s.min) s.min = v;
+        if (v > s.max) s.max = v;
+        s.bins[v * BINS / 65536] += 100.0 / n;
+
+        // -- The next sample 1/256 of a cell along x
+        uint32_t next[3] = { xyz[i * 3] + 256, xyz[i * 3 + 1], xyz[i * 3 + 2] };
+        int step = abs(noise(next) - v);
+        if (step > s.maxStep) s.maxStep = step;
+    }
+    s.mean = sum / n;
+    s.sd = sqrt(sum2 / n - s.mean * s.mean);
+    return s;
+}
+
+static void printStats(const char * name, const Stats & s) {
+    printf("%-12s %5.1f %5.1f %7.0f %6.0f %6d %6d %5d  ", name, s.rawNs, s.ns, s.mean, s.sd, s.min, s.max, s.maxStep);
+    for (int b = 4; b < BINS - 4; b++) printf("%5.1f", s.bins[b]);
+    printf("\n");
+}
+
+// -- snoise16 is raw + 32768, unclamped within the documented range of the raw values
+static void compare(const char * name, const Stats & simplex, const Stats & perlin, int limit) {
+    double ratio = simplex.sd / perlin.sd;
+    CHECK(ratio > 0.97 && ratio < 1.03, "%s: standard deviation %.0f, inoise16 %.0f", name, simplex.sd, perlin.sd);
+    CHECK(fabs(simplex.mean - 32768) < simplex.sd / 20, "%s: mean %.0f", name, simplex.mean);
+    CHECK(simplex.min - 32768 > -limit && simplex.max - 32768 < limit, "%s: raw range %d to %d, noise.h says within +-%d",
+          name, simplex.min - 32768, simplex.max - 32768, limit);
+    CHECK(simplex.maxStep < 1024, "%s: samples 1/256 apart differ by %d", name, simplex.maxStep);
+}
+
+// -- The bytes of a fill over FILL_FRAMES frames: time per frame and share of each 1/8
+template <class Fill>
+static double fillFrames(Fill fill, double bins[8], double * mean) {
+    static uint8_t data[FILL_SIZE * FILL_SIZE];
+    double best = 1e9;
+    for (int run = 0; run < RUNS; run++) {
+        memset(bins, 0, 8 * sizeof(double));
+        *mean = 0;
+        double t = cpuSeconds();
+        for (int f = 0; f < FILL_FRAMES; f++) {
+            memset(data, 0, sizeof(data));
+            fill(data, f);
+            for (int i = 0; i < FILL_SIZE * FILL_SIZE; i++) {
+                bins[data[i] >> 5] += 100.0 / (FILL_SIZE * FILL_SIZE * FILL_FRAMES);
+                *mean += (double)data[i] / (FILL_SIZE * FILL_SIZE * FILL_FRAMES);
+            }
+        }
+        t = cpuSeconds() - t;
+        if (t < best) best = t;
+    }
+    return best * 1e6 / FILL_FRAMES;
+}
+
+static void fills() {
+    printf("\n%dx%d fills, us/frame, mean byte, %% of bytes in each 1/8\n", FILL_SIZE, FILL_SIZE);
+    for (int octaves = 1; octaves <= 3; octaves += 2) {
+        double perlin[8], simplex[8], perlinMean, simplexMean;
+        double perlinUs = fillFrames([&](uint8_t * data, int f) {
+            fill_raw_2dnoise16into8(data, FILL_SIZE, FILL_SIZE, octaves, 0x12345, 3000, 0x54321, 3000, f * 2000);
+        }, perlin, &perlinMean);
+        double simplexUs = fillFrames([&](uint8_t * data, int f) {
+            fill_raw_2dsnoise16into8(data, FILL_SIZE, FILL_SIZE, octaves, 0x12345, 3000, 0x54321, 3000, f * 2000);
+        }, simplex, &simplexMean);
+
+        printf("inoise, %d octave%s %7.1f %5.1f  ", octaves, octaves > 1 ? "s" : " ", perlinUs, perlinMean);
+        for (int b = 0; b < 8; b++) printf("%5.1f", perlin[b]);
+        printf("\nsnoise, %d octave%s %7.1f %5.1f  ", octaves, octaves > 1 ? "s" : " ", simplexUs, simplexMean);
+        for (int b = 0; b < 8; b++) printf("%5.1f", simplex[b]);
+        printf("\n");
+
+        // -- The fills fold the noise around its middle, so the spread shows in the mean
+        CHECK(fabs(simplexMean - perlinMean) < 8, "fill, %d octaves: mean byte %.1f, inoise %.1f", octaves,
+              simplexMean, perlinMean);
+    }
+}
+
+int main(int argc, char ** argv) {
+    int samples = argc > 1 ? atoi(argv[1]) : 500000;
+    if (samples < 1000) samples = 1000;
+    std::vector<uint32_t> xyz(samples * 3);
+    for (size_t i = 0; i < xyz.size(); i++) xyz[i] = coordinate();
+
+    printf("%d samples  ns raw  ns    mean     sd    min    max  step  %% in each 1/16 of the range, 4 to 11\n",
+           samples);
+    Stats p2 = measure([](const uint32_t * c) { return (int)inoise16_raw(c[0], c[1]); },
+                       [](const uint32_t * c) { return (int)inoise16(c[0], c[1]); }, xyz);
+    printStats("inoise16 2d", p2);
+    Stats s2 = measure([](const uint32_t * c) { return (int)snoise16_raw(c[0], c[1]); },
+                       [](const uint32_t * c) { return (int)snoise16(c[0], c[1]); }, xyz);
+    printStats("snoise16 2d", s2);
+    Stats p3 = measure([](const uint32_t * c) { return (int)inoise16_raw(c[0], c[1], c[2]); },
+                       [](const uint32_t * c) { return (int)inoise16(c[0], c[1], c[2]); }, xyz);
+    printStats("inoise16 3d", p3);
+    Stats s3 = measure([](const uint32_t * c) { return (int)snoise16_raw(c[0], c[1], c[2]); },
+                       [](const uint32_t * c) { return (int)snoise16(c[0], c[1], c[2]); }, xyz);
+    printStats("snoise16 3d", s3);
+
+    // -- The ranges noise.h documents, rounded up
+    compare("snoise16 2d", s2, p2, 17700);
+    compare("snoise16 3d", s3, p3, 19100);
+    fills();
+
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("simplex noise: spread of inoise16 within 3%%, in the documented ranges\n");
+    return 0;
+}
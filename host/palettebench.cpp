@@ -0,0 +1,128 @@
+// The 16-bit palette lookups against the 8-bit ones they refine: the time per pixel of
+// ColorFromPalette() on CRGBPalette16/256 and on CRGB48Palette16/256 (rounded back to
+// a CRGB, as the led array needs), over a slow gradient at low brightness, and how many
+// levels each leaves on a channel there.
+//
+// As a test it checks that the 16-bit lookups round to within 1 of the 8-bit ones at
+// the 8-bit index positions, that an upscaled CRGB48Palette256 holds what a lookup of
+// its CRGB48Palette16 gives, and that the gradient keeps more levels than on the 8-bit
+// path; the times are only printed.
+//
+//   palettebench [frames]
+
+#include "FastLED.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_LEDS 1024
+#define RUNS 3
+// -- About 16%, the same on both paths
+#define BRIGHTNESS8 40
+#define BRIGHTNESS16 (BRIGHTNESS8 * 257)
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static CRGB leds[NUM_LEDS];
+static uint16_t wide[NUM_LEDS];
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -- The gradient spans the palette once over the strip, moved on a step each frame
+template <class Frame>
+static double nsPerPixel(int frames, Frame frame) {
+    double best = 1e9;
+    for (int run = 0; run < RUNS; run++) {
+        double t = cpuSeconds();
+        for (int f = 0; f < frames; f++) frame(f);
+        t = cpuSeconds() - t;
+        if (t < best) best = t;
+    }
+    return best * 1e9 / ((double)frames * NUM_LEDS);
+}
+
+static int levels(const uint16_t * values) {
+    static uint8_t seen[65536];
+    memset(seen, 0, sizeof(seen));
+    int n = 0;
+    for (int i = 0; i < NUM_LEDS; i++) n += !seen[values[i]]++;
+    return n;
+}
+
+static int redLevels() {
+    for (int i = 0; i < NUM_LEDS; i++) wide[i] = leds[i].r;
+    return levels(wide);
+}
+
+static void checks(const CRGBPalette16 & pal8, const CRGB48Palette16 & pal16, const CRGBPalette256 & pal8x256,
+                   const CRGB48Palette256 & pal16x256) {
+    int worst16 = 0, worst256 = 0, upscaled = 0;
+    for (int i = 0; i < 256; i++) {
+        CRGB a = ColorFromPalette(pal8, i);
+        CRGB b = ColorFromPalette(pal16, i << 8).toCRGB();
+        CRGB c = ColorFromPalette(pal8x256, i);
+        CRGB d = ColorFromPalette(pal16x256, i << 8).toCRGB();
+        for (int k = 0; k < 3; k++) {
+            int e16 = abs(a.raw[k] - b.raw[k]), e256 = abs(c.raw[k] - d.raw[k]);
+            if (e16 > worst16) worst16 = e16;
+            if (e256 > worst256) worst256 = e256;
+        }
+        CRGB48 direct = ColorFromPalette(pal16, i << 8);
+        upscaled += direct.r != pal16x256[i].r || direct.g != pal16x256[i].g || direct.b != pal16x256[i].b;
+    }
+    CHECK(worst16 <= 1, "CRGB48Palette16: %d off the 8-bit lookup at an 8-bit index", worst16);
+    CHECK(worst256 <= 1, "CRGB48Palette256: %d off the 8-bit lookup at an 8-bit index", worst256);
+    CHECK(upscaled == 0, "CRGB48Palette256: %d entries differ from a lookup of the 16 entry palette", upscaled);
+}
+
+int main(int argc, char ** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    if (frames < 1) frames = 1;
+
+    CRGBPalette16 pal8 = LavaColors_p;
+    CRGB48Palette16 pal16 = LavaColors_p;
+    CRGBPalette256 pal8x256 = pal8;
+    CRGB48Palette256 pal16x256 = pal16;
+    checks(pal8, pal16, pal8x256, pal16x256);
+
+    double ns8 = nsPerPixel(frames, [&](int f) {
+        for (int i = 0; i < NUM_LEDS; i++) leds[i] = ColorFromPalette(pal8, f + i / 4, BRIGHTNESS8);
+    });
+    int levels8 = redLevels();
+    double ns16 = nsPerPixel(frames, [&](int f) {
+        for (int i = 0; i < NUM_LEDS; i++) leds[i] = ColorFromPalette(pal16, (f << 8) + i * 64, BRIGHTNESS16).toCRGB();
+    });
+    int levels16 = redLevels();
+    double ns8x256 = nsPerPixel(frames, [&](int f) {
+        for (int i = 0; i < NUM_LEDS; i++) leds[i] = ColorFromPalette(pal8x256, f + i / 4, BRIGHTNESS8);
+    });
+    double ns16x256 = nsPerPixel(frames, [&](int f) {
+        for (int i = 0; i < NUM_LEDS; i++) leds[i] = ColorFromPalette(pal16x256, (f << 8) + i * 64, BRIGHTNESS16).toCRGB();
+    });
+
+    // -- What is left before rounding, for dithering to use
+    for (int i = 0; i < NUM_LEDS; i++) wide[i] = ColorFromPalette(pal16, i * 64, BRIGHTNESS16).r;
+    int levelsWide = levels(wide);
+
+    printf("LavaColors_p, %d leds, brightness %d/255   ns/pixel   red levels\n", NUM_LEDS, BRIGHTNESS8);
+    printf("8-bit  CRGBPalette16                  %8.1f %8d\n", ns8, levels8);
+    printf("16-bit CRGB48Palette16, toCRGB()      %8.1f %8d (%d before rounding)\n", ns16, levels16, levelsWide);
+    printf("8-bit  CRGBPalette256                 %8.1f\n", ns8x256);
+    printf("16-bit CRGB48Palette256, toCRGB()     %8.1f\n", ns16x256);
+    CHECK(levels16 > levels8 && levelsWide > levels16, "red levels: 8-bit %d, 16-bit %d, %d before rounding", levels8,
+          levels16, levelsWide);
+
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("16-bit palettes: within 1 of the 8-bit lookups, upscaled as looked up, more levels\n");
+    return 0;
+}
@@ -0,0 +1,143 @@
+// parallel_for() checks: palette lookups over 64 to 4000 leds, split between the caller
+// and the worker in halves and in chunks of a few sizes, must come out as the serial
+// loop renders them, with every led run exactly once. parallel_for_range() must cover
+// the range without overlap, also when the worker takes part, a nested call must run in
+// its caller, and the worker must start again after parallel_end().
+//
+// The time a call takes is printed next to the serial loop; on a single CPU that is
+// only the cost of handing out the work.
+
+#include "FastLED.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_LEDS 4000
+#define ROUNDS 20
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static CRGB serial[MAX_LEDS], shared[MAX_LEDS];
+static uint8_t runs[MAX_LEDS];
+static CRGBPalette16 palette = RainbowStripeColors_p;
+
+static double nowUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static inline CRGB shade(int i, uint8_t start) {
+    return ColorFromPalette(palette, start + 3 * i, 255 - (i & 63), LINEARBLEND);
+}
+
+static void equivalence() {
+    const int lengths[] = { 64, 65, 100, 255, 1000, 1023, 2048, MAX_LEDS };
+    const int chunks[] = { 0, 1, 16, 100, 5000 };
+    int before = failures;
+    for (unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        int n = lengths[l];
+        for (unsigned c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+            double serialUs = 0, sharedUs = 0;
+            for (int r = 0; r < ROUNDS; r++) {
+                uint8_t start = r * 7;
+                double t0 = nowUs();
+                for (int i = 0; i < n; i++) serial[i] = shade(i, start);
+                double t1 = nowUs();
+                memset(runs, 0, n);
+                parallel_for(0, n, [&](int i) {
+                    shared[i] = shade(i, start);
+                    runs[i]++;
+                }, chunks[c]);
+                double t2 = nowUs();
+                serialUs += t1 - t0;
+                sharedUs += t2 - t1;
+
+                int bad = -1;
+                for (int i = 0; i < n && bad < 0; i++) {
+                    if (runs[i] != 1 || shared[i] != serial[i]) bad = i;
+                }
+                CHECK(bad < 0, "%d leds, chunk %d: led %d ran %d times, %s the serial loop", n, chunks[c], bad,
+                      bad < 0 ? 0 : runs[bad], bad < 0 || shared[bad] == serial[bad] ? "as" : "unlike");
+                if (bad >= 0) break;
+            }
+            if (chunks[c] == 0) {
+                printf("%4d leds: %8.1f us serial, %8.1f us parallel_for()\n", n, serialUs / ROUNDS, sharedUs / ROUNDS);
+            }
+        }
+    }
+    if (failures == before) printf("equivalence: 64 to %d leds, in halves and chunks, as rendered serially\n", MAX_LEDS);
+}
+
+static void ranges() {
+    int before = failures;
+    // -- Sub-ranges cover [begin, end) once, whatever the chunk
+    for (int chunk = 0; chunk <= 64; chunk += 7) {
+        memset(runs, 0, MAX_LEDS);
+        parallel_for_range(10, 3010, [&](int b, int e) {
+            for (int i = b; i < e; i++) runs[i]++;
+        }, chunk);
+        int bad = -1;
+        for (int i = 0; i < MAX_LEDS && bad < 0; i++) {
+            if (runs[i] != (i >= 10 && i < 3010)) bad = i;
+        }
+        CHECK(bad < 0, "range, chunk %d: led %d ran %d times", chunk, bad, bad < 0 ? 0 : runs[bad]);
+    }
+
+    // -- The worker takes chunks when it gets to run, which on a single CPU takes a
+    //    body that yields
+    pthread_t caller = pthread_self();
+    int byWorker = 0;
+    for (int attempt = 0; attempt < 100 && byWorker == 0; attempt++) {
+        memset(runs, 0, MAX_LEDS);
+        parallel_for_range(0, 1000, [&](int b, int e) {
+            if (!pthread_equal(pthread_self(), caller)) __atomic_add_fetch(&byWorker, e - b, __ATOMIC_RELAXED);
+            for (int i = b; i < e; i++) runs[i]++;
+            sched_yield();
+        }, 10);
+        int bad = -1;
+        for (int i = 0; i < 1000 && bad < 0; i++) {
+            if (runs[i] != 1) bad = i;
+        }
+        CHECK(bad < 0, "shared: led %d ran %d times", bad, bad < 0 ? 0 : runs[bad]);
+    }
+    CHECK(byWorker > 0, "shared: the worker never ran a chunk");
+
+    // -- A call inside a body runs in that body, and still covers its range
+    memset(runs, 0, MAX_LEDS);
+    parallel_for(0, 40, [&](int row) {
+        parallel_for(row * 100, row * 100 + 100, [&](int i) { runs[i]++; });
+    });
+    int bad = -1;
+    for (int i = 0; i < MAX_LEDS && bad < 0; i++) {
+        if (runs[i] != 1) bad = i;
+    }
+    CHECK(bad < 0, "nested: led %d ran %d times", bad, bad < 0 ? 0 : runs[bad]);
+
+    // -- Stopped and started again
+    parallel_end();
+    memset(runs, 0, MAX_LEDS);
+    parallel_for(0, MAX_LEDS, [&](int i) { runs[i]++; }, 50);
+    bad = -1;
+    for (int i = 0; i < MAX_LEDS && bad < 0; i++) {
+        if (runs[i] != 1) bad = i;
+    }
+    CHECK(bad < 0, "restart: led %d ran %d times", bad, bad < 0 ? 0 : runs[bad]);
+    if (failures == before) printf("ranges: covered once, %d leds by the worker, nested and after parallel_end()\n", byWorker);
+}
+
+int main() {
+    CHECK(parallel_begin(), "no worker thread");
+    equivalence();
+    ranges();
+    parallel_end();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+// Live preview loopback test: shows frames on two controllers with the preview sending
+// to 127.0.0.1, receives the packets on a UDP socket as a viewer would, rebuilds the
+// frames with preview_decode() and checks each one against the leds that were shown,
+// sampled with the steps the packet gives. One packet is thrown away on purpose: the
+// deltas after it must be refused until the next key frame.
+//
+// Then it runs random frames straight through preview_encode() and preview_decode(),
+// keys and deltas, as a check of the codec on its own.
+
+#include "FastLED.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#define LEN_A 600
+#define LEN_B 150
+#define FRAMES 300
+#define PREVIEW_FPS 200
+#define LOST_FRAME 100
+
+class NullController : public CPixelLEDController<RGB> {
+public:
+    virtual void init() { }
+protected:
+    virtual void showPixels(PixelController<RGB> & pixels) { }
+};
+
+static CRGB ledsA[LEN_A];
+static CRGB ledsB[LEN_B];
+static NullController controllerA;
+static NullController controllerB;
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+// -- Mostly still frames with a few moving dots, so most packets are deltas
+static void drawFrame(int f) {
+    for (int i = 0; i < LEN_A; i++) ledsA[i] = CHSV(i / 3, 255, 64);
+    for (int i = 0; i < LEN_B; i++) ledsB[i] = CRGB(10, 20, (f / 50) * 40);
+    for (int d = 0; d < 4; d++) ledsA[(f * 7 + d * 131) % LEN_A] = CRGB::White;
+    ledsB[f % LEN_B] = CRGB::Red;
+}
+
+// -- Does the rebuilt frame hold every step'th led of each controller?
+static bool matches(const uint8_t * packet, const CRGB * frame) {
+    const CRGB * leds[2] = { ledsA, ledsB };
+    int count = packet[9];
+    if (count != 2) return false;
+    int k = 0;
+    for (int c = 0; c < count; c++) {
+        const uint8_t * d = packet + PREVIEW_HEADER_SIZE + 3 * c;
+        int len = d[0] | (d[1] << 8);
+        int step = d[2];
+        for (int i = 0; i < len; i++, k++) {
+            if (frame[k] != leds[c][i * step]) return false;
+        }
+    }
+    return true;
+}
+
+static void loopback() {
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = 0;
+    bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+    socklen_t addrLen = sizeof(addr);
+    getsockname(sock, (struct sockaddr *)&addr, &addrLen);
+    struct timeval timeout = { 1, 0 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    FastLED.addLeds(&controllerA, ledsA, LEN_A);
+    FastLED.addLeds(&controllerB, ledsB, LEN_B);
+    CHECK(preview_begin("127.0.0.1", ntohs(addr.sin_port), PREVIEW_FPS), "preview_begin failed");
+
+    static CRGB frame[FASTLED_PREVIEW_MAX_PIXELS];
+    static uint8_t packet[PREVIEW_PACKET_SIZE + 1];
+    uint16_t seq = 0;
+    int received = 0, keys = 0, refused = 0, bytes = 0;
+    bool lost = false;
+    // -- Sleeping a frame time before each show keeps every frame above the rate cap
+    usleep(1000000 / PREVIEW_FPS + 500);
+    for (int f = 0; f < FRAMES; f++) {
+        drawFrame(f);
+        uint32_t dropped, before;
+        preview_stats(NULL, &before);
+        FastLED.show();
+        preview_stats(NULL, &dropped);
+        // -- A frame the sender was too busy for never goes out
+        if (dropped == before) {
+            int len = recv(sock, packet, sizeof(packet), 0);
+            CHECK(len > 0, "frame %d: no packet", f);
+            if (len > 0) {
+                received++;
+                bytes += len;
+                bool key = packet[3] & PREVIEW_FLAG_KEY;
+                if (key) keys++;
+                if (f == LOST_FRAME) {
+                    lost = true;            // -- as if the network lost it
+                } else {
+                    int n = preview_decode(packet, len, (uint8_t *)frame, FASTLED_PREVIEW_MAX_PIXELS, &seq);
+                    if (lost && !key) {
+                        CHECK(n == 0, "frame %d: delta after a lost packet was not refused", f);
+                        refused++;
+                    } else {
+                        lost = false;
+                        CHECK(n > 0, "frame %d: packet refused (%d)", f, n);
+                        CHECK(n <= 0 || matches(packet, frame), "frame %d: rebuilt frame differs", f);
+                    }
+                }
+            }
+        }
+        usleep(1000000 / PREVIEW_FPS + 500);
+    }
+    preview_end();
+    close(sock);
+
+    uint32_t sent, dropped;
+    preview_stats(&sent, &dropped);
+    printf("loopback: %d frames shown, %u sent, %u dropped, %d key frames, %d deltas refused after the loss, %d bytes a packet\n",
+           FRAMES, (unsigned)sent, (unsigned)dropped, keys, refused, received ? bytes / received : 0);
+    CHECK(received > FRAMES * 9 / 10, "only %d of %d frames arrived", received, FRAMES);
+    CHECK(refused > 0, "the lost packet was never noticed");
+}
+
+static void codec() {
+    static uint8_t a[FASTLED_PREVIEW_MAX_PIXELS * 3], b[FASTLED_PREVIEW_MAX_PIXELS * 3];
+    static uint8_t out[FASTLED_PREVIEW_MAX_PIXELS * 3];
+    static uint8_t packet[PREVIEW_PACKET_SIZE];
+    PreviewLayout l;
+    l.count = 3;
+    l.len[0] = 200; l.len[1] = 150; l.len[2] = 50;
+    l.step[0] = 1; l.step[1] = 2; l.step[2] = 4;
+    l.total = 400;
+
+    uint8_t * cur = a;
+    uint8_t * prev = b;
+    uint16_t seq = 0;
+    uint16_t decodedSeq = 0;
+    random16_set_seed(4242);
+    for (int i = 0; i < 3 * l.total; i++) cur[i] = random8();
+    for (int f = 0; f < 1000; f++) {
+        bool key = f % 30 == 0;
+        int len = preview_encode(packet, sizeof(packet), l, 255, ++seq, cur, prev, key);
+        if (len < 0) len = preview_encode(packet, sizeof(packet), l, 255, seq, cur, NULL, true);
+        int n = preview_decode(packet, len, out, l.total, &decodedSeq);
+        CHECK(n == l.total, "codec frame %d: decode returned %d", f, n);
+        CHECK(memcmp(out, cur, 3 * l.total) == 0, "codec frame %d: rebuilt frame differs", f);
+
+        // -- Next frame: from a few pixels to everything changed
+        uint8_t * t = prev; prev = cur; cur = t;
+        memcpy(cur, prev, 3 * l.total);
+        int changes = random16(f % 50 == 0 ? 3 * l.total : 40);
+        for (int i = 0; i < changes; i++) cur[random16(3 * l.total)] = random8();
+    }
+    printf("codec: 1000 frames round tripped\n");
+}
+
+int main() {
+    loopback();
+    codec();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
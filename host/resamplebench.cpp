@@ -0,0 +1,162 @@
+// resample2d() at 64x64 and 128x128, rotating and zooming a source of the same size a
+// little more each frame: the time per frame of each sampling mode, next to the float
+// per-pixel math an effect would otherwise do for the same picture.
+//
+// As a test it checks that affine2d_rotozoom() at a right angle and 1:1 reproduces the
+// source exactly, in both modes, and that the stepped coordinates pick the pixels a
+// multiply per pixel would. How many pixels the float math picks alike is printed with
+// the times: sin16 and cos16 are within about 0.5% of sinf and cosf, so the two part
+// where a sample lands near the middle between two pixels.
+//
+//   resamplebench [frames]
+
+#include "FastLED.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SIZE 128
+#define RUNS 3
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+// -- The application's mapping: rows left to right, top to bottom
+static uint8_t gWidth;
+uint16_t XY(uint8_t x, uint8_t y) { return y * gWidth + x; }
+
+static CRGB source[MAX_SIZE * MAX_SIZE], leds[MAX_SIZE * MAX_SIZE], reference[MAX_SIZE * MAX_SIZE];
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -- A layer with detail at every scale: hue rings and a checkerboard
+static void fillSource(int size) {
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int dx = x - size / 2, dy = y - size / 2;
+            source[y * size + x] = CHSV(sqrt16(dx * dx + dy * dy) * 8, 255, ((x ^ y) & 4) ? 255 : 96);
+        }
+    }
+}
+
+// -- What frame f shows: a turn every 220 frames, zoom between 0.75 and 1.25
+static uint16_t angleOf(int f) { return f * 300; }
+static uint16_t zoomOf(int f) { return 192 + scale8(sin8(f * 3), 128); }
+
+// -- The same rotozoom in float, per pixel, nearest and wrapped
+static void floatFrame(int size, int f) {
+    float turn = angleOf(f) * (2 * M_PI / 65536);
+    float zoom = zoomOf(f) / 256.0f;
+    float cs = cosf(turn) / zoom, sn = sinf(turn) / zoom;
+    float c = size / 2;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int u = (int)floorf(cs * (x - c) + sn * (y - c) + c + 0.5f) % size;
+            int v = (int)floorf(-sn * (x - c) + cs * (y - c) + c + 0.5f) % size;
+            if (u < 0) u += size;
+            if (v < 0) v += size;
+            leds[XY(x, y)] = source[v * size + u];
+        }
+    }
+}
+
+static void fixedFrame(int size, int f, TResampleMode mode, bool wrap) {
+    Affine2D m = affine2d_rotozoom(angleOf(f), zoomOf(f), (size / 2) << 16, (size / 2) << 16, size / 2, size / 2);
+    resample2d(source, size, size, leds, size, size, m, mode, wrap);
+}
+
+template <class Frame>
+static double usPerFrame(int frames, Frame frame) {
+    double best = 1e9;
+    for (int run = 0; run < RUNS; run++) {
+        double t = cpuSeconds();
+        for (int f = 0; f < frames; f++) frame(f);
+        t = cpuSeconds() - t;
+        if (t < best) best = t;
+    }
+    return best * 1e6 / frames;
+}
+
+static void exact(int size) {
+    const TResampleMode modes[] = { RESAMPLE_NEAREST, RESAMPLE_BILINEAR };
+    for (int i = 0; i < 2; i++) {
+        const char * name = modes[i] == RESAMPLE_NEAREST ? "nearest" : "bilinear";
+        for (int quarter = 0; quarter < 4; quarter++) {
+            // -- Turned about the middle of the center pixel, so every turn lands on pixels
+            Affine2D m = affine2d_rotozoom(quarter * 16384, 256, (size / 2) << 16, (size / 2) << 16, size / 2, size / 2);
+            resample2d(source, size, size, leds, size, size, m, modes[i], true);
+            int bad = 0;
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    // -- A quarter turn shows source (y, size - x) at output (x, y)
+                    int u = x, v = y;
+                    for (int q = 0; q < quarter; q++) {
+                        int t = u;
+                        u = v;
+                        v = (size - t) % size;
+                    }
+                    bad += leds[XY(x, y)] != source[v * size + u];
+                }
+            }
+            CHECK(bad == 0, "%dx%d %s, %d quarter turns: %d pixels differ from the source", size, size, name, quarter, bad);
+        }
+    }
+}
+
+// -- The stepped coordinates against a multiply per pixel, and the float math
+static double likeFloat(int size, int frames) {
+    int same = 0, bad = 0;
+    for (int f = 0; f < frames; f++) {
+        floatFrame(size, f);
+        memcpy(reference, leds, size * size * sizeof(CRGB));
+        fixedFrame(size, f, RESAMPLE_NEAREST, true);
+        Affine2D m = affine2d_rotozoom(angleOf(f), zoomOf(f), (size / 2) << 16, (size / 2) << 16, size / 2, size / 2);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                int64_t u = ((int64_t)m.a * x + (int64_t)m.b * y + m.tx + 0x8000) >> 16;
+                int64_t v = ((int64_t)m.c * x + (int64_t)m.d * y + m.ty + 0x8000) >> 16;
+                u = ((u % size) + size) % size;
+                v = ((v % size) + size) % size;
+                bad += leds[XY(x, y)] != source[v * size + u];
+                same += leds[XY(x, y)] == reference[XY(x, y)];
+            }
+        }
+    }
+    CHECK(bad == 0, "%dx%d: %d pixels stepped to differ from a multiply per pixel", size, size, bad);
+    return 100.0 * same / ((double)size * size * frames);
+}
+
+int main(int argc, char ** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 200;
+    if (frames < 1) frames = 1;
+
+    printf("us/frame     float/pixel   nearest   nearest, clip   bilinear   bilinear, clip   as float\n");
+    for (int size = 64; size <= MAX_SIZE; size *= 2) {
+        gWidth = size;
+        fillSource(size);
+        exact(size);
+        double asFloat = likeFloat(size, frames);
+
+        double floatUs = usPerFrame(frames, [&](int f) { floatFrame(size, f); });
+        double nearestUs = usPerFrame(frames, [&](int f) { fixedFrame(size, f, RESAMPLE_NEAREST, true); });
+        double clipUs = usPerFrame(frames, [&](int f) { fixedFrame(size, f, RESAMPLE_NEAREST, false); });
+        double bilinearUs = usPerFrame(frames, [&](int f) { fixedFrame(size, f, RESAMPLE_BILINEAR, true); });
+        double bilinearClipUs = usPerFrame(frames, [&](int f) { fixedFrame(size, f, RESAMPLE_BILINEAR, false); });
+        printf("%3dx%-3d %12.1f %11.1f %13.1f %12.1f %14.1f %9.1f%%\n", size, size, floatUs, nearestUs, clipUs,
+               bilinearUs, bilinearClipUs, asFloat);
+    }
+
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("resample2d: right angles exact, stepped as multiplied per pixel\n");
+    return 0;
+}
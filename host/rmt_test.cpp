@@ -0,0 +1,162 @@
+// RMT driver check: the pixels the driver reads straight out of the leds, through
+// nextPixelData(), must come out of fillNext() as the RMT items of the bytes the copy
+// it replaced (the old loadPixelData(), kept below) would have held.
+//
+// A controller of each color order loads the pixels, and a second RMT controller,
+// reading from it, is started on channel 0 and refilled half by half as the
+// threshold interrupt would; what it leaves in the RMT memory is read up to the
+// item that ends the strip. That is done for lengths that end on every byte of a
+// 32 bit word, several scales, with and without dithering and with a color matrix.
+
+// -- Built with FASTLED_ESP32_RMT, as is the driver (see CMakeLists.txt)
+#include "FastLED.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PIN 12
+#define T1 C_NS(250)
+#define T2 C_NS(625)
+#define T3 C_NS(375)
+#define MAX_LEDS 100
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+// -- The copy the driver made before it read the leds directly, word for word
+template <EOrder ORDER>
+static int copyPixelData(PixelController<ORDER> & pixels, uint32_t * pData) {
+    int count = 0;
+    int which = 0;
+    while (pixels.has(1)) {
+        uint8_t four[4] = {0,0,0,0};
+        for (int i = 0; i < 4; i++) {
+            switch (which) {
+            case 0:
+                four[i] = pixels.loadAndScale0();
+                break;
+            case 1:
+                four[i] = pixels.loadAndScale1();
+                break;
+            case 2:
+                four[i] = pixels.loadAndScale2();
+                pixels.advanceData();
+                pixels.stepDithering();
+                break;
+            }
+            which++;
+            if (which > 2) which = 0;
+            if ( ! pixels.has(1)) break;
+        }
+        pData[count++] = four[0] << 24 | four[1] << 16 | four[2] << 8 | four[3];
+    }
+    return count;
+}
+
+// -- Opens up the controller's pixel source
+template <EOrder ORDER>
+class Probe : public WS2812Controller800Khz<PIN, ORDER> {
+public:
+    void load(PixelController<ORDER> & pixels) { this->loadPixelData(pixels); }
+    static uint32_t source(void * arg) { return Probe::nextPixelData(arg); }
+};
+
+static ESP32RMTController rmt(PIN, T1, T2, T3);
+
+// -- Starts the RMT controller and plays the hardware: sends a half of the channel's
+//    memory, then has fillNext() refill it, until the item that ends the strip
+static int sendItems(uint32_t * items, int max) {
+    volatile uint32_t * mem = &RMTMEM.chan[0].data32[0].val;
+    rmt.startOnChannel(0);
+    int n = 0;
+    for (int half = 0; ; half ^= 1) {
+        for (int k = 0; k < PULSES_PER_FILL; k++) {
+            uint32_t item = mem[half * PULSES_PER_FILL + k];
+            if (item == 0 || n == max) return n;
+            items[n++] = item;
+        }
+        rmt.fillNext();
+    }
+}
+
+template <EOrder ORDER>
+static bool compare(const char * name, const CRGB * leds, int count, CRGB scale, EDitherMode dither,
+                    const CRGBMatrix * matrix) {
+    static Probe<ORDER> probe;
+    static uint32_t words[MAX_LEDS], items[MAX_LEDS * 24 + 1];
+
+    // -- Both read from the same state, dither step included
+    PixelController<ORDER> pixels(leds, count, scale, dither);
+    pixels.mMatrix = matrix;
+    PixelController<ORDER> copy(pixels);
+    int nwords = copyPixelData(copy, words);
+
+    probe.load(pixels);
+    rmt.setPixelSource(Probe<ORDER>::source, &probe, count * 3);
+    int nitems = sendItems(items, MAX_LEDS * 24 + 1);
+
+    rmt_item32_t one, zero;
+    one.level0 = 1;
+    one.duration0 = ESP_TO_RMT_CYCLES(T1 + T2);
+    one.level1 = 0;
+    one.duration1 = ESP_TO_RMT_CYCLES(T3);
+    zero.level0 = 1;
+    zero.duration0 = ESP_TO_RMT_CYCLES(T1);
+    zero.level1 = 0;
+    zero.duration1 = ESP_TO_RMT_CYCLES(T2 + T3);
+
+    if (nitems != nwords * 32) {
+        printf("%s, %d leds, scale %d/%d/%d, dither %d%s: %d items sent, %d expected\n", name, count,
+               scale.r, scale.g, scale.b, dither, matrix ? ", matrix" : "", nitems, nwords * 32);
+        return false;
+    }
+    for (int i = 0; i < nitems; i++) {
+        uint32_t expect = (words[i / 32] << (i % 32)) & 0x80000000 ? one.val : zero.val;
+        if (items[i] != expect) {
+            printf("%s, %d leds, scale %d/%d/%d, dither %d%s: item %d (byte %d, bit %d) differs from the copy\n",
+                   name, count, scale.r, scale.g, scale.b, dither, matrix ? ", matrix" : "", i, i / 8, 7 - i % 8);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    static CRGB leds[MAX_LEDS];
+    random16_set_seed(121);
+    for (int i = 0; i < MAX_LEDS; i++) leds[i] = CRGB(random8(), random8(), random8());
+
+    // -- Lengths that end on each byte of a word, and more than the two halves of the
+    //    RMT memory hold
+    const int lengths[] = { 1, 2, 3, 4, 5, 7, 30, MAX_LEDS };
+    const CRGB scales[] = { CRGB(255, 255, 255), CRGB(255, 176, 240), CRGB(64, 32, 128), CRGB(0, 200, 7) };
+    const EDitherMode dithers[] = { DISABLE_DITHER, BINARY_DITHER };
+    CRGBMatrix hue = CRGBMatrix::hueRotation(8192) * CRGBMatrix::saturation(192);
+    const CRGBMatrix * matrices[] = { NULL, &hue };
+
+    int cases = 0, bad = 0;
+    for (unsigned l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        for (unsigned s = 0; s < sizeof(scales) / sizeof(scales[0]); s++) {
+            for (unsigned d = 0; d < 2; d++) {
+                for (unsigned m = 0; m < 2; m++) {
+                    // -- Every show steps the dithering on, so repeat each case a few times
+                    for (int frame = 0; frame < 4; frame++) {
+                        int n = lengths[l];
+                        bad += !compare<RGB>("RGB", leds, n, scales[s], dithers[d], matrices[m]);
+                        bad += !compare<GRB>("GRB", leds, n, scales[s], dithers[d], matrices[m]);
+                        bad += !compare<BRG>("BRG", leds, n, scales[s], dithers[d], matrices[m]);
+                        bad += !compare<BGR>("BGR", leds, n, scales[s], dithers[d], matrices[m]);
+                        cases += 4;
+                    }
+                }
+            }
+        }
+    }
+    CHECK(bad == 0, "%d cases of %d differ from the copy", bad, cases);
+    if (failures == 0) printf("fillNext: %d cases sent as copied\n", cases);
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
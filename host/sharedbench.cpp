@@ -0,0 +1,132 @@
+// Identical segments rendered once: 1 to 10 segments of 100 leds running the same effect,
+// every other one reversed, each serviced with renderShared off (an effect run per
+// segment) and on (one run, copied into the others). The time per frame is printed for
+// both; shared, each segment added costs its copy and its share of service() rather
+// than an effect run.
+//
+// As a test it checks that Rainbow Cycle, which takes no random numbers, shows the same
+// frames both ways on plain, reversed, grouped and mirrored segments, and that shared,
+// only one segment of each virtual length ran it; the times are only printed.
+//
+//   sharedbench [frames]
+
+#include "FX.h"
+
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define SEGMENT_LEDS 100
+#define NUM_LEDS (MAX_NUM_SEGMENTS * SEGMENT_LEDS)
+#define RUNS 3
+#define FRAME_MS (1000 / FX_FPS)
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static uint32_t gShown;
+static void countShown() { gShown++; }
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// -- segments segments of mode; with mixed, segment k is plain, reversed, grouped by 2 or
+//    mirrored as k % 4 says, else every other one is reversed. The leds of every frame go
+//    to out if given, and the number of segments that ran the effect to ran. Returns the
+//    time per frame shown, in us
+static double run(int segments, uint8_t mode, bool shared, bool mixed, int frames, std::vector<CRGB> * out,
+                  int * ran = NULL) {
+    std::vector<CRGB> leds(NUM_LEDS);
+    std::unique_ptr<WS2812FX> fx(new WS2812FX);
+    fx->init(NUM_LEDS, leds.data(), false);
+    fx->setVirtualClock(0);
+    fx->setShowCallback(countShown);
+    fx->renderShared = shared;
+    for (int s = 0; s < segments; s++) {
+        int kind = mixed ? s % 4 : s % 2;
+        fx->setSegment(s, s * SEGMENT_LEDS, (s + 1) * SEGMENT_LEDS, kind == 2 ? 2 : 1);
+        fx->setMode(s, mode);
+        // -- New segments get colors and a speed of their own: made identical to the first
+        WS2812FX::Segment & seg = fx->getSegment(s);
+        seg.speed = DEFAULT_SPEED;
+        seg.intensity = 128;
+        seg.palette = 0;
+        memcpy(seg.colors, fx->getSegment(0).colors, sizeof(seg.colors));
+        seg.setOption(SEG_OPTION_REVERSED, kind == 1);
+        seg.setOption(SEG_OPTION_MIRROR, kind == 3);
+    }
+    fx->setVirtualClock(0);
+
+    if (out) out->resize((size_t)frames * NUM_LEDS);
+    double seconds = 0;
+    gShown = 0;
+    for (int f = 0; f < frames; f++) {
+        fx->advanceClock(FRAME_MS);
+        double t = cpuSeconds();
+        fx->service();
+        seconds += cpuSeconds() - t;
+        if (out) memcpy(&(*out)[(size_t)f * NUM_LEDS], leds.data(), NUM_LEDS * sizeof(CRGB));
+    }
+    // -- A segment showing another's frames keeps no effect state
+    if (ran) {
+        *ran = 0;
+        for (int s = 0; s < segments; s++) *ran += fx->getSegmentRuntime(s).call > 0;
+    }
+    return gShown ? seconds * 1e6 / gShown : 0;
+}
+
+static double best(int segments, bool shared, int frames) {
+    double us = 1e9;
+    for (int r = 0; r < RUNS; r++) {
+        double t = run(segments, FX_MODE_PLASMA, shared, false, frames, NULL);
+        if (t < us) us = t;
+    }
+    return us;
+}
+
+static void sameFrames(int frames) {
+    std::vector<CRGB> separate, shared;
+    int before = failures;
+    for (int segments = 1; segments <= MAX_NUM_SEGMENTS; segments++) {
+        run(segments, FX_MODE_RAINBOW_CYCLE, false, true, frames, &separate);
+        int ran;
+        run(segments, FX_MODE_RAINBOW_CYCLE, true, true, frames, &shared, &ran);
+        // -- Plain and reversed segments follow the first, grouped and mirrored ones the third
+        int sources = segments < 3 ? 1 : 2;
+        CHECK(ran == sources, "%d segments: %d ran the effect when shared, not %d", segments, ran, sources);
+        int differ = -1;
+        for (int f = 0; f < frames && differ < 0; f++) {
+            if (memcmp(&separate[(size_t)f * NUM_LEDS], &shared[(size_t)f * NUM_LEDS], NUM_LEDS * sizeof(CRGB))) differ = f;
+        }
+        CHECK(differ < 0, "%d segments: frame %d differs when shared", segments, differ);
+    }
+    if (failures == before) {
+        printf("rainbow cycle: the same frames shared, on 1 to %d plain, reversed, grouped and mirrored segments\n",
+               MAX_NUM_SEGMENTS);
+    }
+}
+
+int main(int argc, char ** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    if (frames < 1) frames = 1;
+
+    sameFrames(frames < 200 ? frames : 200);
+
+    printf("plasma, %d leds a segment, best of %d   us/frame\n", SEGMENT_LEDS, RUNS);
+    printf("segments   separate     shared\n");
+    for (int segments = 1; segments <= MAX_NUM_SEGMENTS; segments++) {
+        printf("%8d %10.1f %10.1f\n", segments, best(segments, false, frames), best(segments, true, frames));
+    }
+
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}
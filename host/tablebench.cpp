@@ -0,0 +1,118 @@
+// The per-pixel tables of pixelTable() against working the same values out every frame:
+// Candle Multi, Twinklefox and Twinklecat on a 1000 led segment, first with their
+// table, then with the segment data budget already taken but for their state, so the
+// table does not fit and they fall back to the per-frame path. Both run on the same
+// virtual clock; the time per frame of each is printed with the data it held.
+//
+// As a test it checks that both paths show the same frames, and that each ran the path
+// it was meant to; the times are only printed. Twinklefox and Twinklecat gain little:
+// the PRNG steps the table saves are small next to their time-dependent part.
+//
+//   tablebench [frames]
+
+#include "FX.h"
+
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define NUM_LEDS 1000
+#define RUNS 5
+#define FRAME_MS (1000 / FX_FPS)
+// -- Leaves room for the state of Candle Multi (3 bytes a led) but for no table
+#define RESERVED (MAX_SEGMENT_DATA - 3 * NUM_LEDS)
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static uint32_t gShown;
+static void countShown() { gShown++; }
+
+static double cpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct Result {
+    double us;              // -- per frame shown
+    uint16_t dataLen;       // -- SEGENV.data the effect held
+};
+
+// -- frames of mode on a fresh instance, the leds of each into out
+static Result run(uint8_t mode, bool table, int frames, std::vector<CRGB> & out) {
+    WS2812FX::Segment_runtime reserve;
+    if (!table) reserve.allocateData(RESERVED);
+
+    Result r;
+    {
+        std::vector<CRGB> leds(NUM_LEDS);
+        std::unique_ptr<WS2812FX> fx(new WS2812FX);
+        fx->init(NUM_LEDS, leds.data(), false);
+        fx->setVirtualClock(0);
+        fx->setShowCallback(countShown);
+        fx->setSegment(0, 0, NUM_LEDS);
+        fx->setMode(0, mode);
+        WS2812FX::Segment & seg = fx->getSegment(0);
+        seg.palette = 11;   // -- Rainbow, so Candle Multi's colors come from a palette
+        fx->setVirtualClock(0);
+
+        out.resize((size_t)frames * NUM_LEDS);
+        double seconds = 0;
+        gShown = 0;
+        for (int f = 0; f < frames; f++) {
+            fx->advanceClock(FRAME_MS);
+            double t = cpuSeconds();
+            fx->service();
+            seconds += cpuSeconds() - t;
+            memcpy(&out[(size_t)f * NUM_LEDS], leds.data(), NUM_LEDS * sizeof(CRGB));
+        }
+        r.us = gShown ? seconds * 1e6 / gShown : 0;
+        r.dataLen = fx->getSegmentRuntime(0).dataLen();
+    }
+    reserve.deallocateData();
+    return r;
+}
+
+static void compare(const char * name, uint8_t mode, int frames) {
+    std::vector<CRGB> withTable, perFrame;
+    Result best[2];
+    for (int run_ = 0; run_ < RUNS; run_++) {
+        Result t = run(mode, true, frames, withTable);
+        Result p = run(mode, false, frames, perFrame);
+        if (run_ == 0 || t.us < best[0].us) best[0] = t;
+        if (run_ == 0 || p.us < best[1].us) best[1] = p;
+    }
+
+    int differ = -1;
+    for (int f = 0; f < frames && differ < 0; f++) {
+        if (memcmp(&withTable[(size_t)f * NUM_LEDS], &perFrame[(size_t)f * NUM_LEDS], NUM_LEDS * sizeof(CRGB))) differ = f;
+    }
+    CHECK(differ < 0, "%s: frame %d differs between the table and the per-frame path", name, differ);
+    CHECK(best[1].dataLen < best[0].dataLen, "%s: %d bytes with the table, %d without: the table was not left out",
+          name, best[0].dataLen, best[1].dataLen);
+
+    printf("%-14s %10.1f %10.1f %8.2fx %8d %8d\n", name, best[1].us, best[0].us, best[1].us / best[0].us,
+           best[1].dataLen, best[0].dataLen);
+}
+
+int main(int argc, char ** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 1000;
+    if (frames < 1) frames = 1;
+
+    printf("%d leds, %d frames, best of %d   us/frame             bytes of data\n", NUM_LEDS, frames, RUNS);
+    printf("mode            per frame      table  speedup  per frame   table\n");
+    compare("Candle Multi", FX_MODE_CANDLE_MULTI, frames);
+    compare("Twinklefox", FX_MODE_TWINKLEFOX, frames);
+    compare("Twinklecat", FX_MODE_TWINKLECAT, frames);
+
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("pixel tables: the same frames as worked out per frame\n");
+    return 0;
+}
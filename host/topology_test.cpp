@@ -0,0 +1,170 @@
+// Topology planner checks:
+//
+// - example plans: pins that cannot be used, the heap budget, hardware SPI (only when
+//   asked for), and the pick of I2S or RMT and of MEM_BLOCK_NUM.
+// - random RMT cases of 5 to 7 strips on up to 4 channels (MEM_BLOCK_NUM 2 or more)
+//   against brute force over every start order on the channels the plan picked. Longest first is not always optimal, but never more than 4/3 of it
+//   (the LPT bound), which is what is checked; how often it is optimal is printed.
+
+#include "topology.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#define RANDOM_CASES 300
+#define RMT_MAX_CHANNELS 4
+
+static int failures = 0;
+#define CHECK(cond, ...) do { if (!(cond)) { printf(__VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static const TopologyAssignment & find(const TopologyPlan & plan, int strip) {
+    static const TopologyAssignment missing = { 0, TOPO_UNPLACED, "missing from the plan", 0, 0 };
+    for (int k = 0; k < plan.numStrips; k++) {
+        if (plan.order[k].strip == strip) return plan.order[k];
+    }
+    return missing;
+}
+
+static bool leftOut(const TopologyPlan & plan, int strip, const char * reason) {
+    const TopologyAssignment & a = find(plan, strip);
+    return a.driver == TOPO_UNPLACED && a.reason && !strcmp(a.reason, reason);
+}
+
+static void examples() {
+    TopologyPlan plan;
+    TopologyOptions o;
+    char text[2048];
+
+    // -- Flash, input only and duplicate pins are left out with their reason
+    TopologyStrip pins[] = {
+        { 13, -1, TOPO_WS2812, 100 }, { 6, -1, TOPO_WS2812, 100 },
+        { 34, -1, TOPO_WS2812, 100 }, { 13, -1, TOPO_SK6812, 100 },
+        { 23, 36, TOPO_APA102, 100 },
+    };
+    CHECK(!topology_plan(pins, 5, plan), "pins: plan claims every strip was placed");
+    CHECK(plan.numPlaced == 1 && find(plan, 0).driver != TOPO_UNPLACED, "pins: strip 0 should be the only one placed");
+    CHECK(leftOut(plan, 1, "data pin is not an output"), "pins: GPIO 6 not refused");
+    CHECK(leftOut(plan, 2, "data pin is not an output"), "pins: GPIO 34 not refused");
+    CHECK(leftOut(plan, 3, "data pin already used"), "pins: duplicate pin not refused");
+    CHECK(leftOut(plan, 4, "clock pin is not an output"), "pins: clock on GPIO 36 not refused");
+
+    // -- Over the budget, the lowest priority goes first even when it is the shortest
+    TopologyStrip heap[] = {
+        { 12, -1, TOPO_WS2812, 300, 2 }, { 13, -1, TOPO_WS2812, 300, 0 },
+        { 14, -1, TOPO_WS2812, 100, 1 },
+    };
+    topology_default_options(o);
+    o.heapBudget = 1500;
+    topology_plan(heap, 3, plan, &o);
+    CHECK(plan.numPlaced == 2 && find(plan, 1).driver == TOPO_UNPLACED, "heap: strip 1 (priority 0) should be left out");
+    CHECK(leftOut(plan, 1, "over the heap budget"), "heap: wrong reason");
+    CHECK(plan.heapBytes <= o.heapBudget, "heap: %u bytes planned over a budget of %u",
+          (unsigned)plan.heapBytes, (unsigned)o.heapBudget);
+    CHECK(plan.order[0].strip == 0 && plan.order[1].strip == 2, "heap: not in priority order");
+
+    // -- A clocked strip on the VSPI pins is bit banged unless hardware SPI is allowed
+    TopologyStrip spi[] = { { 13, -1, TOPO_WS2812, 300 }, { 23, 18, TOPO_APA102, 144 } };
+    topology_plan(spi, 2, plan);
+    CHECK(find(plan, 1).driver == TOPO_SW_SPI && plan.spiBus == 0, "spi: hardware SPI picked by default");
+    topology_print(spi, 2, plan, text, sizeof(text));
+    CHECK(!strstr(text, "FASTLED_ALL_PINS_HARDWARE_SPI"), "spi: default plan asks for FASTLED_ALL_PINS_HARDWARE_SPI");
+    topology_default_options(o);
+    o.allowHardwareSPI = true;
+    topology_plan(spi, 2, plan, &o);
+    CHECK(find(plan, 1).driver == TOPO_HW_SPI && plan.spiBus == 3, "spi: VSPI not picked when allowed");
+    CHECK(find(plan, 1).startUs == find(plan, 0).endUs, "spi: clocked strip does not follow the clockless one");
+    TopologyStrip spi2[] = { { 23, 18, TOPO_APA102, 144 }, { 13, 14, TOPO_APA102, 144 } };
+    topology_plan(spi2, 2, plan, &o);
+    CHECK(plan.spiBus == 0, "spi: hardware SPI picked for two clocked strips");
+
+    // -- Many strips of one length go out in parallel on I2S; without I2S, RMT takes
+    //    as many channels as it needs and no more, keeping the memory blocks
+    static const int8_t manyPins[12] = { 12, 13, 14, 15, 16, 17, 18, 19, 21, 22, 23, 25 };
+    TopologyStrip many[12];
+    for (int i = 0; i < 12; i++) {
+        TopologyStrip s = { manyPins[i], -1, TOPO_WS2812, 200 };
+        many[i] = s;
+    }
+    CHECK(topology_plan(many, 12, plan), "many: strips left out");
+    CHECK(plan.clocklessDriver == TOPO_I2S, "many: I2S not picked for 12 equal strips");
+    topology_print(many, 12, plan, text, sizeof(text));
+    CHECK(strstr(text, "keep #define FASTLED_ESP32_I2S") != NULL, "many: I2S setting not printed");
+    topology_default_options(o);
+    o.allowI2S = false;
+    topology_plan(many, 2, plan, &o);
+    CHECK(plan.clocklessDriver == TOPO_RMT && plan.rmtMemBlocks == 4 && plan.rmtChannels == 2,
+          "many: 2 strips on RMT should get MEM_BLOCK_NUM 4, got %u", plan.rmtMemBlocks);
+    topology_plan(many, 12, plan, &o);
+    CHECK(plan.rmtMemBlocks == 1 && plan.rmtChannels == 8, "many: 12 strips on RMT should get MEM_BLOCK_NUM 1, got %u",
+          plan.rmtMemBlocks);
+    topology_print(many, 12, plan, text, sizeof(text));
+    CHECK(strstr(text, "#define MEM_BLOCK_NUM 1\n") != NULL, "many: MEM_BLOCK_NUM not printed");
+    printf("examples: done\n");
+}
+
+// -- Frame time of starting the strips in the given order on the first free channel
+static uint32_t makespan(const uint32_t * us, const int * order, int n, int channels) {
+    uint32_t busy[RMT_MAX_CHANNELS] = { 0 };
+    uint32_t end = 0;
+    for (int k = 0; k < n; k++) {
+        int first = 0;
+        for (int ch = 1; ch < channels; ch++) {
+            if (busy[ch] < busy[first]) first = ch;
+        }
+        busy[first] += us[order[k]];
+        if (busy[first] > end) end = busy[first];
+    }
+    return end;
+}
+
+static void bruteForce() {
+    TopologyOptions o;
+    topology_default_options(o);
+    o.allowI2S = false;
+    o.rmtMinMemBlocks = 8 / RMT_MAX_CHANNELS;
+    srand(119);
+    int optimal = 0;
+    double worst = 1;
+    for (int t = 0; t < RANDOM_CASES; t++) {
+        int n = 5 + rand() % 3;
+        TopologyStrip strips[7];
+        for (int i = 0; i < n; i++) {
+            TopologyStrip s = { (int8_t)(12 + i), -1, (uint8_t)(rand() % 2 ? TOPO_WS2812 : TOPO_SK6812),
+                                (uint16_t)(10 + rand() % 600) };
+            strips[i] = s;
+        }
+        TopologyPlan plan;
+        CHECK(topology_plan(strips, n, plan, &o), "case %d: strips left out", t);
+        CHECK(plan.rmtChannels >= 1 && plan.rmtChannels <= RMT_MAX_CHANNELS, "case %d: %u channels", t, plan.rmtChannels);
+
+        // -- The time of each strip, as the plan has it
+        uint32_t us[7];
+        for (int k = 0; k < n; k++) us[plan.order[k].strip] = plan.order[k].endUs - plan.order[k].startUs;
+        int order[7];
+        for (int i = 0; i < n; i++) order[i] = i;
+        uint32_t best = UINT32_MAX;
+        do {
+            best = std::min(best, makespan(us, order, n, plan.rmtChannels));
+        } while (std::next_permutation(order, order + n));
+
+        if (plan.frameUs == best) optimal++;
+        double ratio = (double)plan.frameUs / best;
+        if (ratio > worst) worst = ratio;
+        CHECK(plan.frameUs * 3 <= best * 4, "case %d: %u us planned, %u us possible", t,
+              (unsigned)plan.frameUs, (unsigned)best);
+    }
+    printf("brute force: %d random cases on up to %d channels, %d planned optimally, worst %.3f of optimal\n",
+           RANDOM_CASES, RMT_MAX_CHANNELS, optimal, worst);
+}
+
+int main() {
+    examples();
+    bruteForce();
+    if (failures) {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    return 0;
+}